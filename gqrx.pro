@@ -93,16 +93,23 @@ SOURCES += \
     src/applications/gqrx/file_resources.cpp \
     src/applications/gqrx/remote_control.cpp \
     src/applications/gqrx/remote_control_settings.cpp \
+    src/applications/gqrx/rx_control.cpp \
+    src/applications/gqrx/rx_modes.cpp \
     src/dsp/afsk1200/cafsk12.cpp \
     src/dsp/afsk1200/costabf.c \
     src/dsp/agc_impl.cpp \
+    src/dsp/block_perf.cpp \
     src/dsp/correct_iq_cc.cpp \
+    src/dsp/fft_benchmark.cpp \
+    src/dsp/fft_window.cpp \
+    src/dsp/fft_wisdom.cpp \
     src/dsp/filter/fir_decim.cpp \
     src/dsp/lpf.cpp \
     src/dsp/rds/decoder_impl.cc \
     src/dsp/rds/parser_impl.cc \
     src/dsp/resampler_xx.cpp \
     src/dsp/rx_agc_xx.cpp \
+    src/dsp/rx_channelizer.cpp \
     src/dsp/rx_demod_am.cpp \
     src/dsp/rx_demod_fm.cpp \
     src/dsp/rx_fft.cpp \
@@ -111,7 +118,10 @@ SOURCES += \
     src/dsp/rx_noise_blanker_cc.cpp \
     src/dsp/rx_rds.cpp \
     src/dsp/sniffer_f.cpp \
+    src/dsp/spectrum_kernel.cpp \
     src/dsp/stereo_demod.cpp \
+    src/dsp/stream_selector.cpp \
+    src/dsp/welch_estimator.cpp \
     src/interfaces/udp_sink_f.cpp \
     src/qtgui/afsk1200win.cpp \
     src/qtgui/agc_options.cpp \
@@ -133,9 +143,12 @@ SOURCES += \
     src/qtgui/meter.cpp \
     src/qtgui/nb_options.cpp \
     src/qtgui/plotter.cpp \
+    src/qtgui/plotter_renderer.cpp \
     src/qtgui/qtcolorpicker.cpp \
+    src/qtgui/waterfall_history.cpp \
     src/receivers/nbrx.cpp \
     src/receivers/receiver_base.cpp \
+    src/receivers/rx_channel.cpp \
     src/receivers/wfmrx.cpp
 
 HEADERS += \
@@ -144,11 +157,17 @@ HEADERS += \
     src/applications/gqrx/receiver.h \
     src/applications/gqrx/remote_control.h \
     src/applications/gqrx/remote_control_settings.h \
+    src/applications/gqrx/rx_control.h \
+    src/applications/gqrx/rx_modes.h \
     src/dsp/afsk1200/cafsk12.h \
     src/dsp/afsk1200/filter.h \
     src/dsp/afsk1200/filter-i386.h \
     src/dsp/agc_impl.h \
+    src/dsp/block_perf.h \
     src/dsp/correct_iq_cc.h \
+    src/dsp/fft_benchmark.h \
+    src/dsp/fft_window.h \
+    src/dsp/fft_wisdom.h \
     src/dsp/filter/fir_decim.h \
     src/dsp/filter/fir_decim_coef.h \
     src/dsp/lpf.h \
@@ -160,6 +179,7 @@ HEADERS += \
     src/dsp/rds/constants.h \
     src/dsp/resampler_xx.h \
     src/dsp/rx_agc_xx.h \
+    src/dsp/rx_channelizer.h \
     src/dsp/rx_demod_am.h \
     src/dsp/rx_demod_fm.h \
     src/dsp/rx_fft.h \
@@ -167,8 +187,12 @@ HEADERS += \
     src/dsp/rx_meter.h \
     src/dsp/rx_noise_blanker_cc.h \
     src/dsp/rx_rds.h \
+    src/dsp/sample_ring.h \
     src/dsp/sniffer_f.h \
+    src/dsp/spectrum_kernel.h \
     src/dsp/stereo_demod.h \
+    src/dsp/stream_selector.h \
+    src/dsp/welch_estimator.h \
     src/interfaces/udp_sink_f.h \
     src/qtgui/afsk1200win.h \
     src/qtgui/agc_options.h \
@@ -191,9 +215,12 @@ HEADERS += \
     src/qtgui/meter.h \
     src/qtgui/nb_options.h \
     src/qtgui/plotter.h \
+    src/qtgui/plotter_renderer.h \
     src/qtgui/qtcolorpicker.h \
+    src/qtgui/waterfall_history.h \
     src/receivers/nbrx.h \
     src/receivers/receiver_base.h \
+    src/receivers/rx_channel.h \
     src/receivers/wfmrx.h
 
 FORMS += \
@@ -255,7 +282,8 @@ PKGCONFIG += gnuradio-analog \
              gnuradio-filter \
              gnuradio-fft \
              gnuradio-runtime \
-             gnuradio-osmosdr
+             gnuradio-osmosdr \
+             fftw3f
 
 INCPATH += src/
 
@@ -36,9 +36,11 @@
 
 #include "mainwindow.h"
 #include "gqrx.h"
+#include "dsp/fft_benchmark.h"
 
 #include <iostream>
 #include <boost/program_options.hpp>
+#include <boost/thread/thread.hpp>
 namespace po = boost::program_options;
 
 static void reset_conf(const QString &file_name);
@@ -83,6 +85,8 @@ int main(int argc, char *argv[])
             ("conf,c", po::value<std::string>(&conf), "Start with this config file")
             ("edit,e", "Edit the config file before using it")
             ("reset,r", "Reset configuration file")
+            ("fft-benchmark,b", "Measure the spectrum frame rate for each FFT size and number of threads and exit")
+            ("kernel-benchmark,k", "Measure the power to dB conversion of the spectrum for each FFT size and exit")
     ;
 
     po::variables_map vm;
@@ -120,6 +124,15 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+    if (vm.count("fft-benchmark"))
+    {
+        fft_benchmark(std::cout, boost::thread::hardware_concurrency());
+        return 0;
+    }
+
+    if (vm.count("kernel-benchmark"))
+        return spectrum_kernel_benchmark(std::cout) ? 0 : 1;
+
     if (!conf.empty())
     {
         cfg_file = QString::fromStdString(conf);
@@ -38,6 +38,7 @@
 #include <QPushButton>
 #include <QResource>
 #include <QString>
+#include <QStringList>
 #include <QTextBrowser>
 #include <QTextCursor>
 #include <QTextStream>
@@ -51,11 +52,30 @@
 #include "ui_mainwindow.h"
 
 /* DSP */
+#include "dsp/fft_wisdom.h"
 #include "receiver.h"
 #include "remote_control_settings.h"
 
 #include "qtgui/bookmarkstaglist.h"
 
+/* Convert a list of CPU cores from the configuration, e.g. "2,3". */
+static std::vector<int> cores_from_settings(const QVariant &value)
+{
+    std::vector<int> cores;
+    QStringList list = value.toStringList();
+    bool        conv_ok;
+    int         i, core;
+
+    for (i = 0; i < list.size(); i++)
+    {
+        core = list[i].trimmed().toInt(&conv_ok);
+        if (conv_ok && core >= 0)
+            cores.push_back(core);
+    }
+
+    return cores;
+}
+
 MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     QMainWindow(parent),
     configOk(true),
@@ -63,6 +83,7 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     d_lnb_lo(0),
     d_hw_freq(0),
     d_have_audio(true),
+    d_zoom_fft(true),
     dec_afsk1200(0)
 {
     ui->setupUi(this);
@@ -80,6 +101,9 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
         m_cfg_dir = QString("%1/gqrx").arg(xdg_dir.data());
     }
 
+    /* FFT plans created from now on use the cached wisdom */
+    fft_wisdom_load(QString("%1/fftw_wisdom").arg(m_cfg_dir).toStdString());
+
     setWindowTitle(QString("Gqrx %1").arg(VERSION));
 
     /* frequency control widget */
@@ -91,9 +115,11 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     /* create receiver object */
     rx = new receiver("", "", 1);
     rx->set_rf_freq(144500000.0f);
+    rx_ctl = new RxControl(rx);
 
     // remote controller
     remote = new RemoteControl();
+    remote->setBackend(rx_ctl);
 
     /* meter timer */
     meter_timer = new QTimer(this);
@@ -106,7 +132,6 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     audio_fft_timer = new QTimer(this);
     connect(audio_fft_timer, SIGNAL(timeout()), this, SLOT(audioFftTimeout()));
 
-    d_fftData = new std::complex<float>[MAX_FFT_SIZE];
     d_realFftData = new float[MAX_FFT_SIZE];
     d_pwrFftData = new float[MAX_FFT_SIZE]();
     d_iirFftData = new float[MAX_FFT_SIZE];
@@ -224,6 +249,7 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     connect(uiDockFft, SIGNAL(wfSpanChanged(quint64)), this, SLOT(setWfTimeSpan(quint64)));
     connect(uiDockFft, SIGNAL(fftSplitChanged(int)), this, SLOT(setIqFftSplit(int)));
     connect(uiDockFft, SIGNAL(fftAvgChanged(float)), this, SLOT(setIqFftAvg(float)));
+    connect(uiDockFft, SIGNAL(fftWindowChanged(int)), this, SLOT(setIqFftWindow(int)));
     connect(uiDockFft, SIGNAL(fftZoomChanged(float)), ui->plotter, SLOT(zoomOnXAxis(float)));
     connect(uiDockFft, SIGNAL(resetFftZoom()), ui->plotter, SLOT(resetHorizontalZoom()));
     connect(uiDockFft, SIGNAL(gotoFftCenter()), ui->plotter, SLOT(moveToCenterFreq()));
@@ -361,9 +387,10 @@ MainWindow::~MainWindow()
     delete uiDockFft;
     delete uiDockInputCtl;
     delete uiDockRDS;
+    remote->setBackend(0);
+    delete rx_ctl;
     delete rx;
     delete remote;
-    delete [] d_fftData;
     delete [] d_realFftData;
     delete [] d_iirFftData;
     delete [] d_pwrFftData;
@@ -453,6 +480,13 @@ bool MainWindow::loadConfig(const QString cfgfile, bool check_crash,
         restoreState(m_settings->value("gui/state", saveState()).toByteArray());
     }
 
+    ui->plotter->setWaterfallHistorySize(
+            m_settings->value("gui/waterfall_history_mb", 64).toInt());
+
+    // read before the flow graph starts; otherwise keep the GNU Radio prefs
+    if (m_settings->value("scheduler/perf_counters", false).toBool())
+        rx->set_perf_counters(true);
+
     QString indev = m_settings->value("input/device", "").toString();
     if (!indev.isEmpty())
     {
@@ -559,10 +593,25 @@ bool MainWindow::loadConfig(const QString cfgfile, bool check_crash,
         qDebug() << "Actual bandwidth   :" << actual_bw << "Hz";
     }
 
+    int_val = m_settings->value("input/latency", receiver::LATENCY_BALANCED).toInt(&conv_ok);
+    if (conv_ok && rx->set_latency_profile((receiver::latency_profile)int_val) == receiver::STATUS_OK)
+        qDebug() << "Latency profile:" << int_val;
+
+    rx->set_frontend_affinity(cores_from_settings(m_settings->value("scheduler/frontend_cores")));
+    rx->set_channel_affinity(cores_from_settings(m_settings->value("scheduler/channel_cores")));
+    rx->set_audio_priority(m_settings->value("scheduler/audio_priority", 0).toInt());
+
+    rx->set_iq_fft_welch(m_settings->value("fft/welch_overlap", 0.5).toFloat(),
+                         m_settings->value("fft/welch_budget", 0.0).toFloat());
+    rx->set_iq_fft_threads(m_settings->value("fft/threads", 1).toInt());
+    d_zoom_fft = m_settings->value("fft/zoom_fft", true).toBool();
+
     uiDockInputCtl->readSettings(m_settings); // this will also update freq range
     uiDockRxOpt->readSettings(m_settings);
     uiDockFft->readSettings(m_settings);
     uiDockAudio->readSettings(m_settings);
+    rx_ctl->setCwOffset(uiDockRxOpt->getCwOffset());
+    rx_ctl->readVfoSettings(m_settings);
 
     {
         int64_val = m_settings->value("input/frequency", 14236000).toLongLong(&conv_ok);
@@ -940,10 +989,10 @@ void MainWindow::selectDemod(int mode_idx)
     bool rds_enabled;
 
     // validate mode_idx
-    if (mode_idx < DockRxOpt::MODE_OFF || mode_idx >= DockRxOpt::MODE_LAST)
+    if (mode_idx < RxModes::MODE_OFF || mode_idx >= RxModes::MODE_LAST)
     {
         qDebug() << "Invalid mode index:" << mode_idx;
-        mode_idx = DockRxOpt::MODE_OFF;
+        mode_idx = RxModes::MODE_OFF;
     }
     qDebug() << "New mode index:" << mode_idx;
 
@@ -957,7 +1006,7 @@ void MainWindow::selectDemod(int mode_idx)
 
     switch (mode_idx) {
 
-    case DockRxOpt::MODE_OFF:
+    case RxModes::MODE_OFF:
         /* Spectrum analyzer only */
         if (rx->is_recording_audio())
         {
@@ -969,7 +1018,7 @@ void MainWindow::selectDemod(int mode_idx)
         click_res = 1000;
         break;
 
-    case DockRxOpt::MODE_RAW:
+    case RxModes::MODE_RAW:
         /* Raw I/Q */
         rx->set_demod(receiver::RX_DEMOD_NONE);
         ui->plotter->setDemodRanges(-45000, -200, 200, 45000, true);
@@ -977,14 +1026,14 @@ void MainWindow::selectDemod(int mode_idx)
         click_res = 100;
         break;
 
-    case DockRxOpt::MODE_AM:
+    case RxModes::MODE_AM:
         rx->set_demod(receiver::RX_DEMOD_AM);
         ui->plotter->setDemodRanges(-45000, -200, 200, 45000, true);
         uiDockAudio->setFftRange(0,6000);
         click_res = 100;
         break;
 
-    case DockRxOpt::MODE_NFM:
+    case RxModes::MODE_NFM:
         rx->set_demod(receiver::RX_DEMOD_NFM);
         click_res = 100;
         maxdev = uiDockRxOpt->currentMaxdev();
@@ -1000,9 +1049,9 @@ void MainWindow::selectDemod(int mode_idx)
         }
         break;
 
-    case DockRxOpt::MODE_WFM_MONO:
-    case DockRxOpt::MODE_WFM_STEREO:
-    case DockRxOpt::MODE_WFM_STEREO_OIRT:
+    case RxModes::MODE_WFM_MONO:
+    case RxModes::MODE_WFM_STEREO:
+    case RxModes::MODE_WFM_STEREO_OIRT:
         /* Broadcast FM */
         quad_rate = rx->get_input_rate();
         if (quad_rate < 500.0e3)
@@ -1013,9 +1062,9 @@ void MainWindow::selectDemod(int mode_idx)
             ui->plotter->setDemodRanges(-250000, -10000, 10000, 250000, true);
         uiDockAudio->setFftRange(0,24000);  /** FIXME: get audio rate from rx **/
         click_res = 1000;
-        if (mode_idx == DockRxOpt::MODE_WFM_MONO)
+        if (mode_idx == RxModes::MODE_WFM_MONO)
             rx->set_demod(receiver::RX_DEMOD_WFM_M);
-        else if (mode_idx == DockRxOpt::MODE_WFM_STEREO_OIRT)
+        else if (mode_idx == RxModes::MODE_WFM_STEREO_OIRT)
             rx->set_demod(receiver::RX_DEMOD_WFM_S_OIRT);
         else
             rx->set_demod(receiver::RX_DEMOD_WFM_S);
@@ -1025,7 +1074,7 @@ void MainWindow::selectDemod(int mode_idx)
             setRdsDecoder(true);
         break;
 
-    case DockRxOpt::MODE_LSB:
+    case RxModes::MODE_LSB:
         /* LSB */
         rx->set_demod(receiver::RX_DEMOD_SSB);
         ui->plotter->setDemodRanges(-40000, -100, -5000, 0, false);
@@ -1033,7 +1082,7 @@ void MainWindow::selectDemod(int mode_idx)
         click_res = 100;
         break;
 
-    case DockRxOpt::MODE_USB:
+    case RxModes::MODE_USB:
         /* USB */
         rx->set_demod(receiver::RX_DEMOD_SSB);
         ui->plotter->setDemodRanges(0, 5000, 100, 40000, false);
@@ -1041,7 +1090,7 @@ void MainWindow::selectDemod(int mode_idx)
         click_res = 100;
         break;
 
-    case DockRxOpt::MODE_CWL:
+    case RxModes::MODE_CWL:
         /* CW-L */
         rx->set_demod(receiver::RX_DEMOD_SSB);
         cwofs = -uiDockRxOpt->getCwOffset();
@@ -1050,7 +1099,7 @@ void MainWindow::selectDemod(int mode_idx)
         click_res = 10;
         break;
 
-    case DockRxOpt::MODE_CWU:
+    case RxModes::MODE_CWU:
         /* CW-U */
         rx->set_demod(receiver::RX_DEMOD_SSB);
         cwofs = uiDockRxOpt->getCwOffset();
@@ -1078,7 +1127,7 @@ void MainWindow::selectDemod(int mode_idx)
     remote->setMode(mode_idx);
     remote->setPassband(flo, fhi);
 
-    d_have_audio = (mode_idx != DockRxOpt::MODE_OFF);
+    d_have_audio = (mode_idx != RxModes::MODE_OFF);
 
     uiDockRxOpt->setCurrentDemod(mode_idx);
 }
@@ -1136,6 +1185,7 @@ void MainWindow::setAmDcr(bool enabled)
 void MainWindow::setCwOffset(int offset)
 {
     rx->set_cw_offset(offset);
+    rx_ctl->setCwOffset(offset);
 }
 
 /**
@@ -1232,44 +1282,29 @@ void MainWindow::meterTimeout()
 void MainWindow::iqFftTimeout()
 {
     unsigned int    fftsize;
-    unsigned int    i;
-    float           pwr;
-    float           pwr_scale;
-    std::complex<float> pt;     /* a single FFT point used in calculations */
+    double          zoom_offset;
+    double          zoom_rate;
 
-    // FIXME: fftsize is a reference
-    rx->get_iq_fft_data(d_fftData, fftsize);
+    /* follow the visible part of the pandapter, see receiver::set_iq_fft_zoom() */
+    rx->set_iq_fft_zoom(ui->plotter->getFftCenterFreq(),
+                        d_zoom_fft ? ui->plotter->getSpanFreq() : 0);
 
-    if (fftsize == 0)
+    /* the spectrum is computed by the FFT block, see receiver::set_iq_fft_rate() */
+    if (rx->get_zoom_spectrum(d_realFftData, d_iirFftData, fftsize,
+                              zoom_offset, zoom_rate))
     {
-        /* nothing to do, wait until next activation. */
-        return;
+        ui->plotter->setFftDataRange((qint64)zoom_offset, (float)zoom_rate);
     }
-
-    // NB: without cast to float the multiplication will overflow at 64k
-    // and pwr_scale will be inf
-    pwr_scale = 1.0 / ((float)fftsize * (float)fftsize);
-
-    /* Normalize, calculate power and shift the FFT */
-    for (i = 0; i < fftsize; i++)
+    else
     {
+        rx->get_iq_spectrum(d_realFftData, d_iirFftData, fftsize);
+        ui->plotter->setFftDataRange(0, 0.f);
+    }
 
-        /* normalize and shift */
-        if (i < fftsize/2)
-        {
-            pt = d_fftData[fftsize/2+i];
-        }
-        else
-        {
-            pt = d_fftData[i-fftsize/2];
-        }
-
-        /* calculate power in dBFS */
-        pwr = pwr_scale * (pt.imag() * pt.imag() + pt.real() * pt.real());
-        d_realFftData[i] = 10.0 * log10f(pwr + 1.0e-20);
-
-        /* FFT averaging */
-        d_iirFftData[i] += d_fftAvg * (d_realFftData[i] - d_iirFftData[i]);
+    if (fftsize == 0)
+    {
+        /* nothing to do, wait until next activation. */
+        return;
     }
 
     ui->plotter->setNewFttData(d_iirFftData, d_realFftData, fftsize);
@@ -1278,16 +1313,12 @@ void MainWindow::iqFftTimeout()
 /** Audio FFT plot timeout. */
 void MainWindow::audioFftTimeout()
 {
-    unsigned int    fftsize;
-    unsigned int    i;
-    float           pwr;
-    float           pwr_scale;
-    std::complex<float> pt;             /* a single FFT point used in calculations */
+    unsigned int    fftsize;    // number of bins in the half spectrum
 
     if (!d_have_audio || !uiDockAudio->isVisible())
         return;
 
-    rx->get_audio_fft_data(d_fftData, fftsize);
+    rx->get_audio_spectrum(d_realFftData, fftsize);
 
     if (fftsize == 0)
     {
@@ -1296,27 +1327,6 @@ void MainWindow::audioFftTimeout()
         return;
     }
 
-    pwr_scale = 1.0 / (fftsize * fftsize);
-
-    /** FIXME: move post processing to rx_fft_f **/
-    /* Normalize, calculcate power and shift the FFT */
-    for (i = 0; i < fftsize; i++)
-    {
-        /* normalize and shift */
-        if (i < fftsize/2)
-        {
-            pt = d_fftData[fftsize/2+i];
-        }
-        else
-        {
-            pt = d_fftData[i-fftsize/2];
-        }
-
-        /* calculate power in dBFS */
-        pwr = pwr_scale * (pt.imag() * pt.imag() + pt.real() * pt.real());
-        d_realFftData[i] = 10.0 * log10f(pwr + 1.0e-20);
-    }
-
     uiDockAudio->setNewFttData(d_realFftData, fftsize);
 }
 
@@ -1576,6 +1586,7 @@ void MainWindow::setIqFftRate(int fps)
     {
         interval = 36e7; // 100 hours
         ui->plotter->setRunningState(false);
+        rx->set_iq_fft_rate(0);
     }
     else
     {
@@ -1583,7 +1594,10 @@ void MainWindow::setIqFftRate(int fps)
 
         ui->plotter->setFftRate(fps);
         if (iq_fft_timer->isActive())
+        {
             ui->plotter->setRunningState(true);
+            rx->set_iq_fft_rate(fps);
+        }
     }
 
     if (interval > 9 && iq_fft_timer->isActive())
@@ -1611,7 +1625,16 @@ void MainWindow::setIqFftSplit(int pct_wf)
 void MainWindow::setIqFftAvg(float avg)
 {
     if ((avg >= 0) && (avg <= 1.0))
+    {
         d_fftAvg = avg;
+        rx->set_iq_fft_avg(avg);
+    }
+}
+
+/** Baseband FFT window type has changed. */
+void MainWindow::setIqFftWindow(int wintype)
+{
+    rx->set_iq_fft_window(wintype);
 }
 
 /** Audio FFT rate has changed. */
@@ -1623,7 +1646,10 @@ void MainWindow::setAudioFftRate(int fps)
         return;
 
     if (audio_fft_timer->isActive())
+    {
         audio_fft_timer->setInterval(interval);
+        rx->set_audio_fft_rate(fps);
+    }
 }
 
 /** Set FFT plot color. */
@@ -1698,8 +1724,10 @@ void MainWindow::on_actionDSP_triggered(bool checked)
             iq_fft_timer->start(36e7); // 100 hours
             ui->plotter->setRunningState(false);
         }
+        rx->set_iq_fft_rate(uiDockFft->fftRate());
 
         audio_fft_timer->start(40);
+        rx->set_audio_fft_rate(25);
 
         /* update menu text and button tooltip */
         ui->actionDSP->setToolTip(tr("Stop DSP processing"));
@@ -1715,6 +1743,8 @@ void MainWindow::on_actionDSP_triggered(bool checked)
         iq_fft_timer->stop();
         audio_fft_timer->stop();
         rds_timer->stop();
+        rx->set_iq_fft_rate(0);
+        rx->set_audio_fft_rate(0);
 
         /* stop receiver */
         rx->stop();
@@ -46,6 +46,7 @@
 // see https://bugreports.qt-project.org/browse/QTBUG-22829
 #ifndef Q_MOC_RUN
 #include "applications/gqrx/receiver.h"
+#include "applications/gqrx/rx_control.h"
 #endif
 
 namespace Ui {
@@ -82,7 +83,6 @@ private:
     qint64 d_hw_freq_stop;
 
     enum receiver::filter_shape d_filter_shape;
-    std::complex<float>* d_fftData;
     float          *d_realFftData;
     float          *d_iirFftData;
     float          *d_pwrFftData;
@@ -90,6 +90,7 @@ private:
     float           d_fftAvg;      /*!< FFT averaging parameter set by user (not the true gain). */
 
     bool d_have_audio;  /*!< Whether we have audio (i.e. not with demod_off. */
+    bool d_zoom_fft;    /*!< Whether a zoomed pandapter uses the zoom spectrum. */
 
     /* dock widgets */
     DockRxOpt      *uiDockRxOpt;
@@ -113,6 +114,7 @@ private:
     QTimer   *rds_timer;
 
     receiver *rx;
+    RxControl *rx_ctl;
 
     RemoteControl *remote;
 
@@ -178,6 +180,7 @@ private slots:
     void setIqFftRate(int fps);
     void setIqFftSplit(int pct_wf);
     void setIqFftAvg(float avg);
+    void setIqFftWindow(int wintype);
     void setAudioFftRate(int fps);
     void setFftColor(const QColor color);
     void setFftFill(bool enable);
@@ -20,11 +20,18 @@
  * the Free Software Foundation, Inc., 51 Franklin Street,
  * Boston, MA 02110-1301, USA.
  */
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
 #include <iostream>
+#include <sstream>
 #ifndef _MSC_VER
 #include <unistd.h>
 #endif
+#ifndef _WIN32
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #include <iostream>
 
@@ -50,6 +57,30 @@
 #include <gnuradio/audio/sink.h>
 #endif
 
+/**
+ * Buffer configuration of the latency profiles, indexed by latency_profile.
+ * Buffer sizes are in items, 0 means the GNU Radio default.
+ */
+static const struct {
+    const char *name;
+    int         source_buffer;      /* Min. output buffer of the input device. */
+    int         frontend_buffer;    /* Min. output buffer of the I/Q front-end. */
+    int         channel_buffer;     /* Min. output buffer in the channels. */
+    int         channel_max_buffer; /* Max. output buffer in the channels. */
+    int         channel_max_items;  /* Max. items per call to work() in the channels. */
+} latency_cfg[] = {
+    { "low",        8192,   0,      0,     4096, 1024 },
+    { "balanced",   8192,   0,      0,     8192, 0 },
+    { "throughput", 262144, 262144, 65536, 0,    0 }
+};
+
+
+/** Time between two high resolution timer values in ms, rounded to 0.1 ms. */
+static double startup_ms(gr::high_res_timer_type from,
+                         gr::high_res_timer_type to)
+{
+    return std::floor(1.0e4 * (to - from) / gr::high_res_timer_tps() + 0.5) / 10.0;
+}
 
 /**
  * @brief Public contructor.
@@ -73,8 +104,25 @@ receiver::receiver(const std::string input_device,
       d_iq_rev(false),
       d_dc_cancel(false),
       d_iq_balance(false),
-      d_demod(RX_DEMOD_OFF)
-{
+      d_iq_fft_size(8192),
+      d_iq_fft_rate(0.0),
+      d_iq_fft_avg(1.0),
+      d_iq_fft_window(gr::filter::firdes::WIN_HAMMING),
+      d_zoom_offset(0.0),
+      d_zoom_span(0.0),
+      d_report_consumer(-1),
+      d_report_fftsize(0),
+      d_demod(RX_DEMOD_OFF),
+      d_latency(LATENCY_BALANCED),
+      d_lat_ref(0.0),
+      d_lat_iq_items(0),
+      d_lat_audio_items(0),
+      d_audio_priority(0),
+      d_audio_prio_active(0),
+      d_perf_time(0)
+{
+    gr::high_res_timer_type t_start = gr::high_res_timer_now();
+    gr::high_res_timer_type t_input, t_dsp, t_audio, t_demod;
 
     tb = gr::make_top_block("gqrx");
 
@@ -109,49 +157,46 @@ receiver::receiver(const std::string input_device,
     {
         d_quad_rate = d_input_rate;
     }
+    t_input = gr::high_res_timer_now();
 
-
-    // create I/Q sink and close it
-    iq_sink = gr::blocks::file_sink::make(sizeof(gr_complex), get_null_file().c_str(), true);
-    iq_sink->set_unbuffered(true);
-    iq_sink->close();
-
-    rx = make_nbrx(d_quad_rate, d_audio_rate);
-    lo = gr::analog::sig_source_c::make(d_quad_rate, gr::analog::GR_SIN_WAVE,
-                                        0.0, 1.0);
-    mixer = gr::blocks::multiply_cc::make();
+    /* The receiver chains, the recorders, the UDP sink and the sniffer are
+     * created on first use, see create_chain() and the start_xxx() methods.
+     */
+    nb_valve = gr::blocks::copy::make(sizeof(gr_complex));
+    wfm_valve = gr::blocks::copy::make(sizeof(gr_complex));
+    wfm_valve->set_enabled(false);
+    rx_sel = make_stream_selector(sizeof(float), 2, 2);
 
     iq_swap = make_iq_swap_cc(false);
     dc_corr = make_dc_corr_cc(d_quad_rate, 1.0);
-    iq_fft = make_rx_fft_c(8192u, 0);
+    iq_fft = make_rx_fft_c(8192u, d_iq_fft_window);
 
     audio_fft = make_rx_fft_f(8192u);
     audio_gain0 = gr::blocks::multiply_const_ff::make(0.1);
     audio_gain1 = gr::blocks::multiply_const_ff::make(0.1);
 
-    wav_sink = gr::blocks::wavfile_sink::make(get_null_file().c_str(), 2,
-                                              (unsigned int) d_audio_rate,
-                                              16);
-
-    audio_udp_sink = make_udp_sink_f();
-
-#ifdef WITH_PULSEAUDIO
-    audio_snk = make_pa_sink(audio_device, d_audio_rate, "GQRX", "Audio output");
-#elif WITH_PORTAUDIO
-    audio_snk = make_portaudio_sink(audio_device, d_audio_rate, "GQRX", "Audio output");
-#else
-    audio_snk = gr::audio::sink::make(d_audio_rate, audio_device, true);
-#endif
-
-    output_devstr = audio_device;
-
-    /* wav sink and source is created when rec/play is started */
+    /* wav source is created when playback is started */
     audio_null_sink0 = gr::blocks::null_sink::make(sizeof(float));
     audio_null_sink1 = gr::blocks::null_sink::make(sizeof(float));
-    sniffer = make_sniffer_f();
     /* sniffer_rr is created at each activation. */
+    t_dsp = gr::high_res_timer_now();
 
+    audio_snk = make_audio_sink(audio_device);
+
+    output_devstr = audio_device;
+    t_audio = gr::high_res_timer_now();
+
+    apply_latency_profile();
+    apply_affinity();
     set_demod(RX_DEMOD_NFM);
+    t_demod = gr::high_res_timer_now();
+
+    std::cout << "Receiver created in " << startup_ms(t_start, t_demod)
+              << " ms (input: " << startup_ms(t_start, t_input)
+              << ", dsp: " << startup_ms(t_input, t_dsp)
+              << ", audio: " << startup_ms(t_dsp, t_audio)
+              << ", demod: " << startup_ms(t_audio, t_demod)
+              << ")" << std::endl;
 
 #ifndef QT_NO_DEBUG_OUTPUT
     gr::prefs pref;
@@ -172,7 +217,7 @@ void receiver::start()
 {
     if (!d_running)
     {
-        tb->start();
+        tb_start();
         d_running = true;
     }
 }
@@ -188,6 +233,41 @@ void receiver::stop()
     }
 }
 
+/**
+ * @brief Start the flow graph.
+ *
+ * GNU Radio creates new threads for all blocks whenever the flow graph is
+ * started or unlocked, so the thread priorities are restored afterwards.
+ */
+void receiver::tb_start(void)
+{
+    tb->start();
+    apply_audio_priority();
+}
+
+/** Unlock the flow graph (see tb_start()). */
+void receiver::tb_unlock(void)
+{
+    tb->unlock();
+    if (d_running)
+        apply_audio_priority();
+}
+
+/**
+ * @brief Wait for the receiver to finish.
+ *
+ * The flow graph only finishes by itself when the input is a file source
+ * without repeat; this is used for offline processing of I/Q files.
+ */
+void receiver::wait()
+{
+    if (d_running)
+    {
+        tb->wait();
+        d_running = false;
+    }
+}
+
 /**
  * @brief Select new input device.
  *
@@ -233,6 +313,8 @@ void receiver::set_input_device(const std::string device)
     src = osmosdr::source::make(device);
     if(src->get_sample_rate() != 0)
         set_input_rate(src->get_sample_rate());
+    apply_latency_profile();
+    apply_affinity();
 
     if (d_decim >= 2)
     {
@@ -245,11 +327,15 @@ void receiver::set_input_device(const std::string device)
     }
 
     if (d_running)
-        tb->start();
+        tb_start();
 }
 
 
-/** Select new audio output device. */
+/**
+ * @brief Select new audio output device.
+ * @param device The audio device, RX_AUDIO_DEVICE_NULL or RX_AUDIO_DEVICE_FILE
+ *               followed by the name of a WAV file.
+ */
 void receiver::set_output_device(const std::string device)
 {
     if (output_devstr.compare(device) == 0)
@@ -272,22 +358,58 @@ void receiver::set_output_device(const std::string device)
 
     tb->lock();
 
+    // the new audio output starts counting from zero
+    measure_latency(true);
+    d_lat_audio_items = 0;
+
     tb->disconnect(audio_gain0, 0, audio_snk, 0);
     tb->disconnect(audio_gain1, 0, audio_snk, 1);
     audio_snk.reset();
 
-#ifdef WITH_PULSEAUDIO
-    audio_snk = make_pa_sink(device, d_audio_rate, "GQRX", "Audio output");
-#elif WITH_PORTAUDIO
-    audio_snk = make_portaudio_sink(device, d_audio_rate, "GQRX", "Audio output");
-#else
-    audio_snk = gr::audio::sink::make(d_audio_rate, device, true);
-#endif
+    audio_snk = make_audio_sink(device);
 
     tb->connect(audio_gain0, 0, audio_snk, 0);
     tb->connect(audio_gain1, 0, audio_snk, 1);
 
-    tb->unlock();
+    tb_unlock();
+}
+
+/**
+ * @brief Create the audio output block.
+ * @param device The audio device (see set_output_device()).
+ *
+ * The null and WAV file outputs do not consume samples at the audio rate,
+ * so with a non-throttled input the receiver runs as fast as the CPU allows.
+ */
+gr::basic_block_sptr receiver::make_audio_sink(const std::string device)
+{
+    std::string file_prefix(RX_AUDIO_DEVICE_FILE);
+
+    if (device == RX_AUDIO_DEVICE_NULL)
+        return gr::blocks::null_sink::make(sizeof(float));
+
+    if (device.compare(0, file_prefix.size(), file_prefix) == 0)
+    {
+        std::string filename = device.substr(file_prefix.size());
+
+        try {
+            return gr::blocks::wavfile_sink::make(filename.c_str(), 2,
+                                                  (unsigned int) d_audio_rate,
+                                                  16);
+        }
+        catch (std::runtime_error &e) {
+            std::cout << "Error opening " << filename << ": " << e.what() << std::endl;
+            return gr::blocks::null_sink::make(sizeof(float));
+        }
+    }
+
+#ifdef WITH_PULSEAUDIO
+    return make_pa_sink(device, d_audio_rate, "GQRX", "Audio output");
+#elif WITH_PORTAUDIO
+    return make_portaudio_sink(device, d_audio_rate, "GQRX", "Audio output");
+#else
+    return gr::audio::sink::make(d_audio_rate, device, true);
+#endif
 }
 
 /** Get a list of available antenna connectors. */
@@ -322,6 +444,7 @@ double receiver::set_input_rate(double rate)
             * std::numeric_limits<double>::epsilon());
 
     tb->lock();
+    measure_latency(true);
     d_input_rate = src->set_sample_rate(rate);
 
     if (d_input_rate == 0)
@@ -341,9 +464,12 @@ double receiver::set_input_rate(double rate)
 
     d_quad_rate = d_input_rate / (double)d_decim;
     dc_corr->set_sample_rate(d_quad_rate);
-    rx->set_quad_rate(d_quad_rate);
-    lo->set_sampling_freq(d_quad_rate);
-    tb->unlock();
+    update_ddc();
+    if (chanizer)
+        chanizer->set_sample_rate(d_quad_rate);
+    for (size_t i = 0; i < d_vfos.size(); i++)
+        reroute_vfo((int)i);
+    tb_unlock();
 
     return d_input_rate;
 }
@@ -399,11 +525,16 @@ unsigned int receiver::set_input_decim(unsigned int decim)
     {
         d_quad_rate = d_input_rate;
     }
+    apply_latency_profile();
+    apply_affinity();
 
     // update quadrature rate
     dc_corr->set_sample_rate(d_quad_rate);
-    rx->set_quad_rate(d_quad_rate);
-    lo->set_sampling_freq(d_quad_rate);
+    update_ddc();
+    if (chanizer)
+        chanizer->set_sample_rate(d_quad_rate);
+    for (size_t i = 0; i < d_vfos.size(); i++)
+        reroute_vfo((int)i);
 
     if (d_decim >= 2)
     {
@@ -421,7 +552,7 @@ unsigned int receiver::set_input_decim(unsigned int decim)
 #endif
 
     if (d_running)
-        tb->start();
+        tb_start();
 
     return d_decim;
 }
@@ -641,7 +772,10 @@ receiver::status receiver::set_auto_gain(bool automatic)
 receiver::status receiver::set_filter_offset(double offset_hz)
 {
     d_filter_offset = offset_hz;
-    lo->set_frequency(-d_filter_offset + d_cw_offset);
+    if (nb_ddc)
+        nb_ddc->set_offset(-d_filter_offset + d_cw_offset);
+    if (wfm_ddc)
+        wfm_ddc->set_offset(-d_filter_offset + d_cw_offset);
 
     return STATUS_OK;
 }
@@ -660,8 +794,16 @@ double receiver::get_filter_offset(void) const
 receiver::status receiver::set_cw_offset(double offset_hz)
 {
     d_cw_offset = offset_hz;
-    lo->set_frequency(-d_filter_offset + d_cw_offset);
-    rx->set_cw_offset(d_cw_offset);
+    if (nb_rx)
+    {
+        nb_ddc->set_offset(-d_filter_offset + d_cw_offset);
+        nb_rx->set_cw_offset(d_cw_offset);
+    }
+    if (wfm_rx)
+    {
+        wfm_ddc->set_offset(-d_filter_offset + d_cw_offset);
+        wfm_rx->set_cw_offset(d_cw_offset);
+    }
 
     return STATUS_OK;
 }
@@ -671,31 +813,31 @@ double receiver::get_cw_offset(void) const
     return d_cw_offset;
 }
 
-receiver::status receiver::set_filter(double low, double high, filter_shape shape)
+/** Get the transition width corresponding to a filter shape. */
+static double filter_trans_width(double low, double high,
+                                 receiver::filter_shape shape)
 {
-    double trans_width;
-
-    if ((low >= high) || (std::abs(high-low) < RX_FILTER_MIN_WIDTH))
-        return STATUS_ERROR;
-
     switch (shape) {
 
-    case FILTER_SHAPE_SOFT:
-        trans_width = std::abs(high - low) * 0.5;
-        break;
+    case receiver::FILTER_SHAPE_SOFT:
+        return std::abs(high - low) * 0.5;
 
-    case FILTER_SHAPE_SHARP:
-        trans_width = std::abs(high - low) * 0.1;
-        break;
+    case receiver::FILTER_SHAPE_SHARP:
+        return std::abs(high - low) * 0.1;
 
-    case FILTER_SHAPE_NORMAL:
+    case receiver::FILTER_SHAPE_NORMAL:
     default:
-        trans_width = std::abs(high - low) * 0.2;
-        break;
+        return std::abs(high - low) * 0.2;
 
     }
+}
+
+receiver::status receiver::set_filter(double low, double high, filter_shape shape)
+{
+    if ((low >= high) || (std::abs(high-low) < RX_FILTER_MIN_WIDTH))
+        return STATUS_ERROR;
 
-    rx->set_filter(low, high, trans_width);
+    rx->set_filter(low, high, filter_trans_width(low, high, shape));
 
     return STATUS_OK;
 }
@@ -723,19 +865,355 @@ float receiver::get_signal_pwr(bool dbfs) const
 /** Set new FFT size. */
 void receiver::set_iq_fft_size(int newsize)
 {
+    d_iq_fft_size = newsize;
     iq_fft->set_fft_size(newsize);
+    if (zoom_fft)
+        zoom_fft->set_fft_size(zoom_fft_size());
+}
+
+/**
+ * @brief Set the number of threads used by large baseband FFTs.
+ * @param nthreads The number of FFTW threads for FFT sizes of 64k and above.
+ */
+void receiver::set_iq_fft_threads(int nthreads)
+{
+    iq_fft->set_fft_threads(nthreads > 1 ? nthreads : 1);
+}
+
+/**
+ * @brief Set the frame rate of the baseband power spectrum.
+ * @param fps The frame rate; 0 computes the spectrum on demand.
+ *
+ * The spectrum is computed by a worker thread in the FFT block at this rate,
+ * so get_iq_spectrum() only copies the latest frame.
+ */
+void receiver::set_iq_fft_rate(float fps)
+{
+    d_iq_fft_rate = fps;
+
+    /* only the displayed spectrum is computed continuously */
+    if (d_zoom_span > 0.0)
+        zoom_fft->set_spectrum_rate(fps);
+    else
+        iq_fft->set_spectrum_rate(fps);
+}
+
+/**
+ * @brief Set the averaging of the baseband power spectrum.
+ * @param avg The weight of a new frame (0...1); 1.0 disables averaging.
+ */
+void receiver::set_iq_fft_avg(float avg)
+{
+    d_iq_fft_avg = avg;
+    iq_fft->set_spectrum_avg(avg);
+    if (zoom_fft)
+        zoom_fft->set_spectrum_avg(avg);
+}
+
+/**
+ * @brief Set the window of the baseband power spectrum.
+ * @param wintype The window type (see gr::filter::firdes::win_type).
+ *
+ * The spectrum is calibrated in dBFS for every window type, and recently
+ * used windows are cached, so switching is cheap (see fft_window_get()).
+ */
+void receiver::set_iq_fft_window(int wintype)
+{
+    d_iq_fft_window = wintype;
+    iq_fft->set_window_type(wintype);
+    if (zoom_fft)
+        zoom_fft->set_window_type(wintype);
+}
+
+/**
+ * @brief Configure Welch averaging of the baseband power spectrum.
+ * @param overlap The overlap between FFT segments (0...0.9).
+ * @param budget The CPU budget in cores (e.g. 0.5), 0 to disable.
+ *
+ * With Welch averaging every baseband sample contributes to the spectrum,
+ * which lowers the variance of the noise floor. The estimator skips samples
+ * when it needs more CPU time than the budget allows; the fraction of
+ * samples used is included in get_spectrum_report().
+ */
+void receiver::set_iq_fft_welch(float overlap, float budget)
+{
+    iq_fft->set_welch(overlap, budget);
+}
+
+/**
+ * @brief Get the latest baseband power spectrum.
+ * @param pwr Buffer for the spectrum in dBFS (MAX_FFT_SIZE).
+ * @param avg Buffer for the averaged spectrum in dBFS (MAX_FFT_SIZE, may be NULL).
+ * @param fftsize The number of bins (output), 0 if no data is available.
+ *
+ * The bins are in frequency order with DC in the middle.
+ */
+void receiver::get_iq_spectrum(float *pwr, float *avg, unsigned int &fftsize)
+{
+    iq_fft->get_spectrum(pwr, avg, fftsize);
+}
+
+/**
+ * @brief Register an additional consumer of the baseband spectrum.
+ * @param fftsize The FFT size (up to MAX_FFT_SIZE).
+ * @param wintype The window type (see gr::filter::firdes::win_type).
+ * @param avg The averaging factor (1.0 = off).
+ * @param fps The frame rate; 0 computes the spectrum on demand.
+ * @return The consumer ID for get_iq_consumer_spectrum(), or -1 on error.
+ *
+ * The consumer gets its own spectrum computed from the same samples as the
+ * main spectrum, which is not affected. Consumers with identical settings
+ * share the computation (see rx_fft_c::add_consumer()).
+ */
+int receiver::add_iq_spectrum_consumer(unsigned int fftsize, int wintype,
+                                       float avg, float fps)
+{
+    rx_spectrum_request req;
+
+    req.fftsize = fftsize;
+    req.wintype = wintype;
+    req.avg = avg;
+    req.fps = fps;
+
+    return iq_fft->add_consumer(req);
+}
+
+/** Remove a consumer registered with add_iq_spectrum_consumer(). */
+void receiver::remove_iq_spectrum_consumer(int id)
+{
+    iq_fft->remove_consumer(id);
+}
+
+/**
+ * @brief Get the latest baseband spectrum of a consumer.
+ * @param id The consumer ID returned by add_iq_spectrum_consumer().
+ * @param pwr Buffer for the spectrum in dBFS (FFT size of the consumer).
+ * @param avg Buffer for the averaged spectrum in dBFS (may be NULL).
+ * @param fftsize The number of bins (output), 0 if no data is available.
+ * @return false if there is no consumer with this ID.
+ */
+bool receiver::get_iq_consumer_spectrum(int id, float *pwr, float *avg,
+                                        unsigned int &fftsize)
+{
+    return iq_fft->get_consumer_spectrum(id, pwr, avg, fftsize);
+}
+
+/**
+ * @brief Set the span of the zoom spectrum.
+ * @param offset_hz The center of the span relative to the RF frequency.
+ * @param span_hz The width of the span; 0 disables the zoom spectrum.
+ *
+ * Zooming into a full band spectrum only shows fewer bins. The zoom spectrum
+ * translates the span to baseband and decimates it before the FFT instead,
+ * so the same FFT size gives the full resolution across the visible span.
+ * It is only used for spans below the quadrature rate / RX_ZOOM_MIN_DECIM;
+ * while it is active the spectrum worker of the full band FFT is stopped
+ * (see set_iq_fft_rate()). Changing the span only locks the flow graph when
+ * the decimation of the translating filter changes.
+ */
+receiver::status receiver::set_iq_fft_zoom(double offset_hz, double span_hz)
+{
+    bool    was_on = (d_zoom_span > 0.0);
+
+    if (span_hz <= 0.0 || span_hz * RX_ZOOM_MIN_DECIM > d_quad_rate)
+    {
+        if (was_on)
+        {
+            tb->lock();
+            tb->disconnect(iq_frontend(), 0, zoom_ddc, 0);
+            tb->disconnect(zoom_ddc, 0, zoom_fft, 0);
+            tb_unlock();
+            d_zoom_span = 0.0;
+            zoom_fft->set_spectrum_rate(0.0);
+            iq_fft->set_spectrum_rate(d_iq_fft_rate);
+        }
+        return STATUS_OK;
+    }
+
+    if (span_hz == d_zoom_span)
+    {
+        // panning only moves the translating filter
+        if (offset_hz != d_zoom_offset)
+        {
+            d_zoom_offset = offset_hz;
+            zoom_ddc->set_offset(-d_zoom_offset);
+        }
+        return STATUS_OK;
+    }
+
+    if (!zoom_fft)
+    {
+        zoom_ddc = make_rx_xlating_filter(d_quad_rate);
+        zoom_fft = make_rx_fft_c(8192u, d_iq_fft_window);
+        zoom_fft->set_spectrum_avg(d_iq_fft_avg);
+        apply_latency_profile();
+        apply_affinity();
+    }
+
+    d_zoom_offset = offset_hz;
+    d_zoom_span = span_hz;
+
+    if (was_on && !zoom_ddc->channel_rate_needs_rebuild(d_quad_rate, zoom_min_rate()))
+    {
+        // same decimation: retune without stopping the flow graph
+        update_zoom();
+        return STATUS_OK;
+    }
+
+    tb->lock();
+    update_zoom();
+    if (!was_on)
+    {
+        tb->connect(iq_frontend(), 0, zoom_ddc, 0);
+        tb->connect(zoom_ddc, 0, zoom_fft, 0);
+    }
+    tb_unlock();
+
+    if (!was_on)
+    {
+        iq_fft->set_spectrum_rate(0.0);
+        zoom_fft->set_spectrum_rate(d_iq_fft_rate);
+    }
+
+    return STATUS_OK;
+}
+
+/**
+ * @brief Get the latest zoom spectrum.
+ * @param pwr Buffer for the spectrum in dBFS (MAX_FFT_SIZE).
+ * @param avg Buffer for the averaged spectrum in dBFS (MAX_FFT_SIZE, may be NULL).
+ * @param fftsize The number of bins (output).
+ * @param offset_hz The center of the spectrum relative to the RF frequency (output).
+ * @param rate The frequency range covered by the bins (output).
+ * @return true if a zoom spectrum is available, false if the zoom spectrum
+ *         is off or has no data yet; use get_iq_spectrum() in that case.
+ */
+bool receiver::get_zoom_spectrum(float *pwr, float *avg, unsigned int &fftsize,
+                                 double &offset_hz, double &rate)
+{
+    fftsize = 0;
+    if (d_zoom_span <= 0.0)
+        return false;
+
+    zoom_fft->get_spectrum(pwr, avg, fftsize);
+    offset_hz = d_zoom_offset;
+    rate = zoom_ddc->get_output_rate();
+
+    return fftsize > 0;
+}
+
+/** Set the frame rate of the audio power spectrum (see set_iq_fft_rate()). */
+void receiver::set_audio_fft_rate(float fps)
+{
+    audio_fft->set_spectrum_rate(fps);
+}
+
+/**
+ * @brief Get the latest audio power spectrum.
+ *
+ * Unlike the baseband spectrum (see get_iq_spectrum()) this is a half
+ * spectrum: fftsize returns the number of bins from DC to half the audio rate.
+ */
+void receiver::get_audio_spectrum(float *pwr, unsigned int &fftsize)
+{
+    audio_fft->get_spectrum(pwr, 0, fftsize);
 }
 
-/** Get latest baseband FFT data. */
-void receiver::get_iq_fft_data(std::complex<float>* fftPoints, unsigned int &fftsize)
+/**
+ * @brief Get the baseband power spectrum as text.
+ * @param bins The number of bins to return. Neighbouring FFT bins are
+ *             combined using their maximum, so narrow signals are kept.
+ * @param fftsize The FFT size, 0 to use the main spectrum. Must be a power
+ *                of two up to MAX_FFT_SIZE.
+ * @return The spectrum, or an empty string if no data is available.
+ *
+ * The first line shows the FFT size, the number of bins and the frequency
+ * range; it is followed by one line with the averaged bins in dBFS.
+ *
+ * For any other FFT size a spectrum consumer is registered, with the window
+ * and averaging of the main spectrum at that time, and kept for later
+ * reports; it computes a frame per report. There is only one such consumer,
+ * which is replaced when the FFT size changes and removed by
+ * release_spectrum_report(). Its FFT plan is created in the background, so
+ * no spectrum is available until it is ready.
+ */
+std::string receiver::get_spectrum_report(unsigned int bins, unsigned int fftsize)
 {
-    iq_fft->get_fft_data(fftPoints, fftsize);
+    std::vector<float>  pwr(MAX_FFT_SIZE);
+    std::vector<float>  avg(MAX_FFT_SIZE);
+    std::ostringstream  report;
+    bool                main_fft = (fftsize == 0);
+    unsigned int        i, k, first, last;
+    float               val;
+
+    if (main_fft)
+    {
+        get_iq_spectrum(&pwr[0], &avg[0], fftsize);
+    }
+    else
+    {
+        if (fftsize < 2 || fftsize > MAX_FFT_SIZE || (fftsize & (fftsize - 1)))
+            return "";
+
+        if (fftsize != d_report_fftsize)
+        {
+            release_spectrum_report();
+            d_report_consumer = add_iq_spectrum_consumer(fftsize, iq_fft->get_window_type(),
+                                                         d_iq_fft_avg, 0.0);
+            if (d_report_consumer < 0)
+                return "";
+            d_report_fftsize = fftsize;
+        }
+        get_iq_consumer_spectrum(d_report_consumer, &pwr[0], &avg[0], fftsize);
+    }
+    if (fftsize == 0)
+        return "";
+
+    if (bins == 0 || bins > fftsize)
+        bins = fftsize;
+
+    report.setf(std::ios::fixed);
+    report.precision(0);
+    report << "# fft size: " << fftsize << ", bins: " << bins
+           << ", start: " << d_rf_freq - d_quad_rate / 2.0
+           << " Hz, stop: " << d_rf_freq + d_quad_rate / 2.0 << " Hz";
+    if (main_fft && iq_fft->get_welch_budget() > 0.0)
+    {
+        report.precision(3);
+        report << ", coverage: " << iq_fft->get_welch_coverage();
+    }
+    report << "\n";
+
+    report.precision(1);
+    for (i = 0; i < bins; i++)
+    {
+        first = (unsigned int)((uint64_t)i * fftsize / bins);
+        last = (unsigned int)((uint64_t)(i + 1) * fftsize / bins);
+        val = avg[first];
+        for (k = first + 1; k < last; k++)
+            val = std::max(val, avg[k]);
+
+        report << (i ? " " : "") << val;
+    }
+    report << "\n";
+
+    return report.str();
 }
 
-/** Get latest audio FFT data. */
-void receiver::get_audio_fft_data(std::complex<float>* fftPoints, unsigned int &fftsize)
+/**
+ * @brief Remove the spectrum consumer of get_spectrum_report().
+ *
+ * Called when the remote control client disconnects, so the FFT and the
+ * samples kept for it are released.
+ */
+void receiver::release_spectrum_report(void)
 {
-    audio_fft->get_fft_data(fftPoints, fftsize);
+    if (d_report_consumer < 0)
+        return;
+
+    remove_iq_spectrum_consumer(d_report_consumer);
+    d_report_consumer = -1;
+    d_report_fftsize = 0;
 }
 
 receiver::status receiver::set_nb_on(int nbid, bool on)
@@ -833,15 +1311,89 @@ receiver::status receiver::set_agc_manual_gain(int gain)
     return STATUS_OK; // FIXME
 }
 
+/**
+ * @brief Get the demodulator chain used by a demodulator.
+ * @param demod The demodulator.
+ * @param[out] chain_demod The demodulator selector of the chain, i.e.
+ *                         nbrx::nbrx_demod or wfmrx::wfmrx_demod.
+ */
+static receiver::rx_chain get_demod_chain(receiver::rx_demod demod,
+                                          int *chain_demod)
+{
+    switch (demod)
+    {
+    case receiver::RX_DEMOD_NONE:
+        *chain_demod = nbrx::NBRX_DEMOD_NONE;
+        return receiver::RX_CHAIN_NBRX;
+
+    case receiver::RX_DEMOD_AM:
+        *chain_demod = nbrx::NBRX_DEMOD_AM;
+        return receiver::RX_CHAIN_NBRX;
+
+    case receiver::RX_DEMOD_NFM:
+        *chain_demod = nbrx::NBRX_DEMOD_FM;
+        return receiver::RX_CHAIN_NBRX;
+
+    case receiver::RX_DEMOD_SSB:
+        *chain_demod = nbrx::NBRX_DEMOD_SSB;
+        return receiver::RX_CHAIN_NBRX;
+
+    case receiver::RX_DEMOD_WFM_M:
+        *chain_demod = wfmrx::WFMRX_DEMOD_MONO;
+        return receiver::RX_CHAIN_WFMRX;
+
+    case receiver::RX_DEMOD_WFM_S:
+        *chain_demod = wfmrx::WFMRX_DEMOD_STEREO;
+        return receiver::RX_CHAIN_WFMRX;
+
+    case receiver::RX_DEMOD_WFM_S_OIRT:
+        *chain_demod = wfmrx::WFMRX_DEMOD_STEREO_UKW;
+        return receiver::RX_CHAIN_WFMRX;
+
+    case receiver::RX_DEMOD_OFF:
+    default:
+        *chain_demod = 0;
+        return receiver::RX_CHAIN_NONE;
+    }
+}
+
+/**
+ * @brief Select demodulator.
+ * @param demod The new demodulator.
+ *
+ * Both receiver chains are always part of the flow graph once they have been
+ * created (see connect_all()), so switching between demodulators only changes
+ * the selectors and does not stop the flow graph or the input device. The
+ * whole flow graph is only reconfigured when switching from or to
+ * RX_DEMOD_OFF, when the current demodulator is selected again, or when a
+ * chain is used for the first time.
+ */
 receiver::status receiver::set_demod(rx_demod demod)
 {
-    status ret = STATUS_OK;
+    rx_chain    chain;
+    int         chain_demod;
+
+    bool        created;
+
+    chain = get_demod_chain(demod, &chain_demod);
+    if (chain == RX_CHAIN_NONE && demod != RX_DEMOD_OFF)
+        return STATUS_ERROR;
+
+    // a chain that is used for the first time must be connected
+    created = (chain != RX_CHAIN_NONE) && create_chain(chain);
+
+    if (chain != RX_CHAIN_NONE && d_demod != RX_DEMOD_OFF && demod != d_demod &&
+        !created)
+    {
+        select_chain(chain, chain_demod);
+        d_demod = demod;
+
+        return STATUS_OK;
+    }
 
     // Allow reconf using same demod to provide a workaround
     // for the "jerky streaming" we may experience with rtl
     // dongles (the jerkyness disappears when we run this function)
-    //if (demod == d_demod)
-    //    return ret;
 
     // tb->lock() seems to hang occasioanlly
     if (d_running)
@@ -851,59 +1403,45 @@ receiver::status receiver::set_demod(rx_demod demod)
     }
 
     tb->disconnect_all();
+    connect_all(chain);
+    if (chain != RX_CHAIN_NONE)
+        select_chain(chain, chain_demod);
 
-    switch (demod)
-    {
-    case RX_DEMOD_OFF:
-        connect_all(RX_CHAIN_NONE);
-        break;
-
-    case RX_DEMOD_NONE:
-        connect_all(RX_CHAIN_NBRX);
-        rx->set_demod(nbrx::NBRX_DEMOD_NONE);
-        break;
-
-    case RX_DEMOD_AM:
-        connect_all(RX_CHAIN_NBRX);
-        rx->set_demod(nbrx::NBRX_DEMOD_AM);
-        break;
+    d_demod = demod;
 
-    case RX_DEMOD_NFM:
-        connect_all(RX_CHAIN_NBRX);
-        rx->set_demod(nbrx::NBRX_DEMOD_FM);
-        break;
+    if (d_running)
+        tb_start();
 
-    case RX_DEMOD_WFM_M:
-        connect_all(RX_CHAIN_WFMRX);
-        rx->set_demod(wfmrx::WFMRX_DEMOD_MONO);
-        break;
+    return STATUS_OK;
+}
 
-    case RX_DEMOD_WFM_S:
-        connect_all(RX_CHAIN_WFMRX);
-        rx->set_demod(wfmrx::WFMRX_DEMOD_STEREO);
-        break;
-
-    case RX_DEMOD_WFM_S_OIRT:
-        connect_all(RX_CHAIN_WFMRX);
-        rx->set_demod(wfmrx::WFMRX_DEMOD_STEREO_UKW);
-        break;
-
-    case RX_DEMOD_SSB:
-        connect_all(RX_CHAIN_NBRX);
-        rx->set_demod(nbrx::NBRX_DEMOD_SSB);
-        break;
-
-    default:
-        ret = STATUS_ERROR;
-        break;
+/**
+ * @brief Switch to another receiver chain.
+ * @param type The receiver chain to use (RX_CHAIN_NBRX or RX_CHAIN_WFMRX).
+ * @param chain_demod The demodulator to select in the chain.
+ *
+ * The valve of the new chain is opened before the selector is switched and
+ * the valve of the old chain is closed afterwards, so the audio stream is
+ * never interrupted. Safe to call while the flow graph is running.
+ */
+void receiver::select_chain(rx_chain type, int chain_demod)
+{
+    if (type == RX_CHAIN_WFMRX)
+    {
+        wfm_rx->set_demod(chain_demod);
+        wfm_valve->set_enabled(true);
+        rx_sel->set_group(1);
+        nb_valve->set_enabled(false);
+        rx = wfm_rx;
+    }
+    else
+    {
+        nb_rx->set_demod(chain_demod);
+        nb_valve->set_enabled(true);
+        rx_sel->set_group(0);
+        wfm_valve->set_enabled(false);
+        rx = nb_rx;
     }
-
-    d_demod = demod;
-
-    if (d_running)
-        tb->start();
-
-    return ret;
 }
 
 /**
@@ -979,17 +1517,28 @@ receiver::status receiver::start_audio_recording(const std::string filename)
 
     // if this fails, we don't want to go and crash now, do we
     try {
-        wav_sink->open(filename.c_str());
-        wav_sink->set_sample_rate((unsigned int) d_audio_rate);
+        // the sink is created by the first recording and reused afterwards
+        if (wav_sink)
+        {
+            wav_sink->open(filename.c_str());
+            wav_sink->set_sample_rate((unsigned int) d_audio_rate);
+        }
+        else
+        {
+            wav_sink = gr::blocks::wavfile_sink::make(filename.c_str(), 2,
+                                                      (unsigned int) d_audio_rate,
+                                                      16);
+        }
     }
     catch (std::runtime_error &e) {
         std::cout << "Error opening " << filename << ": " << e.what() << std::endl;
+        tb_unlock();
         return STATUS_ERROR;
     }
 
-    tb->connect(rx, 0, wav_sink, 0);
-    tb->connect(rx, 1, wav_sink, 1);
-    tb->unlock();
+    tb->connect(rx_sel, 0, wav_sink, 0);
+    tb->connect(rx_sel, 1, wav_sink, 1);
+    tb_unlock();
     d_recording_wav = true;
 
     std::cout << "Recording audio to " << filename << std::endl;
@@ -1017,9 +1566,9 @@ receiver::status receiver::stop_audio_recording()
     // not strictly necessary to lock but I think it is safer
     tb->lock();
     wav_sink->close();
-    tb->disconnect(rx, 0, wav_sink, 0);
-    tb->disconnect(rx, 1, wav_sink, 1);
-    tb->unlock();
+    tb->disconnect(rx_sel, 0, wav_sink, 0);
+    tb->disconnect(rx_sel, 1, wav_sink, 1);
+    tb_unlock();
     d_recording_wav = false;
 
     std::cout << "Audio recorder stopped" << std::endl;
@@ -1068,16 +1617,18 @@ receiver::status receiver::start_audio_playback(const std::string filename)
 
     stop();
     /* route demodulator output to null sink */
-    tb->disconnect(rx, 0, audio_gain0, 0);
-    tb->disconnect(rx, 1, audio_gain1, 0);
-    tb->disconnect(rx, 0, audio_fft, 0);
-    tb->disconnect(rx, 0, audio_udp_sink, 0);
-    tb->connect(rx, 0, audio_null_sink0, 0); /** FIXME: other channel? */
-    tb->connect(rx, 1, audio_null_sink1, 0); /** FIXME: other channel? */
+    tb->disconnect(rx_sel, 0, audio_gain0, 0);
+    tb->disconnect(rx_sel, 1, audio_gain1, 0);
+    tb->disconnect(rx_sel, 0, audio_fft, 0);
+    if (audio_udp_sink)
+        tb->disconnect(rx_sel, 0, audio_udp_sink, 0);
+    tb->connect(rx_sel, 0, audio_null_sink0, 0); /** FIXME: other channel? */
+    tb->connect(rx_sel, 1, audio_null_sink1, 0); /** FIXME: other channel? */
     tb->connect(wav_src, 0, audio_gain0, 0);
     tb->connect(wav_src, 1, audio_gain1, 0);
     tb->connect(wav_src, 0, audio_fft, 0);
-    tb->connect(wav_src, 0, audio_udp_sink, 0);
+    if (audio_udp_sink)
+        tb->connect(wav_src, 0, audio_udp_sink, 0);
     start();
 
     std::cout << "Playing audio from " << filename << std::endl;
@@ -1093,13 +1644,15 @@ receiver::status receiver::stop_audio_playback()
     tb->disconnect(wav_src, 0, audio_gain0, 0);
     tb->disconnect(wav_src, 1, audio_gain1, 0);
     tb->disconnect(wav_src, 0, audio_fft, 0);
-    tb->disconnect(wav_src, 0, audio_udp_sink, 0);
-    tb->disconnect(rx, 0, audio_null_sink0, 0);
-    tb->disconnect(rx, 1, audio_null_sink1, 0);
-    tb->connect(rx, 0, audio_gain0, 0);
-    tb->connect(rx, 1, audio_gain1, 0);
-    tb->connect(rx, 0, audio_fft, 0);  /** FIXME: other channel? */
-    tb->connect(rx, 0, audio_udp_sink, 0);
+    if (audio_udp_sink)
+        tb->disconnect(wav_src, 0, audio_udp_sink, 0);
+    tb->disconnect(rx_sel, 0, audio_null_sink0, 0);
+    tb->disconnect(rx_sel, 1, audio_null_sink1, 0);
+    tb->connect(rx_sel, 0, audio_gain0, 0);
+    tb->connect(rx_sel, 1, audio_gain1, 0);
+    tb->connect(rx_sel, 0, audio_fft, 0);  /** FIXME: other channel? */
+    if (audio_udp_sink)
+        tb->connect(rx_sel, 0, audio_udp_sink, 0);
     start();
 
     /* delete wav_src since we can not change file name */
@@ -1108,9 +1661,29 @@ receiver::status receiver::stop_audio_playback()
     return STATUS_OK;
 }
 
-/** Start UDP streaming of audio. */
+/**
+ * @brief Start UDP streaming of audio.
+ *
+ * The UDP sink is created and connected the first time streaming is
+ * started; afterwards it stays in the flow graph and only drops the
+ * samples while streaming is stopped.
+ */
 receiver::status receiver::start_udp_streaming(const std::string host, int port)
 {
+    if (!audio_udp_sink)
+    {
+        audio_udp_sink = make_udp_sink_f();
+        if (d_demod != RX_DEMOD_OFF)
+        {
+            tb->lock();
+            if (wav_src)
+                tb->connect(wav_src, 0, audio_udp_sink, 0);
+            else
+                tb->connect(rx_sel, 0, audio_udp_sink, 0);
+            tb_unlock();
+        }
+    }
+
     audio_udp_sink->start_streaming(host, port);
     return STATUS_OK;
 }
@@ -1118,7 +1691,8 @@ receiver::status receiver::start_udp_streaming(const std::string host, int port)
 /** Stop UDP streaming of audio. */
 receiver::status receiver::stop_udp_streaming()
 {
-    audio_udp_sink->stop_streaming();
+    if (audio_udp_sink)
+        audio_udp_sink->stop_streaming();
     return STATUS_OK;
 }
 
@@ -1135,28 +1709,36 @@ receiver::status receiver::start_iq_recording(const std::string filename)
         return STATUS_ERROR;
     }
 
-    // iq_sink was created in the constructor
-    if (iq_sink) {
-        tb->lock();
-        if (!iq_sink->open(filename.c_str()))
-        {
-            status = STATUS_ERROR;
+    // iq_sink is created by the first recording and reused afterwards
+    if (!iq_sink) {
+        try {
+            iq_sink = gr::blocks::file_sink::make(sizeof(gr_complex),
+                                                  get_null_file().c_str(), true);
         }
-        else
-        {
-            if (d_decim >= 2)
-                tb->connect(input_decim, 0, iq_sink, 0);
-            else
-                tb->connect(src, 0, iq_sink, 0);
-
-            d_recording_iq = true;
+        catch (std::runtime_error &e) {
+            std::cout << __func__ << ": can not create I/Q file sink: "
+                      << e.what() << std::endl;
+            return STATUS_ERROR;
         }
-        tb->unlock();
+        iq_sink->set_unbuffered(true);
+        iq_sink->close();
     }
-    else {
-        std::cout << __func__ << ": I/Q file sink does not exist" << std::endl;
-        return STATUS_ERROR;
+
+    tb->lock();
+    if (!iq_sink->open(filename.c_str()))
+    {
+        status = STATUS_ERROR;
     }
+    else
+    {
+        if (d_decim >= 2)
+            tb->connect(input_decim, 0, iq_sink, 0);
+        else
+            tb->connect(src, 0, iq_sink, 0);
+
+        d_recording_iq = true;
+    }
+    tb_unlock();
 
     return status;
 }
@@ -1177,7 +1759,7 @@ receiver::status receiver::stop_iq_recording()
     else
         tb->disconnect(src, 0, iq_sink, 0);
 
-    tb->unlock();
+    tb_unlock();
     d_recording_iq = false;
 
     return STATUS_OK;
@@ -1202,7 +1784,7 @@ receiver::status receiver::seek_iq_file(long pos)
         status = STATUS_ERROR;
     }
 
-    tb->unlock();
+    tb_unlock();
 
     return status;
 }
@@ -1219,12 +1801,15 @@ receiver::status receiver::start_sniffer(unsigned int samprate, int buffsize)
         return STATUS_ERROR;
     }
 
+    if (!sniffer)
+        sniffer = make_sniffer_f();
     sniffer->set_buffer_size(buffsize);
     sniffer_rr = make_resampler_ff((float)samprate/(float)d_audio_rate);
+    apply_latency_profile();
     tb->lock();
-    tb->connect(rx, 0, sniffer_rr, 0);
+    tb->connect(rx_sel, 0, sniffer_rr, 0);
     tb->connect(sniffer_rr, 0, sniffer, 0);
-    tb->unlock();
+    tb_unlock();
     d_sniffer_active = true;
 
     return STATUS_OK;
@@ -1241,9 +1826,9 @@ receiver::status receiver::stop_sniffer()
     }
 
     tb->lock();
-    tb->disconnect(rx, 0, sniffer_rr, 0);
+    tb->disconnect(rx_sel, 0, sniffer_rr, 0);
     tb->disconnect(sniffer_rr, 0, sniffer, 0);
-    tb->unlock();
+    tb_unlock();
     d_sniffer_active = false;
 
     /* delete resampler */
@@ -1255,7 +1840,10 @@ receiver::status receiver::stop_sniffer()
 /** Get sniffer data. */
 void receiver::get_sniffer_data(float * outbuff, unsigned int &num)
 {
-    sniffer->get_samples(outbuff, num);
+    if (sniffer)
+        sniffer->get_samples(outbuff, num);
+    else
+        num = 0;
 }
 
 /** Convenience function to connect all blocks. */
@@ -1285,11 +1873,9 @@ void receiver::connect_all(rx_chain type)
         break;
 
     case RX_CHAIN_NBRX:
-        if (rx->name() != "NBRX")
-        {
-            rx.reset();
-            rx = make_nbrx(d_quad_rate, d_audio_rate);
-        }
+    case RX_CHAIN_WFMRX:
+        // Both chains are connected once created; the active one is chosen
+        // using the valves and rx_sel, see select_chain()
         if (d_decim >= 2)
         {
             tb->connect(src, 0, input_decim, 0);
@@ -1303,55 +1889,45 @@ void receiver::connect_all(rx_chain type)
         {
             tb->connect(iq_swap, 0, dc_corr, 0);
             tb->connect(dc_corr, 0, iq_fft, 0);
-            tb->connect(dc_corr, 0, mixer, 0);
         }
         else
         {
             tb->connect(iq_swap, 0, iq_fft, 0);
-            tb->connect(iq_swap, 0, mixer, 0);
         }
-        tb->connect(lo, 0, mixer, 1);
-        tb->connect(mixer, 0, rx, 0);
-        tb->connect(rx, 0, audio_fft, 0);
-        tb->connect(rx, 0, audio_udp_sink, 0);
-        tb->connect(rx, 0, audio_gain0, 0);
-        tb->connect(rx, 1, audio_gain1, 0);
-        tb->connect(audio_gain0, 0, audio_snk, 0);
-        tb->connect(audio_gain1, 0, audio_snk, 1);
-        break;
-
-    case RX_CHAIN_WFMRX:
-        if (rx->name() != "WFMRX")
-        {
-            rx.reset();
-            rx = make_wfmrx(d_quad_rate, d_audio_rate);
-        }
-        if (d_decim >= 2)
+        if (nb_rx)
         {
-            tb->connect(src, 0, input_decim, 0);
-            tb->connect(input_decim, 0, iq_swap, 0);
+            tb->connect(iq_frontend(), 0, nb_valve, 0);
+            tb->connect(nb_valve, 0, nb_ddc, 0);
+            tb->connect(nb_ddc, 0, nb_rx, 0);
+            tb->connect(nb_rx, 0, rx_sel, 0);
+            tb->connect(nb_rx, 1, rx_sel, 1);
         }
-        else
+        if (wfm_rx)
         {
-            tb->connect(src, 0, iq_swap, 0);
+            tb->connect(iq_frontend(), 0, wfm_valve, 0);
+            tb->connect(wfm_valve, 0, wfm_ddc, 0);
+            tb->connect(wfm_ddc, 0, wfm_rx, 0);
+            tb->connect(wfm_rx, 0, rx_sel, 2);
+            tb->connect(wfm_rx, 1, rx_sel, 3);
         }
-        if (d_dc_cancel)
+        // All inputs of rx_sel must be connected; the inputs of a chain that
+        // has not been created are fed by the other chain. They are never
+        // selected, so the data is dropped.
+        if (!nb_rx)
         {
-            tb->connect(iq_swap, 0, dc_corr, 0);
-            tb->connect(dc_corr, 0, iq_fft, 0);
-            tb->connect(dc_corr, 0, mixer, 0);
+            tb->connect(wfm_rx, 0, rx_sel, 0);
+            tb->connect(wfm_rx, 1, rx_sel, 1);
         }
-        else
+        if (!wfm_rx)
         {
-            tb->connect(iq_swap, 0, iq_fft, 0);
-            tb->connect(iq_swap, 0, mixer, 0);
+            tb->connect(nb_rx, 0, rx_sel, 2);
+            tb->connect(nb_rx, 1, rx_sel, 3);
         }
-        tb->connect(lo, 0, mixer, 1);
-        tb->connect(mixer, 0, rx, 0);
-        tb->connect(rx, 0, audio_fft, 0);
-        tb->connect(rx, 0, audio_udp_sink, 0);
-        tb->connect(rx, 0, audio_gain0, 0);
-        tb->connect(rx, 1, audio_gain1, 0);
+        tb->connect(rx_sel, 0, audio_fft, 0);
+        if (audio_udp_sink)
+            tb->connect(rx_sel, 0, audio_udp_sink, 0);
+        tb->connect(rx_sel, 0, audio_gain0, 0);
+        tb->connect(rx_sel, 1, audio_gain1, 0);
         tb->connect(audio_gain0, 0, audio_snk, 0);
         tb->connect(audio_gain1, 0, audio_snk, 1);
         break;
@@ -1371,15 +1947,151 @@ void receiver::connect_all(rx_chain type)
 
     if (d_recording_wav)
     {
-        tb->connect(rx, 0, wav_sink, 0);
-        tb->connect(rx, 1, wav_sink, 1);
+        tb->connect(rx_sel, 0, wav_sink, 0);
+        tb->connect(rx_sel, 1, wav_sink, 1);
     }
 
     if (d_sniffer_active)
     {
-        tb->connect(rx, 0, sniffer_rr, 0);
+        tb->connect(rx_sel, 0, sniffer_rr, 0);
         tb->connect(sniffer_rr, 0, sniffer, 0);
     }
+
+    if (d_zoom_span > 0.0)
+    {
+        tb->connect(iq_frontend(), 0, zoom_ddc, 0);
+        tb->connect(zoom_ddc, 0, zoom_fft, 0);
+    }
+
+    // additional channels are independent of the main demodulator
+    if (chanizer)
+        tb->connect(iq_frontend(), 0, chanizer, 0);
+    for (size_t i = 0; i < d_vfos.size(); i++)
+        connect_vfo((int)i);
+}
+
+/**
+ * @brief Update the input decimation of the receiver chains.
+ *
+ * The translating filters decimate the quadrature stream to about twice the
+ * preferred rate of their demodulator chain; this must be called whenever
+ * the quadrature rate changes.
+ */
+void receiver::update_ddc(void)
+{
+    if (nb_rx)
+    {
+        nb_ddc->set_channel_rate(d_quad_rate, 2.0 * nb_rx->get_pref_quad_rate());
+        nb_rx->set_quad_rate(nb_ddc->get_output_rate());
+    }
+    if (wfm_rx)
+    {
+        wfm_ddc->set_channel_rate(d_quad_rate, 2.0 * wfm_rx->get_pref_quad_rate());
+        wfm_rx->set_quad_rate(wfm_ddc->get_output_rate());
+    }
+    if (d_zoom_span > 0.0)
+        update_zoom();
+}
+
+/**
+ * @brief Configure the zoom spectrum for the current span.
+ *
+ * The translating filter decimates to the lowest rate that keeps the span
+ * inside its pass band (+/- 0.4 * output rate). When the filter is part of
+ * a running flow graph and the decimation changes the caller must hold the
+ * top block lock, see rx_xlating_filter::channel_rate_needs_rebuild().
+ */
+void receiver::update_zoom(void)
+{
+    zoom_ddc->set_channel_rate(d_quad_rate, zoom_min_rate());
+    zoom_ddc->set_offset(-d_zoom_offset);
+    zoom_fft->set_fft_size(zoom_fft_size());
+}
+
+/** The lowest sample rate that keeps the zoom span inside the pass band. */
+double receiver::zoom_min_rate(void) const
+{
+    return d_zoom_span / 0.8;
+}
+
+/**
+ * @brief Get the FFT size of the zoom spectrum.
+ *
+ * This is the baseband FFT size, but at most about one second of samples at
+ * the decimated rate so the frames still follow the signal.
+ */
+unsigned int receiver::zoom_fft_size(void) const
+{
+    unsigned int size = d_iq_fft_size;
+
+    while (size > 1024 && size > zoom_ddc->get_output_rate())
+        size /= 2;
+
+    return size;
+}
+
+/**
+ * @brief Create a receiver chain unless it already exists.
+ * @param type The receiver chain (RX_CHAIN_NBRX or RX_CHAIN_WFMRX).
+ * @return true if the chain has been created, false if it already existed.
+ *
+ * The receiver chains are created on first use and kept afterwards, so the
+ * broadcast FM chain does not cost anything until a WFM demodulator is
+ * selected. The caller must connect the new chain (see connect_all()).
+ */
+bool receiver::create_chain(rx_chain type)
+{
+    gr::high_res_timer_type t_start = gr::high_res_timer_now();
+
+    if (type == RX_CHAIN_WFMRX)
+    {
+        if (wfm_rx)
+            return false;
+
+        wfm_rx = make_wfmrx(d_quad_rate, d_audio_rate);
+        wfm_ddc = make_rx_xlating_filter(d_quad_rate);
+        wfm_ddc->set_offset(-d_filter_offset + d_cw_offset);
+        wfm_rx->set_cw_offset(d_cw_offset);
+    }
+    else
+    {
+        if (nb_rx)
+            return false;
+
+        nb_rx = make_nbrx(d_quad_rate, d_audio_rate);
+        nb_ddc = make_rx_xlating_filter(d_quad_rate);
+        nb_ddc->set_offset(-d_filter_offset + d_cw_offset);
+        nb_rx->set_cw_offset(d_cw_offset);
+    }
+    update_ddc();
+    apply_latency_profile();
+    apply_affinity();
+
+#ifndef QT_NO_DEBUG_OUTPUT
+    std::cout << "Created " << (type == RX_CHAIN_WFMRX ? "WFM" : "narrow band")
+              << " receiver chain in "
+              << startup_ms(t_start, gr::high_res_timer_now()) << " ms"
+              << std::endl;
+#else
+    (void) t_start;
+#endif
+
+    return true;
+}
+
+/**
+ * @brief Get the last block of the I/Q front-end.
+ *
+ * This is the block that feeds the FFT, the main channel and the additional
+ * channels, i.e. the DC corrector if DC removal is enabled, otherwise the
+ * I/Q swapper.
+ */
+gr::basic_block_sptr receiver::iq_frontend(void) const
+{
+    if (d_dc_cancel)
+        return dc_corr;
+    else
+        return iq_swap;
 }
 
 void receiver::get_rds_data(std::string &outbuff, int &num)
@@ -1410,3 +2122,948 @@ void receiver::reset_rds_parser(void)
 {
     rx->reset_rds_parser();
 }
+
+/**
+ * @brief Add a new channel (VFO).
+ * @param offset_hz The channel offset from the RF center frequency.
+ * @param demod The demodulator to use in the new channel.
+ * @return The index of the new channel or -1 if an error occurred.
+ *
+ * The new channel is connected to the same I/Q front-end as the main
+ * receiver, or to a sub-band of the channelizer if it is enabled, and can be
+ * used while the receiver is running. The audio of additional channels is not
+ * sent to the sound card; use UDP streaming or WAV recording to get it out.
+ */
+int receiver::add_vfo(double offset_hz, rx_demod demod)
+{
+    receiver_base_cf_sptr   demod_rx;
+    vfo_info                vfo;
+    double                  residual;
+    double                  rate;
+    int                     chain_demod;
+
+    // the rate is updated by the channel once the sub-band is known
+    switch (get_demod_chain(demod, &chain_demod))
+    {
+    case RX_CHAIN_NBRX:
+        demod_rx = make_nbrx(d_quad_rate, d_audio_rate);
+        break;
+
+    case RX_CHAIN_WFMRX:
+        demod_rx = make_wfmrx(d_quad_rate, d_audio_rate);
+        break;
+
+    default:
+        return -1;
+    }
+
+    vfo.subband = vfo_subband(demod_rx, offset_hz, &residual);
+    rate = vfo_input_rate(vfo.subband);
+
+    vfo.channel = make_rx_channel(rate, d_audio_rate, demod_rx);
+    vfo.channel->set_offset(residual);
+    vfo.demod = demod;
+    vfo.offset = offset_hz;
+    d_vfos.push_back(vfo);
+    apply_latency_profile();
+    apply_affinity();
+
+    tb->lock();
+    connect_vfo((int)d_vfos.size() - 1);
+    demod_rx->set_demod(chain_demod);
+    tb_unlock();
+
+    return (int)d_vfos.size() - 1;
+}
+
+/**
+ * @brief Remove a channel.
+ * @param vfo The index of the channel to remove.
+ *
+ * The indices of the channels following the removed one are decremented.
+ */
+receiver::status receiver::remove_vfo(int vfo)
+{
+    if (!vfo_is_valid(vfo))
+        return STATUS_ERROR;
+
+    tb->lock();
+    d_vfos[vfo].channel->stop_audio_recording();
+    disconnect_vfo(vfo);
+    tb_unlock();
+
+    d_vfos.erase(d_vfos.begin() + vfo);
+
+    return STATUS_OK;
+}
+
+/**
+ * @brief Set channel offset from the RF center frequency.
+ *
+ * When the channelizer is enabled the flow graph is only locked if the
+ * channel moves to another sub-band; tuning within the sub-band only
+ * changes the fine tuning oscillator.
+ */
+receiver::status receiver::set_vfo_offset(int vfo, double offset_hz)
+{
+    double  residual;
+
+    if (!vfo_is_valid(vfo))
+        return STATUS_ERROR;
+
+    d_vfos[vfo].offset = offset_hz;
+    if (vfo_subband(d_vfos[vfo].channel->demodulator(), offset_hz, &residual) ==
+        d_vfos[vfo].subband)
+    {
+        d_vfos[vfo].channel->set_offset(residual);
+    }
+    else
+    {
+        tb->lock();
+        reroute_vfo(vfo);
+        tb_unlock();
+    }
+
+    return STATUS_OK;
+}
+
+/** Get channel offset from the RF center frequency. */
+double receiver::get_vfo_offset(int vfo) const
+{
+    if (!vfo_is_valid(vfo))
+        return 0.0;
+
+    return d_vfos[vfo].offset;
+}
+
+/**
+ * @brief Select demodulator of a channel.
+ * @param vfo The channel index.
+ * @param demod The new demodulator. RX_DEMOD_OFF is not allowed, use
+ *              remove_vfo() instead.
+ *
+ * Switching between modes of the same chain (e.g. AM and SSB) reuses the
+ * existing demodulator and is done without locking the flow graph. A new
+ * chain is only created when switching between narrow band and broadcast FM.
+ */
+receiver::status receiver::set_vfo_demod(int vfo, rx_demod demod)
+{
+    receiver_base_cf_sptr   demod_rx;
+    rx_chain                chain;
+    double                  rate;
+    int                     chain_demod;
+
+    if (!vfo_is_valid(vfo))
+        return STATUS_ERROR;
+
+    chain = get_demod_chain(demod, &chain_demod);
+    if (chain == RX_CHAIN_NONE)
+        return STATUS_ERROR;
+
+    rate = d_vfos[vfo].channel->get_quad_rate();
+    demod_rx = d_vfos[vfo].channel->demodulator();
+    if ((chain == RX_CHAIN_NBRX && demod_rx->name() == "NBRX") ||
+        (chain == RX_CHAIN_WFMRX && demod_rx->name() == "WFMRX"))
+    {
+        // same chain; this does not need the flow graph to be locked
+        demod_rx->set_demod(chain_demod);
+        d_vfos[vfo].demod = demod;
+        return STATUS_OK;
+    }
+
+    if (chain == RX_CHAIN_NBRX)
+        demod_rx = make_nbrx(rate, d_audio_rate);
+    else
+        demod_rx = make_wfmrx(rate, d_audio_rate);
+
+    tb->lock();
+    d_vfos[vfo].channel->set_demodulator(demod_rx);
+    apply_latency_profile();
+    apply_affinity();
+    demod_rx->set_demod(chain_demod);
+    d_vfos[vfo].demod = demod;
+    // broadcast FM may not fit into the sub-band used for narrow band
+    reroute_vfo(vfo);
+    tb_unlock();
+
+    return STATUS_OK;
+}
+
+/** Get current demodulator of a channel. */
+receiver::rx_demod receiver::get_vfo_demod(int vfo) const
+{
+    if (!vfo_is_valid(vfo))
+        return RX_DEMOD_OFF;
+
+    return d_vfos[vfo].demod;
+}
+
+/** Set channel filter. */
+receiver::status receiver::set_vfo_filter(int vfo, double low, double high,
+                                          filter_shape shape)
+{
+    if (!vfo_is_valid(vfo))
+        return STATUS_ERROR;
+
+    if ((low >= high) || (std::abs(high-low) < RX_FILTER_MIN_WIDTH))
+        return STATUS_ERROR;
+
+    d_vfos[vfo].channel->demodulator()->set_filter(low, high,
+                                   filter_trans_width(low, high, shape));
+
+    return STATUS_OK;
+}
+
+/** Set channel CW offset (BFO) in Hz. */
+receiver::status receiver::set_vfo_cw_offset(int vfo, double offset_hz)
+{
+    if (!vfo_is_valid(vfo))
+        return STATUS_ERROR;
+
+    d_vfos[vfo].channel->set_cw_offset(offset_hz);
+
+    return STATUS_OK;
+}
+
+/** Set channel squelch level in dBFS. */
+receiver::status receiver::set_vfo_sql_level(int vfo, double level_db)
+{
+    if (!vfo_is_valid(vfo))
+        return STATUS_ERROR;
+
+    if (d_vfos[vfo].channel->demodulator()->has_sql())
+        d_vfos[vfo].channel->demodulator()->set_sql_level(level_db);
+
+    return STATUS_OK;
+}
+
+/** Set channel audio gain in dB. */
+receiver::status receiver::set_vfo_af_gain(int vfo, float gain_db)
+{
+    if (!vfo_is_valid(vfo))
+        return STATUS_ERROR;
+
+    d_vfos[vfo].channel->set_af_gain(pow(10.0, gain_db / 20.0));
+
+    return STATUS_OK;
+}
+
+/** Get channel signal power. */
+float receiver::get_vfo_signal_pwr(int vfo, bool dbfs) const
+{
+    if (!vfo_is_valid(vfo))
+        return -200.0;
+
+    return d_vfos[vfo].channel->demodulator()->get_signal_level(dbfs);
+}
+
+/** Start UDP streaming of channel audio. */
+receiver::status receiver::start_vfo_udp_streaming(int vfo,
+                                                   const std::string host,
+                                                   int port)
+{
+    if (!vfo_is_valid(vfo))
+        return STATUS_ERROR;
+
+    d_vfos[vfo].channel->start_udp_streaming(host, port);
+
+    return STATUS_OK;
+}
+
+/** Stop UDP streaming of channel audio. */
+receiver::status receiver::stop_vfo_udp_streaming(int vfo)
+{
+    if (!vfo_is_valid(vfo))
+        return STATUS_ERROR;
+
+    d_vfos[vfo].channel->stop_udp_streaming();
+
+    return STATUS_OK;
+}
+
+/** Start WAV recording of channel audio. */
+receiver::status receiver::start_vfo_audio_recording(int vfo,
+                                                     const std::string filename)
+{
+    bool    ok;
+
+    if (!vfo_is_valid(vfo))
+        return STATUS_ERROR;
+
+    tb->lock();
+    ok = d_vfos[vfo].channel->start_audio_recording(filename);
+    tb_unlock();
+
+    if (ok)
+        std::cout << "Recording VFO " << vfo << " audio to " << filename
+                  << std::endl;
+
+    return ok ? STATUS_OK : STATUS_ERROR;
+}
+
+/** Stop WAV recording of channel audio. */
+receiver::status receiver::stop_vfo_audio_recording(int vfo)
+{
+    bool    ok;
+
+    if (!vfo_is_valid(vfo))
+        return STATUS_ERROR;
+
+    tb->lock();
+    ok = d_vfos[vfo].channel->stop_audio_recording();
+    tb_unlock();
+
+    return ok ? STATUS_OK : STATUS_ERROR;
+}
+
+/**
+ * @brief Enable or disable the channelizer.
+ * @param nchan The number of sub-bands or 0 to disable the channelizer.
+ *
+ * With many channels it is cheaper to split the quadrature stream into
+ * equally spaced sub-bands once, using a polyphase filter bank, and let each
+ * channel tune and resample only the sub-band it needs instead of the full
+ * rate stream. The sub-band spacing is quad_rate / nchan. Channels whose
+ * demodulator needs more bandwidth than a sub-band provides are still fed
+ * from the full rate stream.
+ *
+ * The number of sub-bands is rounded to an even number and clipped to
+ * RX_CHANNELIZER_MIN_CHAN..RX_CHANNELIZER_MAX_CHAN.
+ */
+receiver::status receiver::set_channelizer(unsigned int nchan)
+{
+    size_t  i;
+
+    if (nchan > 0)
+    {
+        nchan += nchan % 2;
+        nchan = std::max(nchan, (unsigned int)RX_CHANNELIZER_MIN_CHAN);
+        nchan = std::min(nchan, (unsigned int)RX_CHANNELIZER_MAX_CHAN);
+    }
+
+    if (nchan == get_channelizer())
+        return STATUS_OK;
+
+    tb->lock();
+
+    for (i = 0; i < d_vfos.size(); i++)
+        disconnect_vfo((int)i);
+
+    if (chanizer)
+    {
+        tb->disconnect(iq_frontend(), 0, chanizer, 0);
+        chanizer.reset();
+    }
+
+    if (nchan > 0)
+    {
+        chanizer = make_rx_channelizer(nchan, d_quad_rate);
+        apply_latency_profile();
+        apply_affinity();
+        tb->connect(iq_frontend(), 0, chanizer, 0);
+    }
+
+    for (i = 0; i < d_vfos.size(); i++)
+    {
+        d_vfos[i].subband = -1;
+        connect_vfo((int)i);
+        reroute_vfo((int)i);
+    }
+
+    tb_unlock();
+
+    return STATUS_OK;
+}
+
+/** Get the number of channelizer sub-bands, 0 if disabled. */
+unsigned int receiver::get_channelizer(void) const
+{
+    return chanizer ? chanizer->get_num_channels() : 0;
+}
+
+/**
+ * @brief Select latency profile.
+ * @param profile The new latency profile.
+ *
+ * The profile sets the output buffer sizes of the blocks in the I/Q front-end
+ * and in the channels, as well as the number of items the channel blocks
+ * process per call. Small buffers reduce the latency from the antenna to the
+ * audio output, large buffers reduce the risk of overflows at high sample
+ * rates and while recording.
+ *
+ * GNU Radio allocates the buffers when the flow graph is started, so a
+ * running receiver is restarted.
+ */
+receiver::status receiver::set_latency_profile(latency_profile profile)
+{
+    if (profile < LATENCY_LOW || profile > LATENCY_THROUGHPUT)
+        return STATUS_ERROR;
+
+    if (profile == d_latency)
+        return STATUS_OK;
+
+    d_latency = profile;
+
+    // tb->lock() seems to hang occasioanlly
+    if (d_running)
+    {
+        tb->stop();
+        tb->wait();
+    }
+
+    apply_latency_profile();
+
+    if (d_running)
+        tb_start();
+
+    return STATUS_OK;
+}
+
+/**
+ * @brief Get the measured latency from the I/Q front-end to the audio output.
+ * @return The latency in seconds or -1 if the receiver is not running.
+ *
+ * The latency is the stream time of the I/Q samples that have entered the
+ * receiver chain minus the stream time of the audio that has been consumed
+ * by the audio output, i.e. the signal held in the buffers between the two.
+ * Buffering in the input device driver and in the sound card is not
+ * included.
+ */
+double receiver::get_latency(void)
+{
+    return measure_latency(false);
+}
+
+/**
+ * @brief Measure the latency (see get_latency()).
+ * @param rebase Use the current value as reference for following
+ *               measurements. This must be done before the quadrature rate
+ *               or the audio output are changed.
+ */
+double receiver::measure_latency(bool rebase)
+{
+    gr::block_sptr  snk = boost::dynamic_pointer_cast<gr::block>(audio_snk);
+    uint64_t        iq_items;
+    uint64_t        audio_items;
+    double          latency;
+
+    if (!d_running || d_demod == RX_DEMOD_OFF || !snk || !snk->detail() ||
+        !nb_valve->detail())
+        return -1.0;
+
+    // the item counters start from zero when the flow graph is started
+    if (nb_valve->detail() != d_lat_detail)
+    {
+        d_lat_detail = nb_valve->detail();
+        d_lat_ref = 0.0;
+        d_lat_iq_items = 0;
+        d_lat_audio_items = 0;
+    }
+
+    iq_items = nb_valve->nitems_read(0);
+    audio_items = snk->nitems_read(0);
+    latency = d_lat_ref +
+              (double)(iq_items - d_lat_iq_items) / d_quad_rate -
+              (double)(audio_items - d_lat_audio_items) / d_audio_rate;
+
+    if (rebase)
+    {
+        d_lat_ref = latency;
+        d_lat_iq_items = iq_items;
+        d_lat_audio_items = audio_items;
+    }
+
+    return latency;
+}
+
+/* Set the buffer configuration of the blocks in a list. 0 means default. */
+static void set_block_buffers(const block_perf_list &blocks, int min_items,
+                              int max_items, int max_noutput_items)
+{
+    unsigned int i;
+
+    for (i = 0; i < blocks.size(); i++)
+    {
+        gr::block_sptr  blk = blocks[i].block;
+        int             multiple = blk->output_multiple();
+
+        // GNU Radio ignores the minimum if a maximum is set; the maximum
+        // must leave room for the output multiple of the block
+        blk->set_min_output_buffer(min_items);
+        blk->set_max_output_buffer(max_items > 0 ?
+                                   std::max(max_items, 4 * multiple) : 0);
+        if (max_noutput_items > 0)
+            blk->set_max_noutput_items(std::max(max_noutput_items, multiple));
+        else
+            blk->unset_max_noutput_items();
+    }
+}
+
+/**
+ * @brief Apply the current latency profile to all blocks.
+ *
+ * Must be called whenever blocks are created. The settings of blocks that
+ * are already running take effect the next time the flow graph is started.
+ * The buffers in the front-end are never limited, because the decimating
+ * filters following them need large buffers at high sample rates.
+ */
+void receiver::apply_latency_profile(void)
+{
+    block_perf_list blocks;
+
+    // propagated by GNU Radio to the output block of the device
+    src->set_min_output_buffer(latency_cfg[d_latency].source_buffer);
+
+    list_frontend_blocks(blocks, true);
+    set_block_buffers(blocks, latency_cfg[d_latency].frontend_buffer, 0, 0);
+
+    blocks.clear();
+    list_channel_blocks(blocks, true);
+    set_block_buffers(blocks, latency_cfg[d_latency].channel_buffer,
+                      latency_cfg[d_latency].channel_max_buffer,
+                      latency_cfg[d_latency].channel_max_items);
+}
+
+/**
+ * @brief List the blocks of the I/Q front-end.
+ * @param blocks The list to append to.
+ * @param all Also list blocks that are currently not connected.
+ *
+ * These are the blocks running at the quadrature rate, up to and including
+ * the channelizer.
+ */
+void receiver::list_frontend_blocks(block_perf_list &blocks, bool all) const
+{
+    if (d_decim >= 2)
+        input_decim->get_perf_stats(blocks, "input_decim");
+    iq_swap->get_perf_stats(blocks, "iq_swap");
+    if (all || d_dc_cancel)
+        dc_corr->get_perf_stats(blocks, "dc_corr");
+    block_perf_add(blocks, "iq_fft", iq_fft);
+    if (zoom_fft && (all || d_zoom_span > 0.0))
+    {
+        zoom_ddc->get_perf_stats(blocks, "zoom_ddc");
+        block_perf_add(blocks, "zoom_fft", zoom_fft);
+    }
+    if (iq_sink && (all || d_recording_iq))
+        block_perf_add(blocks, "iq_sink", iq_sink);
+    if (nb_rx)
+        block_perf_add(blocks, "nb_valve", nb_valve);
+    if (wfm_rx)
+        block_perf_add(blocks, "wfm_valve", wfm_valve);
+    if (chanizer)
+        chanizer->get_perf_stats(blocks, "chanizer");
+}
+
+/**
+ * @brief List the blocks of the channels.
+ * @param blocks The list to append to.
+ * @param all Also list blocks that are currently not connected.
+ *
+ * These are the blocks from the channel filters to the audio outputs,
+ * including the additional channels.
+ */
+void receiver::list_channel_blocks(block_perf_list &blocks, bool all) const
+{
+    unsigned int i;
+
+    if (nb_rx)
+    {
+        nb_ddc->get_perf_stats(blocks, "nb_ddc");
+        nb_rx->get_perf_stats(blocks, "nbrx");
+    }
+    if (wfm_rx)
+    {
+        wfm_ddc->get_perf_stats(blocks, "wfm_ddc");
+        wfm_rx->get_perf_stats(blocks, "wfmrx");
+    }
+    block_perf_add(blocks, "rx_sel", rx_sel);
+
+    block_perf_add(blocks, "audio_fft", audio_fft);
+    block_perf_add(blocks, "audio_gain0", audio_gain0);
+    block_perf_add(blocks, "audio_gain1", audio_gain1);
+    block_perf_add(blocks, "audio_snk", audio_snk);
+    if (wav_sink && (all || d_recording_wav))
+        block_perf_add(blocks, "wav_sink", wav_sink);
+    if (sniffer_rr && (all || d_sniffer_active))
+        sniffer_rr->get_perf_stats(blocks, "sniffer_rr");
+    if (sniffer && (all || d_sniffer_active))
+        block_perf_add(blocks, "sniffer", sniffer);
+
+    for (i = 0; i < d_vfos.size(); i++)
+    {
+        std::ostringstream prefix;
+
+        prefix << "vfo" << i;
+        d_vfos[i].channel->get_perf_stats(blocks, prefix.str());
+    }
+}
+
+/**
+ * @brief Enable or disable the GNU Radio performance counters.
+ * @param enable Whether to enable the counters.
+ *
+ * The counters add some overhead to the work loop of every block and are
+ * only enabled on request. GNU Radio reads the setting when the block
+ * threads start, so a running flow graph is restarted.
+ */
+void receiver::set_perf_counters(bool enable)
+{
+    gr::prefs::singleton()->set_bool("PerfCounters", "on", enable);
+
+    if (d_running)
+    {
+        tb->stop();
+        tb->wait();
+        tb_start();
+    }
+}
+
+/**
+ * @brief Get the performance counters of the blocks in the flow graph.
+ * @param stats The list to fill in.
+ *
+ * The blocks are listed in signal flow order using the names of the members
+ * holding them, e.g. "nbrx/filter/bpf". Blocks inside the input device and
+ * other library hier blocks are not visible. The throughput is calculated
+ * from the number of items processed since the previous call.
+ */
+void receiver::get_perf_stats(block_perf_list &stats)
+{
+    gr::high_res_timer_type now = gr::high_res_timer_now();
+    double          dt = (double)(now - d_perf_time) / gr::high_res_timer_tps();
+    unsigned int    i;
+
+    stats.clear();
+    list_frontend_blocks(stats, false);
+    list_channel_blocks(stats, false);
+
+    for (i = 0; i < stats.size(); i++)
+    {
+        std::map<std::string, uint64_t>::iterator prev;
+
+        prev = d_perf_nitems.find(stats[i].name);
+        if (prev != d_perf_nitems.end() && stats[i].nitems >= prev->second &&
+            d_perf_time > 0 && dt > 0.0)
+            stats[i].throughput = (double)(stats[i].nitems - prev->second) / dt;
+    }
+
+    d_perf_nitems.clear();
+    for (i = 0; i < stats.size(); i++)
+        d_perf_nitems[stats[i].name] = stats[i].nitems;
+    d_perf_time = now;
+}
+
+/**
+ * @brief Get the performance counters as a text table.
+ *
+ * The table (see get_perf_stats()) is preceded by the latency profile and
+ * the measured latency (see get_latency()).
+ */
+std::string receiver::get_perf_report(void)
+{
+    block_perf_list stats;
+    char            line[128];
+    double          latency = get_latency();
+
+    get_perf_stats(stats);
+
+    if (latency < 0.0)
+        snprintf(line, sizeof(line), "# latency profile: %s, latency: N/A\n",
+                 latency_cfg[d_latency].name);
+    else
+        snprintf(line, sizeof(line), "# latency profile: %s, latency: %.1f ms\n",
+                 latency_cfg[d_latency].name, 1.0e3 * latency);
+
+    return line + block_perf_format(stats);
+}
+
+/* Format a list of CPU cores, e.g. "0,1". */
+static std::string format_cores(const std::vector<int> &cores)
+{
+    std::ostringstream  str;
+    unsigned int        i;
+
+    if (cores.empty())
+        return "any";
+
+    for (i = 0; i < cores.size(); i++)
+        str << (i ? "," : "") << cores[i];
+
+    return str.str();
+}
+
+/* Pin a block to a set of cores; hier blocks pin all their internal blocks. */
+static void set_block_affinity(gr::basic_block_sptr block,
+                               const std::vector<int> &cores)
+{
+    if (!cores.empty())
+        block->set_processor_affinity(cores);
+    else if (!block->processor_affinity().empty())
+        block->unset_processor_affinity();
+}
+
+/**
+ * @brief Set the CPU cores used by the I/Q front-end.
+ * @param cores The cores; an empty list allows any core.
+ *
+ * The front-end consists of the input device, the input decimator, the I/Q
+ * corrections and the FFT. These blocks run at the full input rate and are
+ * the heaviest in the flow graph. Pinning them to cores that are not used by
+ * the channels keeps them from competing with the demodulators.
+ */
+void receiver::set_frontend_affinity(const std::vector<int> &cores)
+{
+    d_frontend_cores = cores;
+    apply_affinity();
+}
+
+/**
+ * @brief Set the CPU cores used by the channels.
+ * @param cores The cores; an empty list allows any core.
+ *
+ * This covers the channel filters and demodulators of the main receiver,
+ * the channelizer and the additional channels (VFOs).
+ */
+void receiver::set_channel_affinity(const std::vector<int> &cores)
+{
+    d_channel_cores = cores;
+    apply_affinity();
+}
+
+/**
+ * @brief Apply the CPU affinity to all blocks.
+ *
+ * Must be called whenever blocks are created. GNU Radio applies the affinity
+ * to running threads immediately and to new threads when they are started.
+ */
+void receiver::apply_affinity(void)
+{
+    unsigned int i;
+
+    set_block_affinity(src, d_frontend_cores);
+    if (d_decim >= 2)
+        set_block_affinity(input_decim, d_frontend_cores);
+    set_block_affinity(iq_swap, d_frontend_cores);
+    set_block_affinity(dc_corr, d_frontend_cores);
+    set_block_affinity(iq_fft, d_frontend_cores);
+    if (zoom_fft)
+    {
+        set_block_affinity(zoom_ddc, d_frontend_cores);
+        set_block_affinity(zoom_fft, d_frontend_cores);
+    }
+
+    if (nb_rx)
+    {
+        set_block_affinity(nb_ddc, d_channel_cores);
+        set_block_affinity(nb_rx, d_channel_cores);
+    }
+    if (wfm_rx)
+    {
+        set_block_affinity(wfm_ddc, d_channel_cores);
+        set_block_affinity(wfm_rx, d_channel_cores);
+    }
+    if (chanizer)
+        set_block_affinity(chanizer, d_channel_cores);
+    for (i = 0; i < d_vfos.size(); i++)
+        set_block_affinity(d_vfos[i].channel, d_channel_cores);
+}
+
+/**
+ * @brief Set the real-time priority of the audio path.
+ * @param priority The SCHED_FIFO priority (1...99) or 0 for normal priority.
+ *
+ * The threads of the audio gain blocks and the audio output are given
+ * real-time priority, so that a busy GUI or DSP thread does not cause audio
+ * underruns. This requires permission to use real-time scheduling, e.g.
+ * an rtprio limit in /etc/security/limits.conf; if it is not permitted the
+ * threads keep their normal priority (see get_thread_report()).
+ */
+void receiver::set_audio_priority(int priority)
+{
+#ifndef _WIN32
+    priority = std::min(priority, sched_get_priority_max(SCHED_FIFO));
+#endif
+    d_audio_priority = std::max(priority, 0);
+    if (d_running)
+        apply_audio_priority();
+}
+
+/**
+ * @brief Apply the audio priority to the running audio threads.
+ *
+ * GNU Radio only changes the priority within the current scheduling policy
+ * of a thread, which does not allow real-time priorities for normal threads,
+ * so the policy is set here. The threads of all blocks are running when
+ * tb->start() and tb->unlock() return; this must not be called while the
+ * flow graph is stopped.
+ */
+void receiver::apply_audio_priority(void)
+{
+#ifndef _WIN32
+    gr::block_sptr      blocks[3];
+    struct sched_param  param;
+    int                 policy;
+    int                 prio = d_audio_priority;
+    unsigned int        i;
+
+    // the audio path is not connected
+    if (d_demod == RX_DEMOD_OFF)
+        return;
+
+    blocks[0] = audio_gain0;
+    blocks[1] = audio_gain1;
+    blocks[2] = boost::dynamic_pointer_cast<gr::block>(audio_snk);
+
+    policy = (d_audio_priority > 0) ? SCHED_FIFO : SCHED_OTHER;
+    param.sched_priority = d_audio_priority;
+
+    for (i = 0; i < 3; i++)
+    {
+        if (!blocks[i] || !blocks[i]->detail() || !blocks[i]->detail()->threaded)
+            continue;
+
+        if (pthread_setschedparam(blocks[i]->detail()->thread, policy, &param) != 0)
+            prio = -1;
+    }
+
+    if (prio < 0 && d_audio_prio_active >= 0)
+        std::cout << "Could not set real-time priority " << d_audio_priority
+                  << " for the audio threads (check the rtprio limit)."
+                  << std::endl;
+    d_audio_prio_active = prio;
+#endif
+}
+
+/**
+ * @brief Get the thread layout of the flow graph as a text table.
+ *
+ * GNU Radio runs every block in its own thread. The table lists the blocks
+ * with the CPU cores they may run on and their real-time priority
+ * (0 for normal, -1 if setting the requested priority failed).
+ */
+std::string receiver::get_thread_report(void)
+{
+    block_perf_list blocks;
+    std::ostringstream  report;
+    char            line[128];
+    unsigned int    i;
+
+    list_frontend_blocks(blocks, false);
+    list_channel_blocks(blocks, false);
+
+    report << "# " << blocks.size() << " block threads"
+#ifndef _MSC_VER
+           << " on " << sysconf(_SC_NPROCESSORS_ONLN) << " cores"
+#endif
+           << ", front-end cores: " << format_cores(d_frontend_cores)
+           << ", channel cores: " << format_cores(d_channel_cores)
+           << ", audio priority: " << d_audio_priority << "\n";
+
+    snprintf(line, sizeof(line), "%-32s %-16s %8s\n", "# block", "cores",
+             "priority");
+    report << line;
+
+    // the blocks inside the input device are not visible
+    snprintf(line, sizeof(line), "%-32s %-16s %8d\n", "src",
+             format_cores(d_frontend_cores).c_str(), 0);
+    report << line;
+
+    for (i = 0; i < blocks.size(); i++)
+    {
+        gr::block_sptr  blk = blocks[i].block;
+        int             prio = 0;
+
+        if (blk == audio_gain0 || blk == audio_gain1 ||
+            blk == boost::dynamic_pointer_cast<gr::block>(audio_snk))
+            prio = d_audio_prio_active;
+
+        snprintf(line, sizeof(line), "%-32s %-16s %8d\n",
+                 blocks[i].name.c_str(),
+                 format_cores(blk->processor_affinity()).c_str(), prio);
+        report << line;
+    }
+
+    return report.str();
+}
+
+bool receiver::vfo_is_valid(int vfo) const
+{
+    return (vfo >= 0 && vfo < (int)d_vfos.size());
+}
+
+/**
+ * @brief Find the channelizer sub-band for a channel.
+ * @param demod_rx The demodulator chain of the channel.
+ * @param offset_hz The channel offset from the RF center frequency.
+ * @param[out] residual_hz The offset to tune within the returned input.
+ * @return The channelizer output or -1 if the channel must use the full rate
+ *         I/Q stream.
+ *
+ * The sub-band spacing must be at least the preferred quadrature rate of the
+ * demodulator chain, which leaves room for +/- rate/4 around the channel
+ * anywhere in the sub-band.
+ */
+int receiver::vfo_subband(receiver_base_cf_sptr demod_rx, double offset_hz,
+                          double *residual_hz) const
+{
+    *residual_hz = offset_hz;
+
+    if (!chanizer)
+        return -1;
+
+    if (chanizer->get_channel_spacing() < demod_rx->get_pref_quad_rate())
+        return -1;
+
+    return chanizer->channel_for_offset(offset_hz, residual_hz);
+}
+
+/** Get the sample rate of a channel input. */
+double receiver::vfo_input_rate(int subband) const
+{
+    if (subband < 0 || !chanizer)
+        return d_quad_rate;
+    else
+        return chanizer->get_channel_rate();
+}
+
+void receiver::connect_vfo(int vfo)
+{
+    if (d_vfos[vfo].subband < 0)
+        tb->connect(iq_frontend(), 0, d_vfos[vfo].channel, 0);
+    else
+        tb->connect(chanizer, d_vfos[vfo].subband, d_vfos[vfo].channel, 0);
+}
+
+void receiver::disconnect_vfo(int vfo)
+{
+    if (d_vfos[vfo].subband < 0)
+        tb->disconnect(iq_frontend(), 0, d_vfos[vfo].channel, 0);
+    else
+        tb->disconnect(chanizer, d_vfos[vfo].subband, d_vfos[vfo].channel, 0);
+}
+
+/**
+ * @brief Update the input of a channel.
+ *
+ * Moves the channel to the sub-band matching its current offset and
+ * demodulator and updates its input rate and fine tuning. The caller must
+ * hold the top block lock.
+ */
+void receiver::reroute_vfo(int vfo)
+{
+    double  residual;
+    int     subband;
+
+    subband = vfo_subband(d_vfos[vfo].channel->demodulator(), d_vfos[vfo].offset,
+                          &residual);
+    if (subband != d_vfos[vfo].subband)
+    {
+        disconnect_vfo(vfo);
+        d_vfos[vfo].subband = subband;
+        connect_vfo(vfo);
+    }
+
+    d_vfos[vfo].channel->set_quad_rate(vfo_input_rate(subband));
+    d_vfos[vfo].channel->set_offset(residual);
+}
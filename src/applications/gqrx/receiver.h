@@ -23,18 +23,22 @@
 #ifndef RECEIVER_H
 #define RECEIVER_H
 
-#include <gnuradio/analog/sig_source_c.h>
+#include <gnuradio/blocks/copy.h>
 #include <gnuradio/blocks/file_sink.h>
 #include <gnuradio/blocks/multiply_const_ff.h>
-#include <gnuradio/blocks/multiply_cc.h>
 #include <gnuradio/blocks/null_sink.h>
 #include <gnuradio/blocks/wavfile_sink.h>
 #include <gnuradio/blocks/wavfile_source.h>
+#include <gnuradio/high_res_timer.h>
 #include <gnuradio/top_block.h>
 #include <osmosdr/source.h>
+#include <map>
 #include <string>
+#include <vector>
 
+#include "dsp/block_perf.h"
 #include "dsp/correct_iq_cc.h"
+#include "dsp/rx_channelizer.h"
 #include "dsp/filter/fir_decim.h"
 #include "dsp/rx_noise_blanker_cc.h"
 #include "dsp/rx_filter.h"
@@ -44,9 +48,11 @@
 #include "dsp/rx_demod_am.h"
 #include "dsp/rx_fft.h"
 #include "dsp/sniffer_f.h"
+#include "dsp/stream_selector.h"
 #include "dsp/resampler_xx.h"
 #include "interfaces/udp_sink_f.h"
 #include "receivers/receiver_base.h"
+#include "receivers/rx_channel.h"
 
 #ifdef WITH_PULSEAUDIO
 #include "pulseaudio/pa_sink.h"
@@ -56,6 +62,15 @@
 #include <gnuradio/audio/sink.h>
 #endif
 
+/** Audio output device that discards the audio without any clock. */
+#define RX_AUDIO_DEVICE_NULL    "null"
+
+/** Prefix of audio output devices writing to a WAV file, e.g. "file=out.wav". */
+#define RX_AUDIO_DEVICE_FILE    "file="
+
+/** The zoom spectrum is used for spans below quadrature rate / RX_ZOOM_MIN_DECIM. */
+#define RX_ZOOM_MIN_DECIM       4
+
 /**
  * @defgroup DSP Digital signal processing library based on GNU Radio
  */
@@ -105,6 +120,13 @@ public:
         FILTER_SHAPE_SHARP = 2   /*!< Sharp: Transition band is TBD of width. */
     };
 
+    /** Latency profiles (flow graph buffer sizes). */
+    enum latency_profile {
+        LATENCY_LOW        = 0,  /*!< Small buffers, lowest audio latency. */
+        LATENCY_BALANCED   = 1,  /*!< Moderate buffers (default). */
+        LATENCY_THROUGHPUT = 2   /*!< Large buffers for high sample rates and recording. */
+    };
+
     receiver(const std::string input_device="",
              const std::string audio_device="",
              unsigned int decimation=1);
@@ -112,6 +134,7 @@ public:
 
     void        start();
     void        stop();
+    void        wait();
     void        set_input_device(const std::string device);
     void        set_output_device(const std::string device);
 
@@ -155,10 +178,24 @@ public:
     status      set_freq_corr(double ppm);
     float       get_signal_pwr(bool dbfs) const;
     void        set_iq_fft_size(int newsize);
-    void        get_iq_fft_data(std::complex<float>* fftPoints,
-                                unsigned int &fftsize);
-    void        get_audio_fft_data(std::complex<float>* fftPoints,
-                                   unsigned int &fftsize);
+    void        set_iq_fft_threads(int nthreads);
+    void        set_iq_fft_rate(float fps);
+    void        set_iq_fft_avg(float avg);
+    void        set_iq_fft_window(int wintype);
+    void        set_iq_fft_welch(float overlap, float budget);
+    void        get_iq_spectrum(float *pwr, float *avg, unsigned int &fftsize);
+    int         add_iq_spectrum_consumer(unsigned int fftsize, int wintype,
+                                         float avg, float fps);
+    void        remove_iq_spectrum_consumer(int id);
+    bool        get_iq_consumer_spectrum(int id, float *pwr, float *avg,
+                                         unsigned int &fftsize);
+    status      set_iq_fft_zoom(double offset_hz, double span_hz);
+    bool        get_zoom_spectrum(float *pwr, float *avg, unsigned int &fftsize,
+                                  double &offset_hz, double &rate);
+    void        set_audio_fft_rate(float fps);
+    void        get_audio_spectrum(float *pwr, unsigned int &fftsize);
+    std::string get_spectrum_report(unsigned int bins, unsigned int fftsize=0);
+    void        release_spectrum_report(void);
 
     /* Noise blanker */
     status      set_nb_on(int nbid, bool on);
@@ -215,8 +252,70 @@ public:
     bool        is_rds_decoder_active(void) const;
     void        reset_rds_parser(void);
 
+    /* Additional channels (VFOs) sharing the I/Q front-end */
+    int         add_vfo(double offset_hz, rx_demod demod);
+    status      remove_vfo(int vfo);
+    int         get_vfo_count(void) const { return (int)d_vfos.size(); }
+    status      set_vfo_offset(int vfo, double offset_hz);
+    double      get_vfo_offset(int vfo) const;
+    status      set_vfo_demod(int vfo, rx_demod demod);
+    rx_demod    get_vfo_demod(int vfo) const;
+    status      set_vfo_filter(int vfo, double low, double high,
+                               filter_shape shape);
+    status      set_vfo_cw_offset(int vfo, double offset_hz);
+    status      set_vfo_sql_level(int vfo, double level_db);
+    status      set_vfo_af_gain(int vfo, float gain_db);
+    float       get_vfo_signal_pwr(int vfo, bool dbfs) const;
+    status      start_vfo_udp_streaming(int vfo, const std::string host,
+                                        int port);
+    status      stop_vfo_udp_streaming(int vfo);
+    status      start_vfo_audio_recording(int vfo, const std::string filename);
+    status      stop_vfo_audio_recording(int vfo);
+
+    status      set_channelizer(unsigned int nchan);
+    unsigned int get_channelizer(void) const;
+
+    /* Latency */
+    status      set_latency_profile(latency_profile profile);
+    latency_profile get_latency_profile(void) const { return d_latency; }
+    double      get_latency(void);
+
+    /* Thread scheduling */
+    void        set_frontend_affinity(const std::vector<int> &cores);
+    void        set_channel_affinity(const std::vector<int> &cores);
+    void        set_audio_priority(int priority);
+    std::string get_thread_report(void);
+
+    /* Performance monitoring */
+    void        set_perf_counters(bool enable);
+    void        get_perf_stats(block_perf_list &stats);
+    std::string get_perf_report(void);
+
 private:
     void        connect_all(rx_chain type);
+    void        list_frontend_blocks(block_perf_list &blocks, bool all) const;
+    void        list_channel_blocks(block_perf_list &blocks, bool all) const;
+    void        apply_latency_profile(void);
+    double      measure_latency(bool rebase);
+    void        apply_affinity(void);
+    void        apply_audio_priority(void);
+    void        tb_start(void);
+    void        tb_unlock(void);
+    gr::basic_block_sptr    make_audio_sink(const std::string device);
+    void        update_ddc(void);
+    void        update_zoom(void);
+    unsigned int    zoom_fft_size(void) const;
+    double      zoom_min_rate(void) const;
+    bool        create_chain(rx_chain type);
+    void        select_chain(rx_chain type, int chain_demod);
+    gr::basic_block_sptr    iq_frontend(void) const;
+    bool        vfo_is_valid(int vfo) const;
+    int         vfo_subband(receiver_base_cf_sptr demod_rx, double offset_hz,
+                            double *residual_hz) const;
+    double      vfo_input_rate(int subband) const;
+    void        connect_vfo(int vfo);
+    void        disconnect_vfo(int vfo);
+    void        reroute_vfo(int vfo);
 
 private:
     bool        d_running;          /*!< Whether receiver is running or not. */
@@ -234,47 +333,82 @@ private:
     bool        d_dc_cancel;        /*!< Enable automatic DC removal. */
     bool        d_iq_balance;       /*!< Enable automatic IQ balance. */
 
+    int         d_iq_fft_size;      /*!< Requested baseband FFT size. */
+    float       d_iq_fft_rate;      /*!< Baseband spectrum frame rate. */
+    float       d_iq_fft_avg;       /*!< Baseband spectrum averaging. */
+    int         d_iq_fft_window;    /*!< Baseband spectrum window type. */
+    double      d_zoom_offset;      /*!< Center of the zoom spectrum. */
+    double      d_zoom_span;        /*!< Span of the zoom spectrum, 0 if off. */
+    int         d_report_consumer;  /*!< Spectrum consumer of get_spectrum_report(), -1 if none. */
+    unsigned int d_report_fftsize;  /*!< FFT size of d_report_consumer. */
+
     std::string input_devstr;  /*!< Current input device string. */
     std::string output_devstr; /*!< Current output device string. */
 
     rx_demod    d_demod;       /*!< Current demodulator. */
 
+    latency_profile d_latency;          /*!< Current latency profile. */
+    gr::block_detail_sptr d_lat_detail; /*!< Detail of nb_valve when the latency reference was taken. */
+    double      d_lat_ref;          /*!< Latency at the reference point. */
+    uint64_t    d_lat_iq_items;     /*!< I/Q items at the reference point. */
+    uint64_t    d_lat_audio_items;  /*!< Audio items at the reference point. */
+
+    std::vector<int> d_frontend_cores;  /*!< CPU cores for the I/Q front-end, empty for any. */
+    std::vector<int> d_channel_cores;   /*!< CPU cores for the channels, empty for any. */
+    int         d_audio_priority;   /*!< Requested real-time priority of the audio path. */
+    int         d_audio_prio_active;    /*!< Priority in effect, -1 if it could not be set. */
+
+    std::map<std::string, uint64_t> d_perf_nitems; /*!< Item counts at the previous update. */
+    gr::high_res_timer_type         d_perf_time;   /*!< Time of the previous update. */
+
     gr::top_block_sptr         tb;        /*!< The GNU Radio top block. */
 
     osmosdr::source::sptr     src;       /*!< Real time I/Q source. */
     fir_decim_cc_sptr         input_decim;      /*!< Input decimator. */
-    receiver_base_cf_sptr     rx;        /*!< receiver. */
+    receiver_base_cf_sptr     rx;        /*!< Active receiver chain. */
+    receiver_base_cf_sptr     nb_rx;     /*!< Narrow band receiver chain (created on first use). */
+    receiver_base_cf_sptr     wfm_rx;    /*!< Broadcast FM receiver chain (created on first use). */
 
     dc_corr_cc_sptr           dc_corr;   /*!< DC corrector block. */
     iq_swap_cc_sptr           iq_swap;   /*!< I/Q swapping block. */
 
     rx_fft_c_sptr             iq_fft;     /*!< Baseband FFT block. */
     rx_fft_f_sptr             audio_fft;  /*!< Audio FFT block. */
+    rx_xlating_filter_sptr    zoom_ddc;   /*!< Tuning and decimation for zoom_fft (created on first use). */
+    rx_fft_c_sptr             zoom_fft;   /*!< Zoom spectrum FFT block (created on first use). */
 
-    gr::analog::sig_source_c::sptr      lo;  /*!< oscillator used for tuning. */
-    gr::blocks::multiply_cc::sptr       mixer;
+    rx_xlating_filter_sptr    nb_ddc;     /*!< Tuning and decimation for nb_rx. */
+    rx_xlating_filter_sptr    wfm_ddc;    /*!< Tuning and decimation for wfm_rx. */
+    gr::blocks::copy::sptr    nb_valve;   /*!< Stops nb_rx when not in use. */
+    gr::blocks::copy::sptr    wfm_valve;  /*!< Stops wfm_rx when not in use. */
+    stream_selector_sptr      rx_sel;     /*!< Selects the output of the active chain. */
 
     gr::blocks::multiply_const_ff::sptr audio_gain0; /*!< Audio gain block. */
     gr::blocks::multiply_const_ff::sptr audio_gain1; /*!< Audio gain block. */
 
-    gr::blocks::file_sink::sptr         iq_sink;     /*!< I/Q file sink. */
+    gr::blocks::file_sink::sptr         iq_sink;     /*!< I/Q file sink (created on first use). */
 
-    gr::blocks::wavfile_sink::sptr      wav_sink;   /*!< WAV file sink for recording. */
+    gr::blocks::wavfile_sink::sptr      wav_sink;   /*!< WAV file sink for recording (created on first use). */
     gr::blocks::wavfile_source::sptr    wav_src;    /*!< WAV file source for playback. */
     gr::blocks::null_sink::sptr         audio_null_sink0; /*!< Audio null sink used during playback. */
     gr::blocks::null_sink::sptr         audio_null_sink1; /*!< Audio null sink used during playback. */
 
-    udp_sink_f_sptr   audio_udp_sink;  /*!< UDP sink to stream audio over the network. */
-    sniffer_f_sptr    sniffer;    /*!< Sample sniffer for data decoders. */
+    udp_sink_f_sptr   audio_udp_sink;  /*!< UDP sink to stream audio over the network (created on first use). */
+    sniffer_f_sptr    sniffer;    /*!< Sample sniffer for data decoders (created on first use). */
     resampler_ff_sptr sniffer_rr; /*!< Sniffer resampler. */
 
-#ifdef WITH_PULSEAUDIO
-    pa_sink_sptr              audio_snk;  /*!< Pulse audio sink. */
-#elif WITH_PORTAUDIO
-    portaudio_sink_sptr       audio_snk;  /*!< portaudio sink */
-#else
-    gr::audio::sink::sptr     audio_snk;  /*!< gr audio sink */
-#endif
+    /*! \brief Bookkeeping for an additional channel. */
+    struct vfo_info {
+        rx_channel_sptr channel;    /*!< The channel. */
+        rx_demod        demod;      /*!< Current demodulator. */
+        double          offset;     /*!< Offset from the RF center frequency. */
+        int             subband;    /*!< Channelizer output or -1 for full rate. */
+    };
+
+    std::vector<vfo_info>   d_vfos;     /*!< Additional channels. */
+    rx_channelizer_sptr     chanizer;   /*!< Optional channelizer for the VFOs. */
+
+    gr::basic_block_sptr      audio_snk;  /*!< Audio output (sound card, WAV file or null sink). */
 
     //! Get a path to a file containing random bytes
     static std::string get_random_file(void);
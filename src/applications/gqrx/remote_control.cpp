@@ -48,6 +48,7 @@ RemoteControl::RemoteControl(QObject *parent) :
     rc_allowed_hosts.append(DEFAULT_RC_ALLOWED_HOSTS);
 
     rc_socket = 0;
+    rc_backend = 0;
 
     connect(&rc_server, SIGNAL(newConnection()), this, SLOT(acceptConnection()));
 
@@ -164,9 +165,22 @@ void RemoteControl::acceptConnection()
     else
     {
         connect(rc_socket, SIGNAL(readyRead()), this, SLOT(startRead()));
+        connect(rc_socket, SIGNAL(disconnected()), this, SLOT(clientDisconnected()));
     }
 }
 
+/*! \brief Tell the backend that the client disconnected.
+ *
+ * This slot is called when the client TCP socket emits a disconnected()
+ * signal, e.g. so the backend can release the FFT used by its spectrum
+ * reports.
+ */
+void RemoteControl::clientDisconnected()
+{
+    if (rc_backend)
+        rc_backend->clientDisconnected();
+}
+
 /*! \brief Start reading from the socket.
  *
  * This slot is called when the client TCP socket emits a readyRead() signal,
@@ -210,6 +224,20 @@ void RemoteControl::startRead()
         answer = cmd_LOS();
     else if (cmd == "\\dump_state")
         answer = cmd_dump_state();
+    else if (cmd == "\\perf_stats")
+        answer = cmd_perf_stats();
+    else if (cmd == "\\thread_layout")
+        answer = cmd_thread_layout();
+    else if (cmd == "\\spectrum")
+        answer = cmd_spectrum(cmdlist);
+    else if (cmd == "\\vfo_add")
+        answer = cmd_vfo_add(cmdlist);
+    else if (cmd == "\\vfo_del")
+        answer = cmd_vfo_del(cmdlist);
+    else if (cmd == "\\vfo_set")
+        answer = cmd_vfo_set(cmdlist);
+    else if (cmd == "\\channelizer")
+        answer = cmd_channelizer(cmdlist);
     else if (cmd == "q" || cmd == "Q")
     {
         // FIXME: for now we assume 'close' command
@@ -324,8 +352,14 @@ void RemoteControl::setReceiverStatus(bool enabled)
     receiver_running = enabled;
 }
 
+/*! \brief Set the backend of the commands returning a result (from mainwindow). */
+void RemoteControl::setBackend(RemoteControlBackend *backend)
+{
+    rc_backend = backend;
+}
+
 
-/*! \brief Convert mode string to enum (DockRxOpt::rxopt_mode_idx)
+/*! \brief Convert mode string to enum (RxModes::mode_idx)
  *  \param mode The Hamlib rigctld compatible mode string
  *  \return An integer corresponding to the mode.
  *
@@ -397,7 +431,7 @@ int RemoteControl::modeStrToInt(QString mode_str)
 }
 
 /*! \brief Convert mode enum to string.
- *  \param mode The mode ID c.f. DockRxOpt::rxopt_mode_idx
+ *  \param mode The mode ID c.f. RxModes::mode_idx
  *  \returns The mode string.
  */
 QString RemoteControl::intToModeStr(int mode)
@@ -718,3 +752,200 @@ QString RemoteControl::cmd_dump_state()
         /* Bit field list of set parm */
         "0\n" /* RIG_PARM_NONE */);
 }
+
+/*
+ * '\perf_stats' returns the performance counters of the receiver blocks,
+ * one line per block, followed by RPRT 0.
+ */
+QString RemoteControl::cmd_perf_stats()
+{
+    QString report;
+
+    if (rc_backend)
+        report = rc_backend->getPerfStats();
+    if (report.isEmpty())
+        return QString("RPRT 1\n");
+
+    return report + QString("RPRT 0\n");
+}
+
+/*
+ * '\thread_layout' returns the CPU cores and real-time priority of the
+ * receiver threads, one line per block, followed by RPRT 0.
+ */
+QString RemoteControl::cmd_thread_layout()
+{
+    QString report;
+
+    if (rc_backend)
+        report = rc_backend->getThreadLayout();
+    if (report.isEmpty())
+        return QString("RPRT 1\n");
+
+    return report + QString("RPRT 0\n");
+}
+
+/*
+ * '\spectrum [bins] [fftsize]' returns the averaged baseband power spectrum
+ * reduced to the given number of bins (default 1024), followed by RPRT 0.
+ * Without fftsize the spectrum shown in the pandapter is used.
+ */
+QString RemoteControl::cmd_spectrum(QStringList cmdlist)
+{
+    QString report;
+    int     bins = 1024;
+    int     fftsize = 0;
+    bool    ok = true;
+
+    if (cmdlist.size() > 1)
+        bins = cmdlist[1].toInt(&ok);
+    if (ok && cmdlist.size() > 2)
+        fftsize = cmdlist[2].toInt(&ok);
+    if (!ok || bins < 1 || fftsize < 0 || !rc_backend)
+        return QString("RPRT 1\n");
+
+    report = rc_backend->getSpectrum(bins, fftsize);
+    if (report.isEmpty())
+        return QString("RPRT 1\n");
+
+    return report + QString("RPRT 0\n");
+}
+
+/*! \brief Convert the mode string of a VFO command to a mode index.
+ *  \return The mode index or -1 if the mode is invalid or OFF.
+ *
+ * Same as modeStrToInt() but without changing the CW reply format.
+ */
+int RemoteControl::vfoModeStrToInt(QString mode_str)
+{
+    bool    hamlib = hamlib_compatible;
+    int     mode = modeStrToInt(mode_str);
+
+    hamlib_compatible = hamlib;
+
+    return mode > 0 ? mode : -1;
+}
+
+/*
+ * '\vfo_add offset mode' adds a channel at offset Hz from the hardware
+ * frequency and returns its index. The audio of the channel is only
+ * available through UDP, see '\vfo_set'.
+ */
+QString RemoteControl::cmd_vfo_add(QStringList cmdlist)
+{
+    qint64  offset;
+    int     mode;
+    int     vfo;
+    bool    ok;
+
+    if (cmdlist.size() != 3 || !rc_backend)
+        return QString("RPRT 1\n");
+
+    offset = cmdlist[1].toLongLong(&ok);
+    mode = vfoModeStrToInt(cmdlist[2]);
+    if (!ok || mode < 0)
+        return QString("RPRT 1\n");
+
+    vfo = rc_backend->addVfo(offset, mode);
+    if (vfo < 0)
+        return QString("RPRT 1\n");
+
+    return QString("%1\n").arg(vfo);
+}
+
+/*
+ * '\vfo_del vfo' removes a channel. The indices of the following channels
+ * are decremented.
+ */
+QString RemoteControl::cmd_vfo_del(QStringList cmdlist)
+{
+    int     vfo = -1;
+    bool    ok = false;
+
+    if (cmdlist.size() == 2 && rc_backend)
+        vfo = cmdlist[1].toInt(&ok);
+    if (!ok)
+        return QString("RPRT 1\n");
+
+    ok = rc_backend->removeVfo(vfo);
+
+    return QString("RPRT %1\n").arg(ok ? 0 : 1);
+}
+
+/*
+ * '\vfo_set vfo param value' changes a channel setting:
+ *   offset <Hz>, mode <mode>, sql <dBFS>, gain <dB>, udp <host> <port>
+ *   or udp off.
+ */
+QString RemoteControl::cmd_vfo_set(QStringList cmdlist)
+{
+    QString param;
+    int     vfo = -1;
+    bool    ok = false;
+    bool    done = false;
+
+    if (cmdlist.size() >= 4 && rc_backend)
+        vfo = cmdlist[1].toInt(&ok);
+    if (!ok)
+        return QString("RPRT 1\n");
+
+    param = cmdlist[2];
+    if (param == "offset")
+    {
+        qint64 offset = cmdlist[3].toLongLong(&ok);
+        if (ok)
+            done = rc_backend->setVfoOffset(vfo, offset);
+    }
+    else if (param == "mode")
+    {
+        int mode = vfoModeStrToInt(cmdlist[3]);
+        if (mode >= 0)
+            done = rc_backend->setVfoMode(vfo, mode);
+    }
+    else if (param == "sql")
+    {
+        double level = cmdlist[3].toDouble(&ok);
+        if (ok)
+            done = rc_backend->setVfoSqlLevel(vfo, level);
+    }
+    else if (param == "gain")
+    {
+        double gain = cmdlist[3].toDouble(&ok);
+        if (ok)
+            done = rc_backend->setVfoGain(vfo, gain);
+    }
+    else if (param == "udp")
+    {
+        if (cmdlist.size() == 4 && cmdlist[3] == "off")
+        {
+            done = rc_backend->setVfoUdp(vfo, QString(), 0);
+        }
+        else if (cmdlist.size() == 5)
+        {
+            int port = cmdlist[4].toInt(&ok);
+            if (ok && port > 0 && port < 65536)
+                done = rc_backend->setVfoUdp(vfo, cmdlist[3], port);
+        }
+    }
+
+    return QString("RPRT %1\n").arg(done ? 0 : 1);
+}
+
+/*
+ * '\channelizer nchan' splits the baseband into nchan sub-bands for the
+ * VFOs; 0 disables the channelizer.
+ */
+QString RemoteControl::cmd_channelizer(QStringList cmdlist)
+{
+    int     nchan = -1;
+    bool    ok = false;
+
+    if (cmdlist.size() == 2 && rc_backend)
+        nchan = cmdlist[1].toInt(&ok);
+    if (!ok || nchan < 0)
+        return QString("RPRT 1\n");
+
+    ok = rc_backend->setChannelizer(nchan);
+
+    return QString("RPRT %1\n").arg(ok ? 0 : 1);
+}
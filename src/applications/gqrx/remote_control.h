@@ -31,6 +31,33 @@
 #include <QTcpSocket>
 #include <QtNetwork>
 
+/*! \brief Receiver functions used by the remote control commands.
+ *
+ * The commands that return a result call these directly while the command
+ * is handled, so the reply always carries the result of the command. The
+ * other commands only mirror the state set through the slots and signals of
+ * RemoteControl.
+ */
+class RemoteControlBackend
+{
+public:
+    virtual ~RemoteControlBackend() {}
+
+    virtual QString getPerfStats(void) = 0;
+    virtual QString getThreadLayout(void) = 0;
+    virtual QString getSpectrum(int bins, int fftsize) = 0;
+    virtual void    clientDisconnected(void) = 0;
+
+    virtual int     addVfo(qint64 offset, int mode) = 0;
+    virtual bool    removeVfo(int vfo) = 0;
+    virtual bool    setVfoOffset(int vfo, qint64 offset) = 0;
+    virtual bool    setVfoMode(int vfo, int mode) = 0;
+    virtual bool    setVfoSqlLevel(int vfo, double level_db) = 0;
+    virtual bool    setVfoGain(int vfo, double gain_db) = 0;
+    virtual bool    setVfoUdp(int vfo, const QString &host, int port) = 0;
+    virtual bool    setChannelizer(int nchan) = 0;
+};
+
 /*! \brief Simple TCP server for remote control.
  *
  * The TCP interface is compatible with the hamlib rigtctld so that applications
@@ -49,7 +76,14 @@
  * We also have some gqrx specific commands:
  *
  *  close: Close connection (useful for interactive telnet sessions).
+ *  \perf_stats: Performance counters of the receiver blocks.
+ *  \thread_layout: CPU cores and priorities of the receiver threads.
+ *  \spectrum: Baseband power spectrum.
+ *  \vfo_add, \vfo_del, \vfo_set: Additional channels (VFOs).
+ *  \channelizer: Polyphase channelizer feeding the VFOs.
  *
+ * These commands are handled by the RemoteControlBackend set with
+ * setBackend(); without a backend they fail.
  *
  * FIXME: The server code is very minimalistic and probably not very robust.
  */
@@ -78,6 +112,7 @@ public:
         return rc_allowed_hosts;
     }
     void setReceiverStatus(bool enabled);
+    void setBackend(RemoteControlBackend *backend);
 
 public slots:
     void setNewFrequency(qint64 freq);
@@ -102,10 +137,12 @@ signals:
 private slots:
     void acceptConnection();
     void startRead();
+    void clientDisconnected();
 
 private:
     QTcpServer  rc_server;         /*!< The active server object. */
     QTcpSocket* rc_socket;         /*!< The active socket object. */
+    RemoteControlBackend *rc_backend; /*!< Receiver used by the commands returning a result. */
 
     QStringList rc_allowed_hosts;  /*!< Hosts where we accept connection from. */
     int         rc_port;           /*!< The port we are listening on. */
@@ -139,6 +176,14 @@ private:
     QString     cmd_AOS();
     QString     cmd_LOS();
     QString     cmd_dump_state();
+    QString     cmd_perf_stats();
+    QString     cmd_thread_layout();
+    QString     cmd_spectrum(QStringList cmdlist);
+    QString     cmd_vfo_add(QStringList cmdlist);
+    QString     cmd_vfo_del(QStringList cmdlist);
+    QString     cmd_vfo_set(QStringList cmdlist);
+    QString     cmd_channelizer(QStringList cmdlist);
+    int         vfoModeStrToInt(QString mode_str);
 };
 
 #endif // REMOTE_CONTROL_H
@@ -0,0 +1,268 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <QDebug>
+
+#include "applications/gqrx/rx_control.h"
+
+RxControl::RxControl(receiver *rx) :
+    rx(rx),
+    d_cw_offset(700)
+{
+}
+
+/** Set the CW offset in Hz used by the CWL and CWU modes. */
+void RxControl::setCwOffset(int offset)
+{
+    d_cw_offset = offset;
+}
+
+/**
+ * @brief Get the demodulator of a mode.
+ * @param mode The mode index.
+ * @param demod The demodulator (output).
+ * @param cwofs The CW offset of the mode in Hz, 0 for other modes (output).
+ * @return false if the mode is invalid.
+ */
+bool RxControl::getDemod(int mode, receiver::rx_demod *demod, double *cwofs) const
+{
+    *cwofs = 0.0;
+
+    switch (mode) {
+
+    case RxModes::MODE_OFF:
+        *demod = receiver::RX_DEMOD_OFF;
+        break;
+
+    case RxModes::MODE_RAW:
+        *demod = receiver::RX_DEMOD_NONE;
+        break;
+
+    case RxModes::MODE_AM:
+        *demod = receiver::RX_DEMOD_AM;
+        break;
+
+    case RxModes::MODE_NFM:
+        *demod = receiver::RX_DEMOD_NFM;
+        break;
+
+    case RxModes::MODE_WFM_MONO:
+        *demod = receiver::RX_DEMOD_WFM_M;
+        break;
+
+    case RxModes::MODE_WFM_STEREO:
+        *demod = receiver::RX_DEMOD_WFM_S;
+        break;
+
+    case RxModes::MODE_WFM_STEREO_OIRT:
+        *demod = receiver::RX_DEMOD_WFM_S_OIRT;
+        break;
+
+    case RxModes::MODE_LSB:
+    case RxModes::MODE_USB:
+        *demod = receiver::RX_DEMOD_SSB;
+        break;
+
+    case RxModes::MODE_CWL:
+        *demod = receiver::RX_DEMOD_SSB;
+        *cwofs = -d_cw_offset;
+        break;
+
+    case RxModes::MODE_CWU:
+        *demod = receiver::RX_DEMOD_SSB;
+        *cwofs = d_cw_offset;
+        break;
+
+    default:
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Add the additional channels of the "vfo" group.
+ * @param settings The configuration; the group is never written back.
+ *
+ * Each channel is an array entry with the offset from the hardware frequency
+ * in Hz, the mode index (as receiver/demod), the squelch level, the audio
+ * gain in dB and optionally the UDP host and port for its audio. The number
+ * of channelizer sub-bands, 0 to disable it, is set before the channels are
+ * added. Channels added earlier are removed first.
+ */
+void RxControl::readVfoSettings(QSettings *settings)
+{
+    int     i, n, vfo, port;
+
+    while (rx->get_vfo_count() > 0)
+        rx->remove_vfo(0);
+
+    rx->set_channelizer(settings->value("vfo/channelizer", 0).toUInt());
+
+    n = settings->beginReadArray("vfo");
+    for (i = 0; i < n; i++)
+    {
+        settings->setArrayIndex(i);
+
+        vfo = addVfo(settings->value("offset", 0).toLongLong(),
+                     settings->value("demod", RxModes::MODE_NFM).toInt());
+        if (vfo < 0)
+        {
+            qWarning() << "Invalid VFO" << i + 1 << "in" << settings->fileName();
+            continue;
+        }
+
+        rx->set_vfo_sql_level(vfo, settings->value("sql_level", -150.0).toDouble());
+        rx->set_vfo_af_gain(vfo, settings->value("gain", 0.0).toFloat());
+
+        port = settings->value("udp_port", 0).toInt();
+        if (port > 0)
+            rx->start_vfo_udp_streaming(vfo,
+                    settings->value("udp_host", "127.0.0.1").toString().toStdString(),
+                    port);
+    }
+    settings->endArray();
+}
+
+/**
+ * @brief Get the demodulator and filter of an additional channel.
+ * @param mode The mode index; MODE_OFF is not valid for a channel.
+ * @return false if the mode is invalid.
+ *
+ * The channels use the normal filter preset of the mode.
+ */
+bool RxControl::getVfoMode(int mode, receiver::rx_demod *demod, int *lo,
+                           int *hi, double *cwofs) const
+{
+    if (mode == RxModes::MODE_OFF || !getDemod(mode, demod, cwofs))
+        return false;
+
+    RxModes::getFilterPreset(mode, FILTER_PRESET_NORMAL, lo, hi);
+
+    return true;
+}
+
+/**
+ * @brief Add an additional channel.
+ * @param offset The offset from the hardware frequency in Hz.
+ * @param mode The mode index.
+ * @return The index of the channel or -1 on error.
+ */
+int RxControl::addVfo(qint64 offset, int mode)
+{
+    receiver::rx_demod  demod;
+    double  cwofs;
+    int     lo, hi;
+    int     vfo;
+
+    if (!getVfoMode(mode, &demod, &lo, &hi, &cwofs))
+        return -1;
+
+    vfo = rx->add_vfo((double) offset, demod);
+    if (vfo >= 0)
+    {
+        rx->set_vfo_filter(vfo, lo, hi, receiver::FILTER_SHAPE_NORMAL);
+        rx->set_vfo_cw_offset(vfo, cwofs);
+    }
+
+    return vfo;
+}
+
+/** Select the mode of an additional channel using the normal filter preset. */
+bool RxControl::setVfoMode(int vfo, int mode)
+{
+    receiver::rx_demod  demod;
+    double  cwofs;
+    int     lo, hi;
+
+    if (!getVfoMode(mode, &demod, &lo, &hi, &cwofs) ||
+        rx->set_vfo_demod(vfo, demod) != receiver::STATUS_OK)
+        return false;
+
+    rx->set_vfo_filter(vfo, lo, hi, receiver::FILTER_SHAPE_NORMAL);
+    rx->set_vfo_cw_offset(vfo, cwofs);
+
+    return true;
+}
+
+/** Performance counters requested through the remote control interface. */
+QString RxControl::getPerfStats(void)
+{
+    return QString::fromStdString(rx->get_perf_report());
+}
+
+/** Thread layout requested through the remote control interface. */
+QString RxControl::getThreadLayout(void)
+{
+    return QString::fromStdString(rx->get_thread_report());
+}
+
+/** Baseband spectrum requested through the remote control interface. */
+QString RxControl::getSpectrum(int bins, int fftsize)
+{
+    return QString::fromStdString(rx->get_spectrum_report(bins, fftsize));
+}
+
+/** Remote control client disconnected; release the FFT used by its spectrum reports. */
+void RxControl::clientDisconnected(void)
+{
+    rx->release_spectrum_report();
+}
+
+/** Channel removed through the remote control interface. */
+bool RxControl::removeVfo(int vfo)
+{
+    return rx->remove_vfo(vfo) == receiver::STATUS_OK;
+}
+
+/** Channel offset set through the remote control interface. */
+bool RxControl::setVfoOffset(int vfo, qint64 offset)
+{
+    return rx->set_vfo_offset(vfo, (double) offset) == receiver::STATUS_OK;
+}
+
+/** Channel squelch level set through the remote control interface. */
+bool RxControl::setVfoSqlLevel(int vfo, double level_db)
+{
+    return rx->set_vfo_sql_level(vfo, level_db) == receiver::STATUS_OK;
+}
+
+/** Channel audio gain set through the remote control interface. */
+bool RxControl::setVfoGain(int vfo, double gain_db)
+{
+    return rx->set_vfo_af_gain(vfo, (float) gain_db) == receiver::STATUS_OK;
+}
+
+/** Channel UDP streaming started or stopped (port 0) through the remote control interface. */
+bool RxControl::setVfoUdp(int vfo, const QString &host, int port)
+{
+    if (port > 0)
+        return rx->start_vfo_udp_streaming(vfo, host.toStdString(), port) == receiver::STATUS_OK;
+
+    return rx->stop_vfo_udp_streaming(vfo) == receiver::STATUS_OK;
+}
+
+/** Channelizer sub-bands set through the remote control interface. */
+bool RxControl::setChannelizer(int nchan)
+{
+    return rx->set_channelizer((unsigned int) nchan) == receiver::STATUS_OK;
+}
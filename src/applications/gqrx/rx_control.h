@@ -0,0 +1,81 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef RX_CONTROL_H
+#define RX_CONTROL_H
+
+#include <QSettings>
+
+#include "applications/gqrx/receiver.h"
+#include "applications/gqrx/remote_control.h"
+#include "applications/gqrx/rx_modes.h"
+
+/**
+ * @brief Receiver control shared by gqrx and gqrxd.
+ *
+ * Maps the mode indices (RxModes::mode_idx) to the receiver demodulators
+ * and manages the additional channels (VFOs) of the "vfo" configuration
+ * group. The channels are not shown in the user interface and their audio
+ * is only available through UDP.
+ *
+ * It is also the backend of the remote control commands that return a
+ * result.
+ */
+class RxControl : public RemoteControlBackend
+{
+public:
+    explicit RxControl(receiver *rx);
+
+    void setCwOffset(int offset);
+    int  getCwOffset(void) const
+    {
+        return d_cw_offset;
+    }
+
+    bool getDemod(int mode, receiver::rx_demod *demod, double *cwofs) const;
+
+    void readVfoSettings(QSettings *settings);
+
+    /* RemoteControlBackend */
+    QString getPerfStats(void);
+    QString getThreadLayout(void);
+    QString getSpectrum(int bins, int fftsize);
+    void    clientDisconnected(void);
+    int     addVfo(qint64 offset, int mode);
+    bool    removeVfo(int vfo);
+    bool    setVfoOffset(int vfo, qint64 offset);
+    bool    setVfoMode(int vfo, int mode);
+    bool    setVfoSqlLevel(int vfo, double level_db);
+    bool    setVfoGain(int vfo, double gain_db);
+    bool    setVfoUdp(int vfo, const QString &host, int port);
+    bool    setChannelizer(int nchan);
+
+private:
+    bool getVfoMode(int mode, receiver::rx_demod *demod, int *lo, int *hi,
+                    double *cwofs) const;
+
+private:
+    receiver   *rx;
+    int         d_cw_offset;    /*!< CW offset in Hz. */
+};
+
+#endif // RX_CONTROL_H
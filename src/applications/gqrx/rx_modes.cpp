@@ -0,0 +1,80 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011-2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <QDebug>
+
+#include "applications/gqrx/rx_modes.h"
+
+// Filter preset table per mode, preset and lo/hi
+static const int filter_preset_table[RxModes::MODE_LAST][3][2] =
+{   //     WIDE             NORMAL            NARROW
+    {{      0,      0}, {     0,     0}, {     0,     0}},  // MODE_OFF
+    {{ -15000,  15000}, { -5000,  5000}, { -1000,  1000}},  // MODE_RAW
+    {{ -10000,  10000}, { -5000,  5000}, { -2500,  2500}},  // MODE_AM
+    {{ -10000,  10000}, { -5000,  5000}, { -2500,  2500}},  // MODE_NFM
+    {{-100000, 100000}, {-80000, 80000}, {-60000, 60000}},  // MODE_WFM_MONO
+    {{-100000, 100000}, {-80000, 80000}, {-60000, 60000}},  // MODE_WFM_STEREO
+    {{  -4000,   -100}, { -2800,  -100}, { -1600,  -200}},  // MODE_LSB
+    {{    100,   4000}, {   100,  2800}, {   200,  1600}},  // MODE_USB
+    {{  -1000,   1000}, {  -250,   250}, {  -100,   100}},  // MODE_CWL
+    {{  -1000,   1000}, {  -250,   250}, {  -100,   100}},  // MODE_CWU
+    {{-100000, 100000}, {-80000, 80000}, {-60000, 60000}}   // MODE_WFM_STEREO_OIRT
+};
+
+/** Get filter lo/hi for a given mode and preset */
+void RxModes::getFilterPreset(int mode, int preset, int *lo, int *hi)
+{
+    if (mode < 0 || mode >= MODE_LAST)
+    {
+        qDebug() << __func__ << ": Invalid mode:" << mode;
+        mode = MODE_AM;
+    }
+    else if (preset < 0 || preset > 2)
+    {
+        qDebug() << __func__ << ": Invalid preset:" << preset;
+        preset = FILTER_PRESET_NORMAL;
+    }
+    *lo = filter_preset_table[mode][preset][0];
+    *hi = filter_preset_table[mode][preset][1];
+}
+
+/**
+ * @brief Get the filter preset matching a filter.
+ * @param mode The mode index.
+ * @param lo The low cutoff frequency in Hz.
+ * @param hi The high cutoff frequency in Hz.
+ * @return The preset index, FILTER_PRESET_USER if no preset matches.
+ */
+int RxModes::filterPresetFromLoHi(int mode, int lo, int hi)
+{
+    int preset;
+
+    if (mode < 0 || mode >= MODE_LAST)
+        return FILTER_PRESET_USER;
+
+    for (preset = FILTER_PRESET_WIDE; preset <= FILTER_PRESET_NARROW; preset++)
+        if (lo == filter_preset_table[mode][preset][0] &&
+            hi == filter_preset_table[mode][preset][1])
+            return preset;
+
+    return FILTER_PRESET_USER;
+}
@@ -0,0 +1,69 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2011-2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef RX_MODES_H
+#define RX_MODES_H
+
+#define FILTER_PRESET_WIDE      0
+#define FILTER_PRESET_NORMAL    1
+#define FILTER_PRESET_NARROW    2
+#define FILTER_PRESET_USER      3
+
+/**
+ * @brief Receiver modes and their filter presets.
+ *
+ * The mode index is the entry of the mode selector in DockRxOpt, the value
+ * stored as receiver/demod in the configuration and the mode used by the
+ * remote control interface. It is shared by gqrx and gqrxd, so this class
+ * does not depend on any widget.
+ */
+class RxModes
+{
+public:
+
+    /**
+     * Mode selector entries.
+     *
+     * @note If you change this enum, remember to update the TCP interface.
+     * @note Keep in same order as the Strings in ModulationStrings, see
+     *       DockRxOpt.cpp constructor.
+     */
+    enum mode_idx {
+        MODE_OFF        = 0, /*!< Demodulator completely off. */
+        MODE_RAW        = 1, /*!< Raw I/Q passthrough. */
+        MODE_AM         = 2, /*!< Amplitude modulation. */
+        MODE_NFM        = 3, /*!< Narrow band FM. */
+        MODE_WFM_MONO   = 4, /*!< Broadcast FM (mono). */
+        MODE_WFM_STEREO = 5, /*!< Broadcast FM (stereo). */
+        MODE_LSB        = 6, /*!< Lower side band. */
+        MODE_USB        = 7, /*!< Upper side band. */
+        MODE_CWL        = 8, /*!< CW using LSB filter. */
+        MODE_CWU        = 9, /*!< CW using USB filter. */
+        MODE_WFM_STEREO_OIRT = 10, /*!< Broadcast FM (stereo oirt). */
+        MODE_LAST       = 11
+    };
+
+    static void getFilterPreset(int mode, int preset, int *lo, int *hi);
+    static int  filterPresetFromLoHi(int mode, int lo, int hi);
+};
+
+#endif // RX_MODES_H
@@ -0,0 +1,540 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMap>
+#include <QStringList>
+#include <QVariant>
+#include <iostream>
+
+#include "applications/gqrxd/gqrxd.h"
+#include "dsp/fft_wisdom.h"
+
+/* Convert a list of CPU cores from the configuration, e.g. "2,3". */
+static std::vector<int> cores_from_settings(const QVariant &value)
+{
+    std::vector<int> cores;
+    QStringList list = value.toStringList();
+    bool        conv_ok;
+    int         i, core;
+
+    for (i = 0; i < list.size(); i++)
+    {
+        core = list[i].trimmed().toInt(&conv_ok);
+        if (conv_ok && core >= 0)
+            cores.push_back(core);
+    }
+
+    return cores;
+}
+
+Gqrxd::Gqrxd(QObject *parent) :
+    QObject(parent),
+    m_settings(0),
+    d_lnb_lo(0),
+    d_mode(RxModes::MODE_OFF),
+    d_sql_level(-150.0)
+{
+    /* Initialise default configuration directory */
+    QByteArray xdg_dir = qgetenv("XDG_CONFIG_HOME");
+    if (xdg_dir.isEmpty())
+        m_cfg_dir = QString("%1/.config/gqrx").arg(QDir::homePath());
+    else
+        m_cfg_dir = QString("%1/gqrx").arg(xdg_dir.data());
+
+    /* FFT plans created from now on use the cached wisdom */
+    fft_wisdom_load(QString("%1/fftw_wisdom").arg(m_cfg_dir).toStdString());
+
+    m_rec_dir = QDir::homePath();
+
+    /* create receiver object; the audio device is set by the configuration */
+    rx = new receiver("", RX_AUDIO_DEVICE_NULL, 1);
+    rx->set_rf_freq(144500000.0f);
+    rx_ctl = new RxControl(rx);
+
+    remote = new RemoteControl(this);
+    remote->setBackend(rx_ctl);
+    connect(remote, SIGNAL(newFrequency(qint64)), this, SLOT(setNewFrequency(qint64)));
+    connect(remote, SIGNAL(newFilterOffset(qint64)), this, SLOT(setFilterOffset(qint64)));
+    connect(remote, SIGNAL(newMode(int)), this, SLOT(selectDemod(int)));
+    connect(remote, SIGNAL(newPassband(int)), this, SLOT(setPassband(int)));
+    connect(remote, SIGNAL(newSquelchLevel(double)), this, SLOT(setSqlLevel(double)));
+    connect(remote, SIGNAL(startAudioRecorderEvent()), this, SLOT(startAudioRec()));
+    connect(remote, SIGNAL(stopAudioRecorderEvent()), this, SLOT(stopAudioRec()));
+
+    meter_timer = new QTimer(this);
+    connect(meter_timer, SIGNAL(timeout()), this, SLOT(meterTimeout()));
+}
+
+Gqrxd::~Gqrxd()
+{
+    meter_timer->stop();
+    remote->stop_server();
+
+    if (rx->is_recording_audio())
+        rx->stop_audio_recording();
+    rx->stop();
+
+    remote->setBackend(0);
+    delete rx_ctl;
+    delete rx;
+    delete m_settings;
+}
+
+/**
+ * @brief Load a gqrx configuration file.
+ * @param cfgfile The configuration file.
+ * @returns True if the configuration contains an input device.
+ *
+ * The settings are applied in the same order as in MainWindow::loadConfig().
+ */
+bool Gqrxd::loadConfig(const QString cfgfile)
+{
+    qint64  int64_val;
+    bool    conv_ok;
+
+    openConfig(cfgfile);
+
+    // read before the flow graph starts; otherwise keep the GNU Radio prefs
+    if (m_settings->value("scheduler/perf_counters", false).toBool())
+        rx->set_perf_counters(true);
+
+    QString indev = m_settings->value("input/device", "").toString();
+    if (indev.isEmpty())
+    {
+        qCritical() << "No input device in" << m_settings->fileName();
+        return false;
+    }
+
+    rx->set_input_device(indev.toStdString());
+    rx->set_output_device(m_settings->value("output/device", "").toString().toStdString());
+
+    applyFrontendSettings(applyDeviceSettings());
+    applyReceiverSettings();
+    applyAudioSettings();
+    rx_ctl->readVfoSettings(m_settings);
+
+    int64_val = m_settings->value("input/frequency", 14236000).toLongLong(&conv_ok);
+    if (!conv_ok)
+        int64_val = 14236000;
+    setNewFrequency(int64_val);
+
+    remote->setFilterOffset((qint64)rx->get_filter_offset());
+    remote->setSquelchLevel(d_sql_level);
+
+    /* Initialize the remote control at the end (see MainWindow) */
+    remote->readSettings(m_settings);
+    if (m_settings->value("remote_control/enabled", false).toBool())
+        remote->start_server();
+
+    return true;
+}
+
+/** Start the receiver. */
+void Gqrxd::start(void)
+{
+    rx->start();
+    remote->setReceiverStatus(true);
+    meter_timer->start(100);
+}
+
+/**
+ * @brief Process an I/Q file as fast as possible.
+ * @param cfgfile The configuration providing the receiver settings.
+ * @param iqfile The I/Q file (complex float samples).
+ * @param rate The sample rate of the I/Q file.
+ * @param audiofile WAV file for the audio output or empty to discard it.
+ * @returns The number of processed samples per second or 0 on error.
+ *
+ * The file is played back without throttling and the audio goes to a file
+ * or null sink, so the receiver is not paced by any clock. The demodulator,
+ * filter, offset and front-end settings are taken from the configuration;
+ * the input device and hardware settings are ignored.
+ */
+double Gqrxd::processFile(const QString cfgfile, const QString iqfile,
+                          double rate, const QString audiofile)
+{
+    QFileInfo       fi(iqfile);
+    QElapsedTimer   timer;
+    double          elapsed;
+    qint64          samples;
+
+    if (!fi.isFile() || rate <= 0.0)
+    {
+        qCritical() << "Can not process" << iqfile << "at" << rate << "sps";
+        return 0.0;
+    }
+
+    openConfig(cfgfile);
+
+    if (audiofile.isEmpty())
+        rx->set_output_device(RX_AUDIO_DEVICE_NULL);
+    else
+        rx->set_output_device(QString("%1%2").arg(RX_AUDIO_DEVICE_FILE)
+                              .arg(audiofile).toStdString());
+
+    rx->set_input_device(QString("file=%1,rate=%2,repeat=false,throttle=false")
+                         .arg(fi.absoluteFilePath()).arg(rate, 0, 'f', 0)
+                         .toStdString());
+    applyFrontendSettings(rx->set_input_rate(rate));
+    applyReceiverSettings();
+    applyAudioSettings();
+    rx_ctl->readVfoSettings(m_settings);
+
+    samples = fi.size() / (2 * sizeof(float));
+
+    timer.start();
+    rx->start();
+    rx->wait();
+    elapsed = 1.0e-3 * (double) timer.elapsed();
+    if (elapsed < 1.0e-3)
+        elapsed = 1.0e-3;
+
+    std::cout << "Processed " << samples << " samples in " << elapsed << " s: "
+              << samples / elapsed << " samples/sec ("
+              << samples / elapsed / rate << " x realtime)" << std::endl;
+
+    return samples / elapsed;
+}
+
+/** Open the configuration file. */
+void Gqrxd::openConfig(const QString cfgfile)
+{
+    /* If cfgfile is not an absolute path it is a file under m_cfg_dir */
+    delete m_settings;
+    if (QDir::isAbsolutePath(cfgfile))
+        m_settings = new QSettings(cfgfile, QSettings::IniFormat);
+    else
+        m_settings = new QSettings(QString("%1/%2").arg(m_cfg_dir).arg(cfgfile),
+                                   QSettings::IniFormat);
+
+    qDebug() << "Configuration file:" << m_settings->fileName();
+}
+
+/**
+ * @brief Apply the hardware settings of the "input" group.
+ * @returns The actual sample rate.
+ */
+double Gqrxd::applyDeviceSettings(void)
+{
+    double  actual_rate;
+    qint64  int64_val;
+    int     int_val;
+    bool    conv_ok;
+
+    int_val = m_settings->value("input/sample_rate", 0).toInt(&conv_ok);
+    if (conv_ok && (int_val > 0))
+    {
+        actual_rate = rx->set_input_rate(int_val);
+        if (actual_rate == 0)
+        {
+            qWarning() << "There was an error configuring the input device";
+            actual_rate = int_val;
+        }
+
+        qDebug() << "Requested sample rate:" << int_val;
+        qDebug() << "Actual sample rate   :" << QString("%1").arg(actual_rate, 0, 'f', 6);
+    }
+    else
+        actual_rate = rx->get_input_rate();
+
+    int64_val = m_settings->value("input/bandwidth", 0).toInt(&conv_ok);
+    if (conv_ok)
+        rx->set_analog_bandwidth((double) int64_val);
+
+    int64_val = m_settings->value("input/corr_freq", 0).toLongLong(&conv_ok);
+    if (conv_ok)
+        rx->set_freq_corr(((double)int64_val)/1.0e6);
+
+    QString ant = m_settings->value("input/antenna", "").toString();
+    if (!ant.isEmpty() && rx->get_antennas().size() > 1)
+        rx->set_antenna(ant.toStdString());
+
+    if (m_settings->value("input/hwagc", false).toBool())
+    {
+        rx->set_auto_gain(true);
+    }
+    else if (m_settings->contains("input/gains"))
+    {
+        // gains are stored as dB*10 integers (see DockInputCtl)
+        QMap<QString, QVariant> allgains = m_settings->value("input/gains").toMap();
+        QMapIterator<QString, QVariant> gain_iter(allgains);
+
+        while (gain_iter.hasNext())
+        {
+            gain_iter.next();
+            rx->set_gain(gain_iter.key().toStdString(),
+                         0.1 * (double)(gain_iter.value().toInt()));
+        }
+    }
+    else if (m_settings->value("input/device", "").toString().contains("rtl", Qt::CaseInsensitive))
+    {
+        // rtlsdr gain is 0 by default; use max gain like MainWindow does
+        std::vector<std::string> gain_names = rx->get_gain_names();
+        std::vector<std::string>::iterator it;
+        double start, stop, step;
+
+        for (it = gain_names.begin(); it != gain_names.end(); ++it)
+        {
+            rx->get_gain_range(*it, &start, &stop, &step);
+            rx->set_gain(*it, stop);
+        }
+    }
+
+    return actual_rate;
+}
+
+/**
+ * @brief Apply the front-end settings of the "input" group.
+ * @param actual_rate The input sample rate.
+ */
+void Gqrxd::applyFrontendSettings(double actual_rate)
+{
+    qint64  int64_val;
+    int     int_val;
+    bool    conv_ok;
+
+    int_val = m_settings->value("input/decimation", 1).toInt(&conv_ok);
+    if (conv_ok && int_val >= 2)
+    {
+        if (rx->set_input_decim(int_val) != (unsigned int)int_val)
+            qDebug() << "Failed to set decimation" << int_val;
+        else
+            actual_rate /= (double)int_val;
+    }
+    else
+        rx->set_input_decim(1);
+
+    remote->setBandwidth((qint64)actual_rate);
+
+    rx->set_iq_swap(m_settings->value("input/swap_iq", false).toBool());
+    rx->set_dc_cancel(m_settings->value("input/dc_cancel", false).toBool());
+    rx->set_iq_balance(m_settings->value("input/iq_balance", false).toBool());
+
+    int_val = m_settings->value("input/latency", receiver::LATENCY_BALANCED).toInt(&conv_ok);
+    if (conv_ok)
+        rx->set_latency_profile((receiver::latency_profile)int_val);
+
+    rx->set_frontend_affinity(cores_from_settings(m_settings->value("scheduler/frontend_cores")));
+    rx->set_channel_affinity(cores_from_settings(m_settings->value("scheduler/channel_cores")));
+    rx->set_audio_priority(m_settings->value("scheduler/audio_priority", 0).toInt());
+
+    rx->set_iq_fft_welch(m_settings->value("fft/welch_overlap", 0.5).toFloat(),
+                         m_settings->value("fft/welch_budget", 0.0).toFloat());
+    rx->set_iq_fft_threads(m_settings->value("fft/threads", 1).toInt());
+    rx->set_iq_fft_window(m_settings->value("fft/window", 0).toInt());
+
+    int64_val = m_settings->value("input/lnb_lo", 0).toLongLong(&conv_ok);
+    if (conv_ok)
+        d_lnb_lo = int64_val;
+}
+
+/** Apply the settings of the "receiver" group. */
+void Gqrxd::applyReceiverSettings(void)
+{
+    double  dbl_val;
+    int     int_val;
+    bool    conv_ok;
+
+    int_val = m_settings->value("receiver/cwoffset", 700).toInt(&conv_ok);
+    if (conv_ok)
+        rx_ctl->setCwOffset(int_val);
+
+    dbl_val = m_settings->value("receiver/sql_level", 1.0).toDouble(&conv_ok);
+    if (conv_ok && dbl_val < 1.0)
+        d_sql_level = dbl_val;
+
+    int_val = m_settings->value("receiver/demod", 0).toInt(&conv_ok);
+    if (conv_ok && int_val >= 0)
+        selectDemod(int_val);
+
+    int_val = m_settings->value("receiver/offset", 0).toInt(&conv_ok);
+    if (conv_ok && int_val)
+        rx->set_filter_offset((double) int_val);
+
+    // AGC settings
+    int_val = m_settings->value("receiver/agc_threshold", -100).toInt(&conv_ok);
+    if (conv_ok)
+        rx->set_agc_threshold(int_val);
+
+    int_val = m_settings->value("receiver/agc_decay", 500).toInt(&conv_ok);
+    if (conv_ok)
+        rx->set_agc_decay(int_val);
+
+    int_val = m_settings->value("receiver/agc_slope", 0).toInt(&conv_ok);
+    if (conv_ok)
+        rx->set_agc_slope(int_val);
+
+    int_val = m_settings->value("receiver/agc_gain", 0).toInt(&conv_ok);
+    if (conv_ok)
+        rx->set_agc_manual_gain(int_val);
+
+    rx->set_agc_hang(m_settings->value("receiver/agc_usehang", false).toBool());
+    rx->set_agc_on(!m_settings->value("receiver/agc_off", false).toBool());
+}
+
+/** Apply the settings of the "audio" group. */
+void Gqrxd::applyAudioSettings(void)
+{
+    int     int_val;
+    bool    conv_ok;
+
+    // audio gain is stored as dB*10 (see DockAudio)
+    int_val = m_settings->value("audio/gain", -200).toInt(&conv_ok);
+    if (conv_ok)
+        rx->set_af_gain(0.1f * (float)int_val);
+
+    m_rec_dir = m_settings->value("audio/rec_dir", QDir::homePath()).toString();
+}
+
+/**
+ * @brief Set new receive frequency.
+ * @param rx_freq The new frequency including LNB LO and filter offset.
+ */
+void Gqrxd::setNewFrequency(qint64 rx_freq)
+{
+    double hw_freq = (double)(rx_freq - d_lnb_lo) - rx->get_filter_offset();
+
+    rx->set_rf_freq(hw_freq);
+    remote->setNewFrequency(rx_freq);
+}
+
+/** Set new channel filter offset. */
+void Gqrxd::setFilterOffset(qint64 freq_hz)
+{
+    qint64 hw_freq = (qint64)rx->get_rf_freq();
+
+    rx->set_filter_offset((double) freq_hz);
+    remote->setFilterOffset(freq_hz);
+    remote->setNewFrequency(hw_freq + d_lnb_lo + freq_hz);
+
+    if (rx->is_rds_decoder_active())
+        rx->reset_rds_parser();
+}
+
+/**
+ * @brief Select new demodulator.
+ * @param mode_idx New mode index (see RxModes::mode_idx).
+ *
+ * This is the headless version of MainWindow::selectDemod() using the normal
+ * filter preset.
+ */
+void Gqrxd::selectDemod(int mode_idx)
+{
+    receiver::rx_demod demod;
+    double cwofs = 0.0;
+    int flo = 0, fhi = 0;
+
+    if (!rx_ctl->getDemod(mode_idx, &demod, &cwofs))
+    {
+        qDebug() << "Invalid mode index:" << mode_idx;
+        mode_idx = RxModes::MODE_OFF;
+        demod = receiver::RX_DEMOD_OFF;
+    }
+
+    if (mode_idx == RxModes::MODE_OFF && rx->is_recording_audio())
+        stopAudioRec();
+
+    RxModes::getFilterPreset(mode_idx, FILTER_PRESET_NORMAL, &flo, &fhi);
+
+    rx->set_demod(demod);
+    rx->set_filter((double)flo, (double)fhi, receiver::FILTER_SHAPE_NORMAL);
+    rx->set_cw_offset(cwofs);
+    rx->set_sql_level(d_sql_level);
+
+    d_mode = mode_idx;
+    remote->setMode(mode_idx);
+    remote->setPassband(flo, fhi);
+}
+
+/** Set new filter width requested through the remote control interface. */
+void Gqrxd::setPassband(int bandwidth)
+{
+    int lo, hi;
+
+    /* Check if filter is symmetric or not by checking the presets */
+    RxModes::getFilterPreset(d_mode, FILTER_PRESET_NORMAL, &lo, &hi);
+
+    if (lo + hi == 0)
+    {
+        lo = -bandwidth / 2;
+        hi =  bandwidth / 2;
+    }
+    else if (lo >= 0 && hi >= 0)
+    {
+        hi = lo + bandwidth;
+    }
+    else if (lo <= 0 && hi <= 0)
+    {
+        lo = hi - bandwidth;
+    }
+
+    rx->set_filter((double)lo, (double)hi, receiver::FILTER_SHAPE_NORMAL);
+    remote->setPassband(lo, hi);
+}
+
+/** Set new squelch level in dBFS. */
+void Gqrxd::setSqlLevel(double level_db)
+{
+    d_sql_level = level_db;
+    rx->set_sql_level(level_db);
+    remote->setSquelchLevel(level_db);
+}
+
+/** Start audio recorder using the same file names as DockAudio. */
+void Gqrxd::startAudioRec(void)
+{
+    if (d_mode == RxModes::MODE_OFF || rx->is_recording_audio())
+        return;
+
+    qint64 rx_freq = (qint64)(rx->get_rf_freq() + rx->get_filter_offset()) + d_lnb_lo;
+    QString file_name = QDateTime::currentDateTime().toUTC().toString("gqrx_yyyyMMdd_hhmmss");
+    QString filename = QString("%1/%2_%3.wav").arg(m_rec_dir).arg(file_name).arg(rx_freq);
+
+    if (rx->start_audio_recording(filename.toStdString()))
+    {
+        qWarning() << "Error starting audio recorder";
+        return;
+    }
+
+    qDebug() << "Recording audio to" << filename;
+    remote->startAudioRecorder(filename);
+}
+
+/** Stop audio recorder. */
+void Gqrxd::stopAudioRec(void)
+{
+    if (rx->stop_audio_recording())
+        qWarning() << "Error stopping audio recorder";
+
+    remote->stopAudioRecorder();
+}
+
+/** Signal strength meter timeout. */
+void Gqrxd::meterTimeout(void)
+{
+    remote->setSignalLevel(rx->get_signal_pwr(true));
+}
@@ -0,0 +1,102 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef GQRXD_H
+#define GQRXD_H
+
+#include <QObject>
+#include <QSettings>
+#include <QString>
+#include <QTimer>
+
+#include "applications/gqrx/remote_control.h"
+
+// see https://bugreports.qt-project.org/browse/QTBUG-22829
+#ifndef Q_MOC_RUN
+#include "applications/gqrx/receiver.h"
+#include "applications/gqrx/rx_control.h"
+#endif
+
+/*! \brief Headless receiver.
+ *
+ * This class plays the role of MainWindow in the gqrxd daemon: it owns the
+ * receiver and the remote control server, and it applies the settings of a
+ * gqrx configuration file. Settings that only concern the user interface
+ * (FFT, plotter, window geometry, ...) are ignored and the configuration file
+ * is never written back.
+ *
+ * The only periodic work done on the event loop is updating the signal
+ * level reported through the remote control interface.
+ *
+ * processFile() runs the same receiver on an I/Q file without throttling,
+ * which is used for offline processing and as a DSP throughput benchmark.
+ */
+class Gqrxd : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Gqrxd(QObject *parent = 0);
+    ~Gqrxd();
+
+    bool loadConfig(const QString cfgfile);
+    void start(void);
+
+    double processFile(const QString cfgfile, const QString iqfile,
+                       double rate, const QString audiofile);
+
+public slots:
+    void setNewFrequency(qint64 rx_freq);
+
+private:
+    void openConfig(const QString cfgfile);
+    double applyDeviceSettings(void);
+    void applyFrontendSettings(double actual_rate);
+    void applyReceiverSettings(void);
+    void applyAudioSettings(void);
+
+private slots:
+    void setFilterOffset(qint64 freq_hz);
+    void selectDemod(int mode_idx);
+    void setPassband(int bandwidth);
+    void setSqlLevel(double level_db);
+    void startAudioRec(void);
+    void stopAudioRec(void);
+    void meterTimeout(void);
+
+private:
+    QSettings  *m_settings;     /*!< The configuration being used. */
+    QString     m_cfg_dir;      /*!< Default config dir, e.g. XDG_CONFIG_HOME. */
+    QString     m_rec_dir;      /*!< Directory for audio recordings. */
+
+    qint64      d_lnb_lo;       /*!< LNB LO in Hz. */
+    int         d_mode;         /*!< Current mode index. */
+    double      d_sql_level;    /*!< Squelch level in dBFS. */
+
+    receiver       *rx;
+    RxControl      *rx_ctl;
+    RemoteControl  *remote;
+
+    QTimer     *meter_timer;
+};
+
+#endif // GQRXD_H
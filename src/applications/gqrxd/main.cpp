@@ -0,0 +1,197 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <QCoreApplication>
+#include <QDebug>
+#include <QSocketNotifier>
+#include <QString>
+#include <QtGlobal>
+
+#ifdef WITH_PORTAUDIO
+#include <portaudio.h>
+#endif
+
+#include <csignal>
+#include <iostream>
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <boost/program_options.hpp>
+#include <boost/thread/thread.hpp>
+namespace po = boost::program_options;
+
+#include "applications/gqrx/gqrx.h"
+#include "applications/gqrxd/gqrxd.h"
+#include "dsp/fft_benchmark.h"
+
+#ifdef Q_OS_UNIX
+/** Pipe used to pass SIGINT and SIGTERM from the signal handler to the event loop. */
+static int quit_fd[2] = { -1, -1 };
+
+/**
+ * Quit the event loop on SIGINT and SIGTERM so that the receiver is stopped
+ * properly. QCoreApplication::quit() is not async-signal-safe so the handler
+ * only writes to a pipe, which is watched by a QSocketNotifier.
+ */
+static void quit_handler(int sig)
+{
+    char    c = (char)sig;
+    ssize_t ret = ::write(quit_fd[1], &c, 1);
+
+    Q_UNUSED(ret);
+}
+
+/** Install quit_handler(); the notifier is owned by app. */
+static void setup_quit_handler(QCoreApplication &app)
+{
+    if (::pipe(quit_fd) != 0)
+    {
+        qCritical() << "Failed to create the signal pipe";
+        return;
+    }
+    ::fcntl(quit_fd[1], F_SETFL, O_NONBLOCK);
+
+    QSocketNotifier *notifier = new QSocketNotifier(quit_fd[0], QSocketNotifier::Read, &app);
+    QObject::connect(notifier, SIGNAL(activated(int)), &app, SLOT(quit()));
+
+    std::signal(SIGINT, quit_handler);
+    std::signal(SIGTERM, quit_handler);
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+    QString         cfg_file;
+    std::string     conf;
+    std::string     iq_file;
+    std::string     audio_file;
+    double          iq_rate = 0.0;
+    bool            clierr = false;
+    int             return_code;
+
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName(GQRX_ORG_NAME);
+    QCoreApplication::setOrganizationDomain(GQRX_ORG_DOMAIN);
+    QCoreApplication::setApplicationName(GQRX_APP_NAME);
+    QCoreApplication::setApplicationVersion(VERSION);
+
+    // see applications/gqrx/main.cpp
+    if (!qputenv("GR_CONF_CONTROLPORT_ON", "False"))
+        qDebug() << "Failed to disable controlport";
+
+    po::options_description desc("Command line options");
+    desc.add_options()
+            ("help,h", "This help message")
+            ("conf,c", po::value<std::string>(&conf), "Start with this config file")
+            ("iq-file,f", po::value<std::string>(&iq_file), "Process this I/Q file as fast as possible and exit")
+            ("rate,r", po::value<double>(&iq_rate), "Sample rate of the I/Q file")
+            ("audio-file,a", po::value<std::string>(&audio_file), "Write the audio of the I/Q file to this WAV file")
+            ("fft-benchmark,b", "Measure the spectrum frame rate for each FFT size and number of threads and exit")
+            ("kernel-benchmark,k", "Measure the power to dB conversion of the spectrum for each FFT size and exit")
+    ;
+
+    po::variables_map vm;
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+    }
+    catch(const boost::program_options::invalid_command_line_syntax& ex)
+    {
+        clierr = true;
+    }
+    catch(const boost::program_options::unknown_option& ex)
+    {
+        clierr = true;
+    }
+    catch(const boost::program_options::invalid_option_value& ex)
+    {
+        clierr = true;
+    }
+
+    po::notify(vm);
+
+    if (vm.count("help") || clierr)
+    {
+        std::cout << "Gqrx headless receiver " << VERSION << std::endl;
+        std::cout << desc << std::endl;
+        return 1;
+    }
+
+    if (vm.count("fft-benchmark"))
+    {
+        fft_benchmark(std::cout, boost::thread::hardware_concurrency());
+        return 0;
+    }
+
+    if (vm.count("kernel-benchmark"))
+    {
+        return spectrum_kernel_benchmark(std::cout) ? 0 : 1;
+    }
+
+    if (!conf.empty())
+        cfg_file = QString::fromStdString(conf);
+    else
+        cfg_file = "default.conf";
+
+#ifdef WITH_PORTAUDIO
+    PaError     err = Pa_Initialize();
+    if (err != paNoError)
+        qCritical() << "Failed to initialize Portaudio backend:"
+                    << Pa_GetErrorText(err);
+#endif
+
+    {
+        Gqrxd daemon;
+
+        if (!iq_file.empty())
+        {
+            // batch mode; the configuration only provides the receiver settings
+            if (daemon.processFile(cfg_file, QString::fromStdString(iq_file), iq_rate,
+                                   QString::fromStdString(audio_file)) > 0.0)
+                return_code = 0;
+            else
+                return_code = 1;
+        }
+        else if (daemon.loadConfig(cfg_file))
+        {
+#ifdef Q_OS_UNIX
+            setup_quit_handler(app);
+#endif
+
+            daemon.start();
+            return_code = app.exec();
+        }
+        else
+        {
+            std::cout << "Can not use configuration " << cfg_file.toStdString()
+                      << "; create one using gqrx first." << std::endl;
+            return_code = 1;
+        }
+    }
+
+#ifdef WITH_PORTAUDIO
+    Pa_Terminate();
+#endif
+
+    return return_code;
+}
@@ -0,0 +1,110 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <cstdio>
+#include <gnuradio/block.h>
+#include <gnuradio/block_detail.h>
+#include <gnuradio/high_res_timer.h>
+#include "dsp/block_perf.h"
+
+/*! \brief Append the counters of a block to a list.
+ *  \param stats The list.
+ *  \param name The name used in the list.
+ *  \param block The block.
+ *
+ * Hierarchical blocks are ignored; they add their internal blocks
+ * themselves. The counters are left at 0 if the block is not part of a
+ * running flow graph. The throughput is left at 0 and is calculated by the
+ * caller, which knows the time since the previous update.
+ */
+void block_perf_add(block_perf_list &stats, const std::string &name,
+                    gr::basic_block_sptr block)
+{
+    gr::block_sptr  blk = boost::dynamic_pointer_cast<gr::block>(block);
+    block_perf      perf;
+    double          tps = (double) gr::high_res_timer_tps();
+
+    if (!blk)
+        return;
+
+    perf.name = name;
+    perf.block = blk;
+    perf.work_time = 0.0f;
+    perf.work_time_total = 0.0f;
+    perf.noutput_items = 0.0f;
+    perf.nproduced = 0.0f;
+    perf.input_full = -1.0f;
+    perf.output_full = -1.0f;
+    perf.nitems = 0;
+    perf.throughput = 0.0;
+
+    if (!blk->detail())
+    {
+        stats.push_back(perf);
+        return;
+    }
+
+    perf.work_time = 1.0e6 * blk->pc_work_time_avg() / tps;
+    perf.work_time_total = blk->pc_work_time_total() / tps;
+    perf.noutput_items = blk->pc_noutput_items_avg();
+    perf.nproduced = blk->pc_nproduced_avg();
+
+    if (blk->detail()->ninputs() > 0)
+    {
+        perf.input_full = blk->pc_input_buffers_full_avg(0);
+        perf.nitems = blk->nitems_read(0);
+    }
+    if (blk->detail()->noutputs() > 0)
+    {
+        perf.output_full = blk->pc_output_buffers_full_avg(0);
+        perf.nitems = blk->nitems_written(0);
+    }
+
+    stats.push_back(perf);
+}
+
+/*! \brief Format a list of block counters as a text table (one line per block). */
+std::string block_perf_format(const block_perf_list &stats)
+{
+    std::string     table;
+    char            line[256];
+    unsigned int    i;
+
+    snprintf(line, sizeof(line), "%-32s %13s %10s %8s %8s %5s %5s %14s\n",
+             "# block", "work/call", "work", "nout", "nprod", "in", "out",
+             "throughput");
+    table = line;
+
+    for (i = 0; i < stats.size(); i++)
+    {
+        const block_perf &perf = stats[i];
+
+        snprintf(line, sizeof(line),
+                 "%-32s %10.1f us %8.2f s %8.0f %8.0f %5.2f %5.2f %12.0f/s\n",
+                 perf.name.c_str(), perf.work_time, perf.work_time_total,
+                 perf.noutput_items, perf.nproduced, perf.input_full,
+                 perf.output_full, perf.throughput);
+        table += line;
+    }
+
+    return table;
+}
@@ -0,0 +1,65 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef BLOCK_PERF_H
+#define BLOCK_PERF_H
+
+#include <gnuradio/basic_block.h>
+#include <gnuradio/block.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*! \brief Performance counters of a GNU Radio block.
+ *  \ingroup DSP
+ *
+ * The averages come from the GNU Radio performance counters, which are only
+ * updated when GNU Radio has been built with performance counters and they
+ * are enabled in the preferences ([PerfCounters] on = True). The item count
+ * and the throughput are always available.
+ *
+ * The counters are 0 for blocks that are not part of a running flow graph.
+ * The same lists are used to configure the blocks, see
+ * receiver::set_latency_profile().
+ */
+struct block_perf
+{
+    std::string name;            /*!< Path of the block, e.g. "nbrx/filter/bpf". */
+    gr::block_sptr block;        /*!< The block. */
+    float       work_time;       /*!< Average time spent in work() per call [us]. */
+    float       work_time_total; /*!< Total time spent in work() [s]. */
+    float       noutput_items;   /*!< Average number of items requested per call. */
+    float       nproduced;       /*!< Average number of items produced per call. */
+    float       input_full;      /*!< Average fullness of input buffer 0 (0...1) or -1. */
+    float       output_full;     /*!< Average fullness of output buffer 0 (0...1) or -1. */
+    uint64_t    nitems;          /*!< Items produced on output 0 (consumed on input 0 for sinks). */
+    double      throughput;      /*!< Items per second on the same port. */
+};
+
+typedef std::vector<block_perf> block_perf_list;
+
+void block_perf_add(block_perf_list &stats, const std::string &name,
+                    gr::basic_block_sptr block);
+
+std::string block_perf_format(const block_perf_list &stats);
+
+#endif // BLOCK_PERF_H
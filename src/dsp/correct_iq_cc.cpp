@@ -63,6 +63,13 @@ dc_corr_cc::~dc_corr_cc()
 
 }
 
+/*! \brief Append the performance counters of the internal blocks. */
+void dc_corr_cc::get_perf_stats(block_perf_list &stats, const std::string &prefix) const
+{
+    block_perf_add(stats, prefix + "/iir", d_iir);
+    block_perf_add(stats, prefix + "/sub", d_sub);
+}
+
 /*! \brief Set new sample rate. */
 void dc_corr_cc::set_sample_rate(double sample_rate)
 {
@@ -125,6 +132,13 @@ iq_swap_cc::~iq_swap_cc()
 
 }
 
+/*! \brief Append the performance counters of the internal blocks. */
+void iq_swap_cc::get_perf_stats(block_perf_list &stats, const std::string &prefix) const
+{
+    block_perf_add(stats, prefix + "/c2f", d_c2f);
+    block_perf_add(stats, prefix + "/f2c", d_f2c);
+}
+
 /*! \brief Enabled or disable I/Q swapping. */
 void iq_swap_cc::set_enabled(bool enabled)
 {
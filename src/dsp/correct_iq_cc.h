@@ -29,6 +29,7 @@
 #include <gnuradio/hier_block2.h>
 #include <gnuradio/filter/single_pole_iir_filter_cc.h>
 #include <gnuradio/blocks/sub_cc.h>
+#include "dsp/block_perf.h"
 
 class dc_corr_cc;
 class iq_swap_cc;
@@ -57,6 +58,7 @@ protected:
 
 public:
     ~dc_corr_cc();
+    void get_perf_stats(block_perf_list &stats, const std::string &prefix) const;
     void set_sample_rate(double sample_rate);
     void set_tau(double tau);
 
@@ -86,6 +88,7 @@ protected:
 
 public:
     ~iq_swap_cc();
+    void get_perf_stats(block_perf_list &stats, const std::string &prefix) const;
     void set_enabled(bool enabled);
 
 private:
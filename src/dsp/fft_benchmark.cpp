@@ -0,0 +1,269 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <math.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <vector>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <gnuradio/fft/fft.h>
+#include <gnuradio/filter/firdes.h>
+#include "dsp/fft_benchmark.h"
+#include "dsp/fft_window.h"
+#include "dsp/rx_fft.h"
+#include "dsp/spectrum_kernel.h"
+
+#define BENCH_MIN_FRAMES    3       /* Minimum number of frames per test. */
+#define BENCH_MIN_TIME_MS   250     /* Minimum duration of each test. */
+#define KERNEL_MAX_ERR_DB   0.01    /* Largest accepted error of spectrum_db_avg(). */
+
+/* Time since start in milliseconds. */
+static double elapsed_ms(const boost::posix_time::ptime &start)
+{
+    return (boost::posix_time::microsec_clock::universal_time() - start)
+            .total_microseconds() / 1000.0;
+}
+
+/* Measure one FFT size and thread count; returns the time per frame [ms]. */
+static double bench_one(unsigned int size, unsigned int nthreads,
+                        double &plan_ms)
+{
+    boost::posix_time::ptime    start;
+    std::vector<gr_complex>     samples(size);
+    fft_window_sptr             window;
+    std::vector<float>          pwr(size);
+    gr::fft::fft_complex       *fft;
+    unsigned int                frames = 0;
+    unsigned int                i;
+    double                      total_ms;
+
+    for (i = 0; i < size; i++)
+        samples[i] = gr_complex(rand() / (float)RAND_MAX - 0.5f,
+                                rand() / (float)RAND_MAX - 0.5f);
+    window = fft_window_get(gr::filter::firdes::WIN_HAMMING, size);
+
+    start = boost::posix_time::microsec_clock::universal_time();
+    fft = new gr::fft::fft_complex(size, true, nthreads);
+    plan_ms = elapsed_ms(start);
+
+    start = boost::posix_time::microsec_clock::universal_time();
+    do
+    {
+        gr_complex *buf = fft->get_inbuf();
+        const gr_complex *out = fft->get_outbuf();
+
+        memcpy(buf, &samples[0], sizeof(gr_complex) * size);
+        spectrum_apply_window(buf, &(*window)[0], size);
+
+        fft->execute();
+
+        spectrum_power(out, &pwr[0], size);
+
+        frames++;
+        total_ms = elapsed_ms(start);
+    } while (frames < BENCH_MIN_FRAMES || total_ms < BENCH_MIN_TIME_MS);
+
+    delete fft;
+
+    return total_ms / frames;
+}
+
+void fft_benchmark(std::ostream &out, unsigned int max_threads)
+{
+    unsigned int    size;
+    unsigned int    nthreads;
+    double          frame_ms;
+    double          plan_ms;
+
+    max_threads = std::max(max_threads, 1u);
+
+    out << "# FFT frame rate, up to " << max_threads << " threads" << std::endl;
+    out << "#     size threads   plan [ms]  frame [ms]  frames/s" << std::endl;
+    out << std::fixed;
+
+    for (size = 4096; size <= MAX_FFT_SIZE; size *= 2)
+    {
+        for (nthreads = 1; nthreads <= max_threads; nthreads *= 2)
+        {
+            frame_ms = bench_one(size, nthreads, plan_ms);
+
+            out << std::setw(10) << size
+                << std::setw(8) << nthreads
+                << std::setw(12) << std::setprecision(1) << plan_ms
+                << std::setw(12) << std::setprecision(2) << frame_ms
+                << std::setw(10) << std::setprecision(1) << 1000.0 / frame_ms
+                << std::endl;
+        }
+    }
+}
+
+/* The dB conversion as done before spectrum_db_avg(), for comparison. */
+static void db_avg_reference(const float *pwr, unsigned int size, float scale,
+                             float avg, float *db, float *iir)
+{
+    unsigned int half = size / 2;
+    unsigned int i;
+
+    for (i = 0; i < size; i++)
+    {
+        float pt = pwr[i < size - half ? half + i : i - (size - half)];
+
+        db[i] = 10.0 * log10f(scale * pt + 1.0e-20);
+        iir[i] = iir[i] + avg * (db[i] - iir[i]);
+    }
+}
+
+/* Measure one version of the dB conversion; returns the time per frame [us]. */
+static double bench_kernel(int version, const std::vector<float> &pwr,
+                           std::vector<float> &db, std::vector<float> &iir)
+{
+    boost::posix_time::ptime    start;
+    unsigned int    size = pwr.size();
+    unsigned int    half = size / 2;
+    unsigned int    frames = 0;
+    float           scale = 1.0 / ((float)size * (float)size);
+    double          total_ms;
+
+    start = boost::posix_time::microsec_clock::universal_time();
+    do
+    {
+        switch (version)
+        {
+        case 0:
+            db_avg_reference(&pwr[0], size, scale, 0.5, &db[0], &iir[0]);
+            break;
+
+        case 1:
+            spectrum_db_avg_generic(&pwr[half], size - half, scale, 0.5,
+                                    &db[0], &iir[0], &iir[0]);
+            spectrum_db_avg_generic(&pwr[0], half, scale, 0.5,
+                                    &db[size - half], &iir[size - half],
+                                    &iir[size - half]);
+            break;
+
+        default:
+            spectrum_db_avg(&pwr[half], size - half, scale, 0.5,
+                            &db[0], &iir[0], &iir[0]);
+            spectrum_db_avg(&pwr[0], half, scale, 0.5,
+                            &db[size - half], &iir[size - half],
+                            &iir[size - half]);
+            break;
+        }
+
+        frames++;
+        total_ms = elapsed_ms(start);
+    } while (frames < BENCH_MIN_FRAMES || total_ms < BENCH_MIN_TIME_MS);
+
+    return 1000.0 * total_ms / frames;
+}
+
+/*
+ * Largest difference between one version of the dB conversion and
+ * 10*log10f(), in dB, for both the converted power and the average.
+ */
+static double kernel_error(int version, const std::vector<float> &pwr,
+                           float scale)
+{
+    unsigned int        num = pwr.size();
+    std::vector<float>  db(num);
+    std::vector<float>  iir_in(num);
+    std::vector<float>  iir_out(num);
+    double              err = 0.0;
+    float               ref_db, ref_iir;
+    unsigned int        i;
+
+    for (i = 0; i < num; i++)
+        iir_in[i] = -150.0f + 0.01f * (i % 15000);
+
+    if (version == 1)
+        spectrum_db_avg_generic(&pwr[0], num, scale, 0.3, &db[0], &iir_in[0],
+                                &iir_out[0]);
+    else
+        spectrum_db_avg(&pwr[0], num, scale, 0.3, &db[0], &iir_in[0],
+                        &iir_out[0]);
+
+    for (i = 0; i < num; i++)
+    {
+        ref_db = 10.0f * log10f(std::max(scale * pwr[i], 1.0e-20f));
+        ref_iir = iir_in[i] + 0.3f * (ref_db - iir_in[i]);
+
+        /* NaN must fail as well */
+        if (!(fabs(db[i] - ref_db) <= err))
+            err = std::isnan(db[i]) ? HUGE_VAL : fabs(db[i] - ref_db);
+        if (!(fabs(iir_out[i] - ref_iir) <= err))
+            err = std::isnan(iir_out[i]) ? HUGE_VAL : fabs(iir_out[i] - ref_iir);
+    }
+
+    return err;
+}
+
+bool spectrum_kernel_benchmark(std::ostream &out)
+{
+    unsigned int    size;
+    unsigned int    i;
+    double          ref_us, generic_us, simd_us;
+    double          err;
+    bool            passed = true;
+
+    out << "# Power to dB conversion and averaging per frame" << std::endl;
+    out << "#     size  log10f [us] generic [us]   simd [us]   speedup  error [dB]" << std::endl;
+    out << std::fixed;
+
+    for (size = 4096; size <= MAX_FFT_SIZE; size *= 2)
+    {
+        std::vector<float>  pwr(size);
+        std::vector<float>  db(size);
+        std::vector<float>  iir(size, -100.0);
+        float               scale = 1.0 / ((float)size * (float)size);
+
+        for (i = 0; i < size; i++)
+            pwr[i] = (float)size * size * rand() / (float)RAND_MAX;
+
+        ref_us = bench_kernel(0, pwr, db, iir);
+        generic_us = bench_kernel(1, pwr, db, iir);
+        simd_us = bench_kernel(2, pwr, db, iir);
+
+        /* the accuracy is checked from the floor to far above full scale */
+        for (i = 0; i < size; i++)
+            pwr[i] = (i % 64 == 0) ? 0.0f :
+                     (float)size * size * powf(10.0f, -24.0f + 30.0f * rand() / (float)RAND_MAX);
+        err = std::max(kernel_error(1, pwr, scale), kernel_error(2, pwr, scale));
+
+        out << std::setw(10) << size
+            << std::setprecision(1)
+            << std::setw(13) << ref_us
+            << std::setw(13) << generic_us
+            << std::setw(12) << simd_us
+            << std::setw(10) << ref_us / simd_us
+            << std::setw(12) << std::setprecision(4) << err;
+        if (err > KERNEL_MAX_ERR_DB)
+        {
+            out << "  FAILED";
+            passed = false;
+        }
+        out << std::endl;
+    }
+
+    return passed;
+}
@@ -0,0 +1,53 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef FFT_BENCHMARK_H
+#define FFT_BENCHMARK_H
+
+#include <ostream>
+
+/*! \brief Measure the spectrum frame rate of the baseband FFT.
+ *  \param out The stream to print the results to.
+ *  \param max_threads The largest number of FFT threads to try.
+ *
+ * Each FFT size from 4k to MAX_FFT_SIZE is measured with 1, 2, 4, ...
+ * max_threads threads. A frame consists of the same steps as in rx_fft_c:
+ * windowing, the FFT and the power of each bin. The results are printed
+ * one line per size and thread count.
+ */
+void fft_benchmark(std::ostream &out, unsigned int max_threads);
+
+/*! \brief Measure the conversion of the spectrum to dB.
+ *  \param out The stream to print the results to.
+ *  \return false if the portable or the SIMD version is not accurate.
+ *
+ * Compares the former per-bin loop using log10f() with the portable and
+ * the SIMD versions of spectrum_db_avg() for sizes from 4k to MAX_FFT_SIZE.
+ * Each frame includes the FFT shift and the exponential average.
+ *
+ * Both versions are also checked against 10*log10f() for powers from the
+ * floor to far above full scale; an error above 0.01 dB is reported as
+ * FAILED, so a broken SIMD path does not go unnoticed.
+ */
+bool spectrum_kernel_benchmark(std::ostream &out);
+
+#endif // FFT_BENCHMARK_H
@@ -0,0 +1,81 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <list>
+#include <boost/thread/mutex.hpp>
+#include <gnuradio/filter/firdes.h>
+#include "dsp/fft_window.h"
+
+/*! \brief A cached window. */
+struct fft_window_entry
+{
+    int             wintype;
+    unsigned int    size;
+    float           gain;
+    fft_window_sptr taps;
+};
+
+/* The cache, most recently used first; protected by cache_mutex. */
+static std::list<fft_window_entry> cache;
+static boost::mutex cache_mutex;
+
+fft_window_sptr fft_window_get(int wintype, unsigned int size, float gain)
+{
+    boost::mutex::scoped_lock lock(cache_mutex);
+    std::list<fft_window_entry>::iterator it;
+    std::vector<float> *taps;
+    fft_window_entry entry;
+    double sum = 0.0;
+    float scale;
+    unsigned int i;
+
+    if ((wintype < gr::filter::firdes::WIN_HAMMING) || (wintype > gr::filter::firdes::WIN_BLACKMAN_hARRIS))
+        wintype = gr::filter::firdes::WIN_HAMMING;
+
+    for (it = cache.begin(); it != cache.end(); ++it)
+    {
+        if (it->wintype == wintype && it->size == size && it->gain == gain)
+        {
+            cache.splice(cache.begin(), cache, it);
+            return cache.front().taps;
+        }
+    }
+
+    taps = new std::vector<float>(gr::filter::firdes::window((gr::filter::firdes::win_type)wintype,
+                                                             size, 6.76));
+    for (i = 0; i < taps->size(); i++)
+        sum += (*taps)[i];
+
+    scale = gain / sum;
+    for (i = 0; i < taps->size(); i++)
+        (*taps)[i] *= scale;
+
+    entry.wintype = wintype;
+    entry.size = size;
+    entry.gain = gain;
+    entry.taps = fft_window_sptr(taps);
+    cache.push_front(entry);
+    if (cache.size() > FFT_WINDOW_CACHE_SIZE)
+        cache.pop_back();
+
+    return entry.taps;
+}
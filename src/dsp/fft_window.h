@@ -0,0 +1,51 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef FFT_WINDOW_H
+#define FFT_WINDOW_H
+
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+/* Number of windows kept by fft_window_get(). */
+#define FFT_WINDOW_CACHE_SIZE 8
+
+typedef boost::shared_ptr<const std::vector<float> > fft_window_sptr;
+
+/*! \brief Get the spectrum window for a window type and FFT size.
+ *  \param wintype The window type (see gr::filter::firdes::win_type);
+ *                 unsupported types are replaced by WIN_HAMMING.
+ *  \param size The FFT size.
+ *  \param gain Additional gain, e.g. 2 for the half spectrum of real signals.
+ *  \return The window taps.
+ *
+ * The taps are divided by their sum, which folds the 1/fftsize power
+ * normalization and the coherent gain of the window into one table: a
+ * full scale complex tone at the center of a bin has a power of 1 (0 dBFS)
+ * whatever the window type. The windows are cached, so switching between
+ * window types or FFT sizes that have been used recently costs nothing.
+ *
+ * The function is thread safe.
+ */
+fft_window_sptr fft_window_get(int wintype, unsigned int size, float gain=1.0);
+
+#endif // FFT_WINDOW_H
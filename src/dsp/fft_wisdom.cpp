@@ -0,0 +1,77 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <cstdio>
+#include <iostream>
+#include <fftw3.h>
+#include <gnuradio/fft/fft.h>
+#include "dsp/fft_wisdom.h"
+
+/* The wisdom file; protected by the planner lock. */
+static std::string wisdom_file;
+
+/*! \brief Load the wisdom cache.
+ *  \param filename The wisdom file, it is also used by fft_wisdom_save().
+ *  \return true if the file has been loaded, false if it does not exist
+ *          or could not be read.
+ */
+bool fft_wisdom_load(const std::string &filename)
+{
+    gr::fft::planner::scoped_lock lock(gr::fft::planner::mutex());
+
+    wisdom_file = filename;
+    if (!fftwf_import_wisdom_from_filename(wisdom_file.c_str()))
+    {
+#ifndef QT_NO_DEBUG_OUTPUT
+        std::cout << "No FFTW wisdom loaded from " << wisdom_file << std::endl;
+#endif
+        return false;
+    }
+
+    return true;
+}
+
+/*! \brief Write the current wisdom to the cache.
+ *  \return true if the wisdom has been written.
+ *
+ * The wisdom is written to a temporary file first, so an interrupted write
+ * never leaves a truncated cache behind.
+ */
+bool fft_wisdom_save(void)
+{
+    gr::fft::planner::scoped_lock lock(gr::fft::planner::mutex());
+    std::string tmp_file;
+
+    if (wisdom_file.empty())
+        return false;
+
+    tmp_file = wisdom_file + ".tmp";
+    if (!fftwf_export_wisdom_to_filename(tmp_file.c_str()) ||
+        std::rename(tmp_file.c_str(), wisdom_file.c_str()) != 0)
+    {
+        std::cout << "Error writing FFTW wisdom to " << wisdom_file << std::endl;
+        std::remove(tmp_file.c_str());
+        return false;
+    }
+
+    return true;
+}
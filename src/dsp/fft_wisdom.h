@@ -0,0 +1,46 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef FFT_WISDOM_H
+#define FFT_WISDOM_H
+
+#include <string>
+
+/*! \file
+ *  \brief Persistent FFTW wisdom cache.
+ *
+ * FFTW measures several algorithms when a plan is created for a new FFT
+ * size, which takes seconds for the largest spectrum sizes. The result of
+ * these measurements (the "wisdom") is kept in a file in the configuration
+ * directory, so each size is only measured once per machine.
+ *
+ * The wisdom is loaded into FFTW at startup using fft_wisdom_load(); the
+ * gr::fft plans created afterwards use it automatically. After a new size
+ * has been planned the wisdom is written back using fft_wisdom_save().
+ * Both functions hold the GNU Radio FFT planner lock, so they are safe to
+ * call while other threads create plans.
+ */
+
+bool fft_wisdom_load(const std::string &filename);
+bool fft_wisdom_save(void);
+
+#endif // FFT_WISDOM_H
@@ -158,3 +158,11 @@ fir_decim_cc::~fir_decim_cc()
 {
 
 }
+
+/*! \brief Append the performance counters of the internal blocks. */
+void fir_decim_cc::get_perf_stats(block_perf_list &stats, const std::string &prefix) const
+{
+    block_perf_add(stats, prefix + "/fir1", fir1);
+    block_perf_add(stats, prefix + "/fir2", fir2);
+    block_perf_add(stats, prefix + "/fir3", fir3);
+}
@@ -24,6 +24,7 @@
 
 #include <gnuradio/filter/fir_filter_ccf.h>
 #include <gnuradio/hier_block2.h>
+#include "dsp/block_perf.h"
 
 class fir_decim_cc;
 
@@ -40,6 +41,7 @@ public:
 
 public:
     ~fir_decim_cc();
+    void get_perf_stats(block_perf_list &stats, const std::string &prefix) const;
 
 private:
     gr::filter::fir_filter_ccf::sptr        fir1;
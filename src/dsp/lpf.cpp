@@ -71,6 +71,12 @@ lpf_ff::~lpf_ff()
 
 }
 
+/*! \brief Append the performance counters of the internal blocks. */
+void lpf_ff::get_perf_stats(block_perf_list &stats, const std::string &prefix) const
+{
+    block_perf_add(stats, prefix + "/lpf", lpf);
+}
+
 
 void lpf_ff::set_param(double cutoff_freq, double trans_width)
 {
@@ -26,6 +26,7 @@
 #include <gnuradio/hier_block2.h>
 #include <gnuradio/filter/firdes.h>
 #include <gnuradio/filter/fir_filter_fff.h>
+#include "dsp/block_perf.h"
 
 
 class lpf_ff;
@@ -70,6 +71,7 @@ protected:
 
 public:
     ~lpf_ff();
+    void get_perf_stats(block_perf_list &stats, const std::string &prefix) const;
 
     void set_param(double cutoff_freq, double trans_width);
 
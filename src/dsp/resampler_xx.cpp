@@ -68,6 +68,12 @@ resampler_cc::~resampler_cc()
 
 }
 
+/*! \brief Append the performance counters of the internal blocks. */
+void resampler_cc::get_perf_stats(block_perf_list &stats, const std::string &prefix) const
+{
+    block_perf_add(stats, prefix + "/filter", d_filter);
+}
+
 void resampler_cc::set_rate(float rate)
 {
     /* generate taps */
@@ -129,6 +135,12 @@ resampler_ff::~resampler_ff()
 
 }
 
+/*! \brief Append the performance counters of the internal blocks. */
+void resampler_ff::get_perf_stats(block_perf_list &stats, const std::string &prefix) const
+{
+    block_perf_add(stats, prefix + "/filter", d_filter);
+}
+
 void resampler_ff::set_rate(float rate)
 {
     /* generate taps */
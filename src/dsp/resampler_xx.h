@@ -26,6 +26,7 @@
 #include <gnuradio/hier_block2.h>
 #include <gnuradio/filter/pfb_arb_resampler_ccf.h>
 #include <gnuradio/filter/pfb_arb_resampler_fff.h>
+#include "dsp/block_perf.h"
 
 
 class resampler_cc;
@@ -55,6 +56,7 @@ class resampler_cc : public gr::hier_block2
 public:
     resampler_cc(float rate); // FIXME: should be private
     ~resampler_cc();
+    void get_perf_stats(block_perf_list &stats, const std::string &prefix) const;
 
     void set_rate(float rate);
 
@@ -85,6 +87,7 @@ class resampler_ff : public gr::hier_block2
 public:
     resampler_ff(float rate); // FIXME: should be private
     ~resampler_ff();
+    void get_perf_stats(block_perf_list &stats, const std::string &prefix) const;
 
     void set_rate(float rate);
 
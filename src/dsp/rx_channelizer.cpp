@@ -0,0 +1,113 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <cmath>
+#include <gnuradio/io_signature.h>
+#include <gnuradio/filter/firdes.h>
+#include "dsp/rx_channelizer.h"
+
+/* Oversampling factor of the filter bank outputs. */
+#define OVERSAMPLE_RATE 2.0f
+
+rx_channelizer_sptr make_rx_channelizer(unsigned int nchan, double sample_rate)
+{
+    return gnuradio::get_initial_sptr(new rx_channelizer(nchan, sample_rate));
+}
+
+rx_channelizer::rx_channelizer(unsigned int nchan, double sample_rate)
+    : gr::hier_block2 ("rx_channelizer",
+                      gr::io_signature::make (1, 1, sizeof(gr_complex)),
+                      gr::io_signature::make (nchan, nchan, sizeof(gr_complex))),
+      d_nchan(nchan),
+      d_sample_rate(sample_rate)
+{
+    std::vector<float> taps;
+    unsigned int i;
+
+    /* The prototype filter is designed with the sub-band spacing as unit
+     * so that it does not depend on the sample rate: the pass band extends
+     * to 0.75 spacing and the stop band starts before the Nyquist frequency
+     * of the 2x oversampled outputs.
+     */
+    taps = gr::filter::firdes::low_pass(1.0, d_nchan, 0.75, 0.2);
+
+    d_s2ss = gr::blocks::stream_to_streams::make(sizeof(gr_complex), d_nchan);
+    d_pfb = gr::filter::pfb_channelizer_ccf::make(d_nchan, taps,
+                                                  OVERSAMPLE_RATE);
+
+    connect(self(), 0, d_s2ss, 0);
+    for (i = 0; i < d_nchan; i++)
+    {
+        d_null.push_back(gr::blocks::null_sink::make(sizeof(gr_complex)));
+        connect(d_s2ss, i, d_pfb, i);
+        connect(d_pfb, i, d_null[i], 0);
+        connect(d_pfb, i, self(), i);
+    }
+}
+
+rx_channelizer::~rx_channelizer()
+{
+
+}
+
+/*! \brief Append the performance counters of the internal blocks. */
+void rx_channelizer::get_perf_stats(block_perf_list &stats, const std::string &prefix) const
+{
+    block_perf_add(stats, prefix + "/s2ss", d_s2ss);
+    block_perf_add(stats, prefix + "/pfb", d_pfb);
+}
+
+/*! \brief Set new input sample rate.
+ *
+ * The filter bank is independent of the sample rate; this only updates the
+ * values used to map offsets to sub-bands.
+ */
+void rx_channelizer::set_sample_rate(double sample_rate)
+{
+    d_sample_rate = sample_rate;
+}
+
+/*! \brief Get the sample rate of the outputs. */
+double rx_channelizer::get_channel_rate(void) const
+{
+    return OVERSAMPLE_RATE * d_sample_rate / d_nchan;
+}
+
+/*! \brief Find the sub-band containing a given frequency offset.
+ *  \param offset_hz The offset from the center of the input band.
+ *  \param[out] residual_hz The offset from the center of the sub-band.
+ *  \return The output port carrying the sub-band.
+ */
+int rx_channelizer::channel_for_offset(double offset_hz, double *residual_hz) const
+{
+    double  spacing = get_channel_spacing();
+    int     k = (int) std::floor(offset_hz / spacing + 0.5);
+
+    *residual_hz = offset_hz - k * spacing;
+
+    /* negative frequencies are in the upper half */
+    k %= (int) d_nchan;
+    if (k < 0)
+        k += d_nchan;
+
+    return k;
+}
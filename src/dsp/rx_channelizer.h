@@ -0,0 +1,92 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef RX_CHANNELIZER_H
+#define RX_CHANNELIZER_H
+
+#include <gnuradio/blocks/null_sink.h>
+#include <gnuradio/blocks/stream_to_streams.h>
+#include <gnuradio/filter/pfb_channelizer_ccf.h>
+#include <gnuradio/hier_block2.h>
+#include <vector>
+#include "dsp/block_perf.h"
+
+#define RX_CHANNELIZER_MIN_CHAN   4     /*!< Minimum number of sub-bands. */
+#define RX_CHANNELIZER_MAX_CHAN   256   /*!< Maximum number of sub-bands. */
+
+class rx_channelizer;
+
+typedef boost::shared_ptr<rx_channelizer> rx_channelizer_sptr;
+
+/*! \brief Return a shared_ptr to a new instance of rx_channelizer.
+ *  \param nchan The number of sub-bands (even number).
+ *  \param sample_rate The input sample rate.
+ */
+rx_channelizer_sptr make_rx_channelizer(unsigned int nchan, double sample_rate);
+
+/*! \brief Polyphase filter bank channelizer.
+ *  \ingroup DSP
+ *
+ * This block splits the quadrature stream into nchan equally spaced
+ * sub-bands using a polyphase filter bank (one FFT per nchan input samples).
+ * Output k carries the sub-band centered at k * spacing for k < nchan/2
+ * and (k - nchan) * spacing for the rest, i.e. the outputs are in FFT order.
+ *
+ * The filter bank is oversampled by a factor of 2 and the pass band of each
+ * sub-band is 1.5 times the channel spacing. A channel whose center lies
+ * anywhere in a sub-band and whose bandwidth is less than half the channel
+ * spacing is therefore received without aliasing or edge effects; see
+ * channel_for_offset().
+ *
+ * All outputs are connected internally to null sinks so that unused
+ * sub-bands do not stall the filter bank.
+ */
+class rx_channelizer : public gr::hier_block2
+{
+    friend rx_channelizer_sptr make_rx_channelizer(unsigned int nchan,
+                                                   double sample_rate);
+
+protected:
+    rx_channelizer(unsigned int nchan, double sample_rate);
+
+public:
+    ~rx_channelizer();
+    void get_perf_stats(block_perf_list &stats, const std::string &prefix) const;
+
+    void set_sample_rate(double sample_rate);
+
+    unsigned int get_num_channels(void) const { return d_nchan; }
+    double get_channel_spacing(void) const { return d_sample_rate / d_nchan; }
+    double get_channel_rate(void) const;
+
+    int channel_for_offset(double offset_hz, double *residual_hz) const;
+
+private:
+    unsigned int d_nchan;       /*!< Number of sub-bands. */
+    double       d_sample_rate; /*!< Input sample rate. */
+
+    gr::blocks::stream_to_streams::sptr     d_s2ss;
+    gr::filter::pfb_channelizer_ccf::sptr   d_pfb;
+    std::vector<gr::blocks::null_sink::sptr> d_null;
+};
+
+#endif // RX_CHANNELIZER_H
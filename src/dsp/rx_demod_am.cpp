@@ -75,6 +75,13 @@ rx_demod_am::~rx_demod_am ()
 
 }
 
+/*! \brief Append the performance counters of the internal blocks. */
+void rx_demod_am::get_perf_stats(block_perf_list &stats, const std::string &prefix) const
+{
+    block_perf_add(stats, prefix + "/demod", d_demod);
+    block_perf_add(stats, prefix + "/dcr", d_dcr);
+}
+
 /*! \brief Set DCR status.
  *  \param dcr The new status (on or off).
  */
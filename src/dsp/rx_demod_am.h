@@ -28,6 +28,7 @@
 #include <gnuradio/blocks/complex_to_mag.h>
 #include <gnuradio/filter/iir_filter_ffd.h>
 #include <vector>
+#include "dsp/block_perf.h"
 
 
 class rx_demod_am;
@@ -58,6 +59,7 @@ class rx_demod_am : public gr::hier_block2
 public:
     rx_demod_am(float quad_rate=48000.0, float audio_rate=48000.0, bool dcr=true); // FIXME: could be private
     ~rx_demod_am();
+    void get_perf_stats(block_perf_list &stats, const std::string &prefix) const;
 
     void set_dcr(bool dcr);
     bool dcr();
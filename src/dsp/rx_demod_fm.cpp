@@ -81,6 +81,13 @@ rx_demod_fm::~rx_demod_fm ()
 {
 }
 
+/*! \brief Append the performance counters of the internal blocks. */
+void rx_demod_fm::get_perf_stats(block_perf_list &stats, const std::string &prefix) const
+{
+    block_perf_add(stats, prefix + "/quad", d_quad);
+    block_perf_add(stats, prefix + "/deemph", d_deemph);
+}
+
 /*! \brief Set maximum FM deviation.
  *  \param max_dev The new mximum deviation in Hz
  *
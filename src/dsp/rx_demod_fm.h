@@ -28,6 +28,7 @@
 #include <gnuradio/filter/iir_filter_ffd.h>
 #include <gnuradio/filter/pfb_arb_resampler_ccf.h>
 #include <vector>
+#include "dsp/block_perf.h"
 
 class rx_demod_fm;
 typedef boost::shared_ptr<rx_demod_fm> rx_demod_fm_sptr;
@@ -57,6 +58,7 @@ class rx_demod_fm : public gr::hier_block2
 public:
     rx_demod_fm(float quad_rate=48000.0, float audio_rate=48000.0, float max_dev=5000.0, double tau=50.0e-6); // FIXME: should be private
     ~rx_demod_fm();
+    void get_perf_stats(block_perf_list &stats, const std::string &prefix) const;
 
     void set_max_dev(float max_dev);
     void set_tau(double tau);
@@ -21,13 +21,165 @@
  * Boston, MA 02110-1301, USA.
  */
 #include <math.h>
+#include <algorithm>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <gnuradio/io_signature.h>
 #include <gnuradio/filter/firdes.h>
 #include <gnuradio/gr_complex.h>
 #include <gnuradio/fft/fft.h>
+#include "dsp/fft_window.h"
+#include "dsp/fft_wisdom.h"
+#include "dsp/spectrum_kernel.h"
 #include "dsp/rx_fft.h"
 
 
+/**   rx_spectrum     **/
+
+/*! \brief Create the spectrum output.
+ *  \param half_spectrum Whether the block provides a half spectrum.
+ */
+rx_spectrum::rx_spectrum(bool half_spectrum)
+    : d_half(half_spectrum),
+      d_period_us(0),
+      d_avg(1.0)
+{
+}
+
+rx_spectrum::~rx_spectrum()
+{
+}
+
+/*! \brief Set the frame rate of the spectrum worker.
+ *  \param fps The frame rate; 0 stops the worker and get_spectrum() will
+ *              compute the spectrum on demand.
+ */
+void rx_spectrum::set_spectrum_rate(float fps)
+{
+    if (fps <= 0.0)
+    {
+        stop_spectrum();
+        return;
+    }
+
+    d_period_us = (int)(1.0e6 / fps);
+    if (!d_thread.joinable())
+        d_thread = boost::thread(&rx_spectrum::spectrum_thread, this);
+}
+
+/*! \brief Set the averaging factor.
+ *  \param avg The weight of a new frame (0...1); 1.0 disables averaging.
+ */
+void rx_spectrum::set_spectrum_avg(float avg)
+{
+    boost::mutex::scoped_lock lock(d_update_mutex);
+
+    d_avg = std::min(std::max(avg, 0.0f), 1.0f);
+}
+
+/*! \brief Get the latest power spectrum.
+ *  \param pwr Buffer for the power spectrum in dBFS, DC in the middle.
+ *  \param avg Buffer for the averaged power spectrum (may be NULL).
+ *  \param fftSize The number of bins (output), 0 if there is no spectrum.
+ */
+void rx_spectrum::get_spectrum(float *pwr, float *avg, unsigned int &fftSize)
+{
+    if (!d_thread.joinable())
+        update_spectrum(false);
+
+    boost::mutex::scoped_lock lock(d_spec_mutex);
+
+    fftSize = d_pwr.size();
+    if (fftSize == 0)
+        return;
+
+    memcpy(pwr, &d_pwr[0], sizeof(float) * fftSize);
+    if (avg)
+        memcpy(avg, &d_iir[0], sizeof(float) * fftSize);
+}
+
+/*! \brief Stop the worker thread. */
+void rx_spectrum::stop_spectrum(void)
+{
+    if (d_thread.joinable())
+    {
+        d_thread.interrupt();
+        d_thread.join();
+    }
+}
+
+/*! \brief Spectrum worker thread. */
+void rx_spectrum::spectrum_thread(void)
+{
+    boost::posix_time::ptime    next;
+
+    next = boost::posix_time::microsec_clock::universal_time();
+    try
+    {
+        while (true)
+        {
+            update_spectrum(true);
+
+            /* keep the frame rate but do not try to catch up when late */
+            next += boost::posix_time::microseconds(d_period_us.load());
+            boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+            if (next < now)
+                next = now;
+            boost::this_thread::sleep(next);
+        }
+    }
+    catch (boost::thread_interrupted &)
+    {
+    }
+}
+
+/*! \brief Compute and publish a new spectrum frame.
+ *  \param new_only Only compute a frame if new samples have arrived.
+ *  \return true if a new frame has been published.
+ *
+ * The frame is computed into the back buffers and swapped with the published
+ * frame, so readers are only blocked while the buffers are swapped.
+ */
+bool rx_spectrum::update_spectrum(bool new_only)
+{
+    boost::mutex::scoped_lock lock(d_update_mutex);
+    unsigned int    size;
+    unsigned int    bins;
+    unsigned int    half;
+    bool            reset_avg;
+
+    size = compute_power(d_fftpwr, new_only);
+    if (size == 0)
+        return false;
+
+    /* the published buffers are only modified by this thread, so they can
+     * be read without locking */
+    bins = d_fftpwr.size();
+    reset_avg = (d_iir.size() != bins);
+    d_pwr_back.resize(bins);
+    d_iir_back.resize(bins);
+
+    /* a half spectrum already starts at DC */
+    half = d_half ? 0 : size / 2;
+
+    /* Calculate power in dBFS, average and shift the FFT; the upper half of
+     * the FFT output becomes the lower half of the spectrum. The power is
+     * already normalized by the window (see fft_window_get()). */
+    spectrum_db_avg(&d_fftpwr[half], bins - half, 1.0, d_avg,
+                    &d_pwr_back[0], reset_avg ? 0 : &d_iir[0], &d_iir_back[0]);
+    if (half > 0)
+        spectrum_db_avg(&d_fftpwr[0], half, 1.0, d_avg,
+                        &d_pwr_back[bins - half],
+                        reset_avg ? 0 : &d_iir[bins - half],
+                        &d_iir_back[bins - half]);
+
+    boost::mutex::scoped_lock spec_lock(d_spec_mutex);
+    d_pwr.swap(d_pwr_back);
+    d_iir.swap(d_iir_back);
+
+    return true;
+}
+
+
 rx_fft_c_sptr make_rx_fft_c (unsigned int fftsize, int wintype)
 {
     return gnuradio::get_initial_sptr(new rx_fft_c (fftsize, wintype));
@@ -43,14 +195,26 @@ rx_fft_c::rx_fft_c(unsigned int fftsize, int wintype)
           gr::io_signature::make(1, 1, sizeof(gr_complex)),
           gr::io_signature::make(0, 0, 0)),
       d_fftsize(fftsize),
-      d_wintype(-1)
+      d_wintype(-1),
+      d_welch(0),
+      d_welch_overlap(0.5),
+      d_welch_budget(0.0),
+      d_welch_pending(false),
+      d_ring_gen(0),
+      d_last_written(0),
+      d_next_consumer(0),
+      d_consumer_size(0),
+      d_plan_size(fftsize),
+      d_plan_threads(1),
+      d_fft_threads(1),
+      d_planning(false)
 {
 
     /* create FFT object */
     d_fft = new gr::fft::fft_complex(d_fftsize, true);
 
-    /* allocate circular buffer */
-    d_cbuf.set_capacity(d_fftsize);
+    /* allocate ring buffer */
+    d_ring.resize(d_fftsize);
 
     /* create FFT window */
     set_window_type(wintype);
@@ -58,6 +222,15 @@ rx_fft_c::rx_fft_c(unsigned int fftsize, int wintype)
 
 rx_fft_c::~rx_fft_c()
 {
+    if (d_plan_thread.joinable())
+        d_plan_thread.join();
+    stop_spectrum();
+
+    /* the views read from our ring buffer */
+    d_consumers.clear();
+    d_plan_views.clear();
+
+    delete d_welch;
     delete d_fft;
 }
 
@@ -66,102 +239,257 @@ rx_fft_c::~rx_fft_c()
  *  \param input_items
  *  \param output_items
  *
- * This method does nothing except throwing the incoming samples into the
- * circular buffer.
- * FFT is only executed when the GUI asks for new FFT data via get_fft_data().
+ * This method does nothing except copying the incoming samples into the
+ * ring buffer. The FFT is executed when a new power spectrum frame is
+ * computed, see compute_power().
  */
 int rx_fft_c::work(int noutput_items,
                    gr_vector_const_void_star &input_items,
                    gr_vector_void_star &output_items)
 {
-    int i;
     const gr_complex *in = (const gr_complex*)input_items[0];
     (void) output_items;
 
-    /* just throw new samples into the buffer */
-    boost::mutex::scoped_lock lock(d_mutex);
-    for (i = 0; i < noutput_items; i++)
-    {
-        d_cbuf.push_back(in[i]);
-    }
+    /* just throw new samples into the buffer; they are dropped while the
+     * buffer is being resized */
+    boost::shared_lock<boost::shared_mutex> lock(d_ring_mutex, boost::try_to_lock);
+    if (lock.owns_lock())
+        d_ring.write(in, noutput_items);
 
     return noutput_items;
 
 }
 
-/*! \brief Get FFT data.
- *  \param fftPoints Buffer to copy FFT data
- *  \param fftSize Current FFT size (output).
+/*! \brief Compute a new power spectrum frame (see rx_spectrum).
+ *
+ * With the Welch estimator enabled the frame is the average of all segments
+ * processed since the previous frame, otherwise it is the FFT of the last
+ * fftsize samples.
  */
-void rx_fft_c::get_fft_data(std::complex<float>* fftPoints, unsigned int &fftSize)
+unsigned int rx_fft_c::compute_power(std::vector<float> &pwr, bool new_only)
 {
     boost::mutex::scoped_lock lock(d_mutex);
+    uint64_t written = d_ring.written();
 
-    if (d_cbuf.size() < d_fftsize)
-    {
-        // not enough samples in the buffer
-        fftSize = 0;
+    if (d_welch)
+        return d_welch->collect(pwr) ? d_fftsize : 0;
 
-        return;
-    }
+    if (new_only && written == d_last_written)
+        return 0;
+
+    if (!d_ring.read_last(d_fft->get_inbuf(), d_fftsize))
+        return 0;
+
+    d_last_written = written;
+    do_fft(d_fftsize);
 
-    /* perform FFT */
-    do_fft(d_cbuf.linearize(), d_cbuf.size());  // FIXME: array_one() and two() may be faster
-    //d_cbuf.clear();
+    pwr.resize(d_fftsize);
+    spectrum_power(d_fft->get_outbuf(), &pwr[0], d_fftsize);
 
-    /* get FFT data */
-    memcpy(fftPoints, d_fft->get_outbuf(), sizeof(gr_complex)*d_fftsize);
-    fftSize = d_fftsize;
+    return d_fftsize;
 }
 
-/*! \brief Compute FFT on the available input data.
- *  \param data_in The data to compute FFT on.
- *  \param size The size of data_in.
+/*! \brief Compute FFT on the data in the FFT input buffer.
+ *  \param size The number of samples in the input buffer.
  *
- * Note that this function does not lock the mutex since the caller, get_fft_data()
- * has alrady locked it.
+ * Note that this function does not lock the mutex since the caller,
+ * compute_power(), has already locked it.
  */
-void rx_fft_c::do_fft(const gr_complex *data_in, unsigned int size)
+void rx_fft_c::do_fft(unsigned int size)
 {
     /* apply window, if any */
-    if (d_window.size())
-    {
-        gr_complex *dst = d_fft->get_inbuf();
-        for (unsigned int i = 0; i < size; i++)
-            dst[i] = data_in[i] * d_window[i];
-    }
-    else
-    {
-        memcpy(d_fft->get_inbuf(), data_in, sizeof(gr_complex)*size);
-    }
+    if (d_window)
+        spectrum_apply_window(d_fft->get_inbuf(), &(*d_window)[0], size);
 
     /* compute FFT */
     d_fft->execute();
 }
 
-/*! \brief Set new FFT size. */
+/*! \brief Set new FFT size.
+ *
+ * Creating the FFTW plan for a new size can take several seconds, so it is
+ * done by a background thread while the current size stays active. The new
+ * size is used (and returned by get_fft_size()) once the plan is ready.
+ */
 void rx_fft_c::set_fft_size(unsigned int fftsize)
 {
-    if (fftsize != d_fftsize)
+    boost::mutex::scoped_lock lock(d_plan_mutex);
+
+    d_plan_size = fftsize;
+    start_planning();
+}
+
+/*! \brief Set the number of threads used by large FFTs.
+ *  \param nthreads The number of threads for FFT sizes of FFT_MT_MIN_SIZE
+ *                  and above; smaller FFTs always use one thread.
+ *
+ * The plan is recreated in the background, see set_fft_size().
+ */
+void rx_fft_c::set_fft_threads(unsigned int nthreads)
+{
+    boost::mutex::scoped_lock lock(d_plan_mutex);
+
+    d_plan_threads = std::max(nthreads, 1u);
+    start_planning();
+}
+
+/*! \brief Start the plan thread if any FFT plan is out of date or missing.
+ *
+ * The caller must hold d_plan_mutex but not d_mutex.
+ */
+void rx_fft_c::start_planning(void)
+{
+    /* a running plan thread picks up the new settings when it is done */
+    if (d_planning)
+        return;
+
+    if (d_plan_size == d_fftsize && plan_threads(d_plan_size) == d_fft_threads &&
+        d_plan_views.empty())
     {
         boost::mutex::scoped_lock lock(d_mutex);
 
-        d_fftsize = fftsize;
+        if (!d_welch_pending)
+            return;
+    }
+
+    if (d_plan_thread.joinable())
+        d_plan_thread.join();
 
-        /* clear and resize circular buffer */
-        d_cbuf.clear();
-        d_cbuf.set_capacity(d_fftsize);
+    d_planning = true;
+    d_plan_thread = boost::thread(&rx_fft_c::plan_thread, this);
+}
+
+/*! \brief The number of FFT threads to use for a given size. */
+unsigned int rx_fft_c::plan_threads(unsigned int size) const
+{
+    return size >= FFT_MT_MIN_SIZE ? d_plan_threads : 1;
+}
+
+/*! \brief Create the FFT plan for a new size and switch to it.
+ *
+ * When the new size is in place the Welch estimator is created, which has
+ * one FFT plan per worker thread, followed by the plans of new consumer
+ * views.
+ */
+void rx_fft_c::plan_thread(void)
+{
+    boost::mutex::scoped_lock plan_lock(d_plan_mutex);
+    gr::fft::fft_complex *fft;
+    unsigned int size;
+    unsigned int nthreads;
+
+    while (true)
+    {
+        if (d_plan_size == d_fftsize &&
+            plan_threads(d_plan_size) == d_fft_threads)
+        {
+            if (make_welch(plan_lock))
+                continue;
+            if (d_plan_views.empty())
+                break;
+
+            rx_spectrum_view_sptr view = d_plan_views.back();
+
+            d_plan_views.pop_back();
+            plan_lock.unlock();
+            view->make_plan();
+            plan_lock.lock();
+            continue;
+        }
+
+        size = d_plan_size;
+        nthreads = plan_threads(size);
+
+        plan_lock.unlock();
+        fft = new gr::fft::fft_complex(size, true, nthreads);
+        fft_wisdom_save();
+        plan_lock.lock();
+
+        /* the settings have been changed again in the meantime */
+        if (size != d_plan_size || nthreads != plan_threads(size))
+        {
+            delete fft;
+            continue;
+        }
+
+        if (size == d_fftsize)
+        {
+            /* only the number of threads has changed */
+            boost::mutex::scoped_lock lock(d_mutex);
+
+            delete d_fft;
+            d_fft = fft;
+            d_fft_threads = nthreads;
+            continue;
+        }
+
+        boost::mutex::scoped_lock lock(d_mutex);
+
+        d_fftsize = size;
+        d_fft_threads = nthreads;
 
         /* reset window */
-        int wintype = d_wintype; // FIXME: would be nicer with a window_reset()
-        d_wintype = -1;
-        set_window_type(wintype);
+        make_window();
 
-        /* reset FFT object (also reset FFTW plan) */
+        /* clear and resize ring buffer */
+        reset_ring();
+
+        /* replace FFT object */
         delete d_fft;
-        d_fft = new gr::fft::fft_complex (d_fftsize, true);
+        d_fft = fft;
     }
 
+    d_planning = false;
+}
+
+/*! \brief Create the Welch estimator if it is pending.
+ *  \param plan_lock The lock of d_plan_mutex, released while planning.
+ *  \return false if there was nothing to do.
+ *
+ * The estimator is created without holding d_mutex and only started and
+ * swapped in if the ring has not been reset in the meantime; otherwise it
+ * is discarded and the caller tries again.
+ */
+bool rx_fft_c::make_welch(boost::mutex::scoped_lock &plan_lock)
+{
+    welch_estimator *welch;
+    fft_window_sptr window;
+    unsigned int    gen;
+    unsigned int    size;
+    float           overlap;
+    float           budget;
+
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+
+        if (!d_welch_pending)
+            return false;
+
+        gen = d_ring_gen;
+        size = d_fftsize;
+        window = d_window;
+        overlap = d_welch_overlap;
+        budget = d_welch_budget;
+    }
+
+    plan_lock.unlock();
+    welch = new welch_estimator(d_ring, size, *window, overlap, budget);
+    fft_wisdom_save();
+    plan_lock.lock();
+
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    if (gen != d_ring_gen)
+    {
+        delete welch;
+        return true;
+    }
+
+    welch->start();
+    d_welch = welch;
+    d_welch_pending = false;
+
+    return true;
 }
 
 /*! \brief Get currently used FFT size. */
@@ -179,15 +507,21 @@ void rx_fft_c::set_window_type(int wintype)
         return;
     }
 
-    d_wintype = wintype;
-
-    if ((d_wintype < gr::filter::firdes::WIN_HAMMING) || (d_wintype > gr::filter::firdes::WIN_BLACKMAN_hARRIS))
     {
-        d_wintype = gr::filter::firdes::WIN_HAMMING;
+        boost::mutex::scoped_lock lock(d_mutex);
+
+        d_wintype = wintype;
+        make_window();
+
+        /* the Welch estimator keeps a copy of the window */
+        if (d_welch_budget <= 0.0)
+            return;
+
+        reset_ring();
     }
 
-    d_window.clear();
-    d_window = gr::filter::firdes::window((gr::filter::firdes::win_type)d_wintype, d_fftsize, 6.76);
+    boost::mutex::scoped_lock plan_lock(d_plan_mutex);
+    start_planning();
 }
 
 /*! \brief Get currently used window type. */
@@ -196,6 +530,297 @@ int rx_fft_c::get_window_type()
     return d_wintype;
 }
 
+/*! \brief Enable or disable the Welch estimator.
+ *  \param overlap The overlap between segments (0...0.9).
+ *  \param budget The CPU budget in cores; 0 disables the estimator.
+ *
+ * See welch_estimator for details. While the estimator is enabled the ring
+ * buffer holds at least WELCH_RING_SIZE samples. The estimator is created
+ * in the background, see set_fft_size(); until it is ready the spectrum is
+ * the FFT of the last fftsize samples.
+ */
+void rx_fft_c::set_welch(float overlap, float budget)
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+
+        if (overlap == d_welch_overlap && budget == d_welch_budget)
+            return;
+
+        d_welch_overlap = overlap;
+        d_welch_budget = std::max(budget, 0.0f);
+        reset_ring();
+    }
+
+    boost::mutex::scoped_lock plan_lock(d_plan_mutex);
+    start_planning();
+}
+
+/*! \brief Get the fraction of samples used by the Welch estimator.
+ *  \return The coverage since the last call, 1.0 if the estimator is off.
+ */
+float rx_fft_c::get_welch_coverage(void)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    return d_welch ? d_welch->coverage() : 1.0;
+}
+
+/*! \brief Create the FFT window for the current type and size.
+ *
+ * The caller must hold d_mutex.
+ */
+void rx_fft_c::make_window(void)
+{
+    if ((d_wintype < gr::filter::firdes::WIN_HAMMING) || (d_wintype > gr::filter::firdes::WIN_BLACKMAN_hARRIS))
+    {
+        d_wintype = gr::filter::firdes::WIN_HAMMING;
+    }
+
+    d_window = fft_window_get(d_wintype, d_fftsize);
+}
+
+/*! \brief Clear and resize the ring buffer and restart the Welch estimator.
+ *
+ * The estimator is stopped immediately and recreated by the plan thread, so
+ * the caller must start_planning() after releasing d_mutex.
+ *
+ * The caller must hold d_mutex.
+ */
+void rx_fft_c::reset_ring(void)
+{
+    size_t ring_size = d_fftsize;
+
+    /* the estimator reads from the ring */
+    delete d_welch;
+    d_welch = 0;
+
+    if (d_welch_budget > 0.0)
+        ring_size = std::max(ring_size, (size_t)WELCH_RING_SIZE);
+    ring_size = std::max(ring_size, (size_t)d_consumer_size);
+
+    {
+        boost::unique_lock<boost::shared_mutex> ring_lock(d_ring_mutex);
+        d_ring.resize(ring_size);
+    }
+    d_last_written = 0;
+
+    d_ring_gen++;
+    d_welch_pending = (d_welch_budget > 0.0);
+}
+
+/*! \brief Register a spectrum consumer.
+ *  \param req The FFT size, window, averaging and frame rate of the consumer.
+ *  \return The ID of the consumer, or -1 if the FFT size is invalid.
+ *
+ * Consumers with identical settings share one rx_spectrum_view. When the
+ * FFT size is larger than that of all other consumers the ring buffer is
+ * enlarged, which discards the samples collected so far; it is reduced
+ * again when the consumer is removed.
+ *
+ * The FFT plan of a new view is created by the plan thread (see
+ * set_fft_size()), so the consumer gets no spectrum until it is ready.
+ */
+int rx_fft_c::add_consumer(const rx_spectrum_request &req)
+{
+    boost::mutex::scoped_lock lock(d_consumer_mutex);
+    std::map<int, rx_spectrum_view_sptr>::const_iterator it;
+    rx_spectrum_view_sptr view;
+
+    if (req.fftsize < 2 || req.fftsize > MAX_FFT_SIZE)
+        return -1;
+
+    for (it = d_consumers.begin(); it != d_consumers.end(); ++it)
+    {
+        if (it->second->request() == req)
+        {
+            view = it->second;
+            break;
+        }
+    }
+
+    if (!view)
+    {
+        if (req.fftsize > d_consumer_size)
+        {
+            boost::mutex::scoped_lock fft_lock(d_mutex);
+
+            d_consumer_size = req.fftsize;
+            reset_ring();
+        }
+        view = rx_spectrum_view_sptr(new rx_spectrum_view(req, d_ring, d_ring_mutex));
+
+        boost::mutex::scoped_lock plan_lock(d_plan_mutex);
+        d_plan_views.push_back(view);
+        start_planning();
+    }
+
+    d_consumers[d_next_consumer] = view;
+
+    return d_next_consumer++;
+}
+
+/*! \brief Remove a spectrum consumer.
+ *
+ * The view is deleted when its last consumer has been removed. When it was
+ * the consumer with the largest FFT size the ring buffer is reduced, see
+ * add_consumer().
+ */
+void rx_fft_c::remove_consumer(int id)
+{
+    rx_spectrum_view_sptr view;
+    unsigned int size = 0;
+
+    {
+        boost::mutex::scoped_lock lock(d_consumer_mutex);
+        std::map<int, rx_spectrum_view_sptr>::iterator it = d_consumers.find(id);
+
+        if (it == d_consumers.end())
+            return;
+
+        /* stop the view outside the lock */
+        view = it->second;
+        d_consumers.erase(it);
+
+        for (it = d_consumers.begin(); it != d_consumers.end(); ++it)
+            size = std::max(size, it->second->request().fftsize);
+
+        if (size == d_consumer_size)
+            return;
+
+        boost::mutex::scoped_lock fft_lock(d_mutex);
+
+        d_consumer_size = size;
+        reset_ring();
+    }
+
+    boost::mutex::scoped_lock plan_lock(d_plan_mutex);
+    start_planning();
+}
+
+/*! \brief Get the latest spectrum of a consumer.
+ *  \param id The consumer ID returned by add_consumer().
+ *  \param pwr Buffer for the spectrum in dBFS (FFT size of the consumer).
+ *  \param avg Buffer for the averaged spectrum (FFT size, may be NULL).
+ *  \param fftSize The number of bins (output), 0 if no data is available.
+ *  \return false if there is no consumer with this ID.
+ */
+bool rx_fft_c::get_consumer_spectrum(int id, float *pwr, float *avg,
+                                     unsigned int &fftSize)
+{
+    rx_spectrum_view_sptr view;
+
+    fftSize = 0;
+
+    {
+        boost::mutex::scoped_lock lock(d_consumer_mutex);
+        std::map<int, rx_spectrum_view_sptr>::const_iterator it = d_consumers.find(id);
+
+        if (it == d_consumers.end())
+            return false;
+
+        view = it->second;
+    }
+
+    view->get_spectrum(pwr, avg, fftSize);
+
+    return true;
+}
+
+/*! \brief Get the number of distinct consumer spectra being computed. */
+unsigned int rx_fft_c::get_num_views(void)
+{
+    boost::mutex::scoped_lock lock(d_consumer_mutex);
+    std::map<int, rx_spectrum_view_sptr>::const_iterator it;
+    std::vector<rx_spectrum_view *> views;
+
+    for (it = d_consumers.begin(); it != d_consumers.end(); ++it)
+        if (std::find(views.begin(), views.end(), it->second.get()) == views.end())
+            views.push_back(it->second.get());
+
+    return views.size();
+}
+
+
+/**   rx_spectrum_view     **/
+
+/*! \brief Create a spectrum view.
+ *  \param req The settings of the view.
+ *  \param ring The ring buffer of the owner, at least twice req.fftsize.
+ *  \param ring_mutex Held exclusively by the owner while the ring is resized.
+ *
+ * The view computes no spectrum until make_plan() has been called.
+ */
+rx_spectrum_view::rx_spectrum_view(const rx_spectrum_request &req,
+                                   const sample_ring<gr_complex> &ring,
+                                   boost::shared_mutex &ring_mutex)
+    : d_req(req),
+      d_ring(ring),
+      d_ring_mutex(ring_mutex),
+      d_fft(0),
+      d_last_written(0)
+{
+    d_window = fft_window_get(d_req.wintype, d_req.fftsize);
+
+    set_spectrum_avg(d_req.avg);
+    set_spectrum_rate(d_req.fps);
+}
+
+rx_spectrum_view::~rx_spectrum_view()
+{
+    stop_spectrum();
+    delete d_fft;
+}
+
+/*! \brief Create the FFT plan.
+ *
+ * This can take several seconds for large sizes and is called by the plan
+ * thread of the owner.
+ */
+void rx_spectrum_view::make_plan(void)
+{
+    gr::fft::fft_complex *fft = new gr::fft::fft_complex(d_req.fftsize, true);
+
+    fft_wisdom_save();
+
+    boost::mutex::scoped_lock lock(d_fft_mutex);
+    delete d_fft;
+    d_fft = fft;
+}
+
+/*! \brief Compute a new power spectrum frame (see rx_spectrum). */
+unsigned int rx_spectrum_view::compute_power(std::vector<float> &pwr, bool new_only)
+{
+    boost::mutex::scoped_lock fft_lock(d_fft_mutex);
+    gr_complex *buf;
+    uint64_t    written;
+
+    if (!d_fft)
+        return 0;
+
+    buf = d_fft->get_inbuf();
+
+    {
+        boost::shared_lock<boost::shared_mutex> lock(d_ring_mutex);
+
+        written = d_ring.written();
+        if (new_only && written == d_last_written)
+            return 0;
+
+        if (!d_ring.read_last(buf, d_req.fftsize))
+            return 0;
+    }
+
+    d_last_written = written;
+    spectrum_apply_window(buf, &(*d_window)[0], d_req.fftsize);
+    d_fft->execute();
+
+    pwr.resize(d_req.fftsize);
+    spectrum_power(d_fft->get_outbuf(), &pwr[0], d_req.fftsize);
+
+    return d_req.fftsize;
+}
+
 
 /**   rx_fft_f     **/
 
@@ -213,15 +838,17 @@ rx_fft_f::rx_fft_f(unsigned int fftsize, int wintype)
     : gr::sync_block ("rx_fft_f",
           gr::io_signature::make(1, 1, sizeof(float)),
           gr::io_signature::make(0, 0, 0)),
+      rx_spectrum(true),
       d_fftsize(fftsize),
-      d_wintype(-1)
+      d_wintype(-1),
+      d_last_written(0)
 {
 
     /* create FFT object */
-    d_fft = new gr::fft::fft_complex(d_fftsize, true);
+    d_fft = new gr::fft::fft_real_fwd(d_fftsize);
 
-    /* allocate circular buffer */
-    d_cbuf.set_capacity(d_fftsize);
+    /* allocate ring buffer */
+    d_ring.resize(d_fftsize);
 
     /* create FFT window */
     set_window_type(wintype);
@@ -229,6 +856,7 @@ rx_fft_f::rx_fft_f(unsigned int fftsize, int wintype)
 
 rx_fft_f::~rx_fft_f()
 {
+    stop_spectrum();
     delete d_fft;
 }
 
@@ -237,75 +865,63 @@ rx_fft_f::~rx_fft_f()
  *  \param input_items
  *  \param output_items
  *
- * This method does nothing except throwing the incoming samples into the
- * circular buffer.
- * FFT is only executed when the GUI asks for new FFT data via get_fft_data().
+ * This method does nothing except copying the incoming samples into the
+ * ring buffer. The FFT is executed when a new power spectrum frame is
+ * computed, see compute_power().
  */
 int rx_fft_f::work(int noutput_items,
                    gr_vector_const_void_star &input_items,
                    gr_vector_void_star &output_items)
 {
-    int i;
     const float *in = (const float*)input_items[0];
     (void) output_items;
 
-    /* just throw new samples into the buffer */
-    boost::mutex::scoped_lock lock(d_mutex);
-    for (i = 0; i < noutput_items; i++)
-    {
-        d_cbuf.push_back(in[i]);
-    }
+    /* just throw new samples into the buffer; they are dropped while the
+     * buffer is being resized */
+    boost::unique_lock<boost::mutex> lock(d_ring_mutex, boost::try_to_lock);
+    if (lock.owns_lock())
+        d_ring.write(in, noutput_items);
 
     return noutput_items;
 }
 
-/*! \brief Get FFT data.
- *  \param fftPoints Buffer to copy FFT data
- *  \param fftSize Current FFT size (output).
- */
-void rx_fft_f::get_fft_data(std::complex<float>* fftPoints, unsigned int &fftSize)
+/*! \brief Compute a new power spectrum frame (see rx_spectrum). */
+unsigned int rx_fft_f::compute_power(std::vector<float> &pwr, bool new_only)
 {
     boost::mutex::scoped_lock lock(d_mutex);
+    uint64_t written = d_ring.written();
 
-    if (d_cbuf.size() < d_fftsize)
-    {
-        // not enough samples in the buffer
-        fftSize = 0;
+    if (new_only && written == d_last_written)
+        return 0;
 
-        return;
-    }
+    if (!d_ring.read_last(d_fft->get_inbuf(), d_fftsize))
+        return 0;
 
-    /* perform FFT */
-    do_fft(d_cbuf.linearize(), d_cbuf.size());  // FIXME: array_one() and two() may be faster
-    //d_cbuf.clear();
+    d_last_written = written;
+    do_fft(d_fftsize);
 
-    /* get FFT data */
-    memcpy(fftPoints, d_fft->get_outbuf(), sizeof(gr_complex)*d_fftsize);
-    fftSize = d_fftsize;
+    pwr.resize(d_fftsize / 2 + 1);
+    spectrum_power(d_fft->get_outbuf(), &pwr[0], pwr.size());
+
+    return d_fftsize;
 }
 
-/*! \brief Compute FFT on the available input data.
- *  \param data_in The data to compute FFT on.
- *  \param size The size of data_in.
+/*! \brief Compute FFT on the data in the FFT input buffer.
+ *  \param size The number of samples in the input buffer.
  *
- * Note that this function does not lock the mutex since the caller, get_fft_data()
- * has alrady locked it.
+ * Note that this function does not lock the mutex since the caller,
+ * compute_power(), has already locked it.
  */
-void rx_fft_f::do_fft(const float *data_in, unsigned int size)
+void rx_fft_f::do_fft(unsigned int size)
 {
-    gr_complex *dst = d_fft->get_inbuf();
-    unsigned int i;
-
-    /* apply window, and convert to complex */
-    if (d_window.size())
-    {
-        for (i = 0; i < size; i++)
-            dst[i] = data_in[i] * d_window[i];
-    }
-    else
+    /* apply window, if any */
+    if (d_window)
     {
-        for (i = 0; i < size; i++)
-            dst[i] = data_in[i];
+        float *buf = d_fft->get_inbuf();
+        const float *window = &(*d_window)[0];
+
+        for (unsigned int i = 0; i < size; i++)
+            buf[i] *= window[i];
     }
 
     /* compute FFT */
@@ -322,9 +938,12 @@ void rx_fft_f::set_fft_size(unsigned int fftsize)
 
         d_fftsize = fftsize;
 
-        /* clear and resize circular buffer */
-        d_cbuf.clear();
-        d_cbuf.set_capacity(d_fftsize);
+        /* clear and resize ring buffer */
+        {
+            boost::mutex::scoped_lock ring_lock(d_ring_mutex);
+            d_ring.resize(d_fftsize);
+        }
+        d_last_written = 0;
 
         /* reset window */
         int wintype = d_wintype; // FIXME: would be nicer with a window_reset()
@@ -333,7 +952,7 @@ void rx_fft_f::set_fft_size(unsigned int fftsize)
 
         /* reset FFT object (also reset FFTW plan) */
         delete d_fft;
-        d_fft = new gr::fft::fft_complex(d_fftsize, true);
+        d_fft = new gr::fft::fft_real_fwd(d_fftsize);
     }
 }
 
@@ -359,8 +978,8 @@ void rx_fft_f::set_window_type(int wintype)
         d_wintype = gr::filter::firdes::WIN_HAMMING;
     }
 
-    d_window.clear();
-    d_window = gr::filter::firdes::window((gr::filter::firdes::win_type)d_wintype, d_fftsize, 6.76);
+    /* both sidebands of a real signal are in the half spectrum */
+    d_window = fft_window_get(d_wintype, d_fftsize, 2.0);
 }
 
 /*! \brief Get currently used window type. */
@@ -27,11 +27,130 @@
 #include <gnuradio/fft/fft.h>
 #include <gnuradio/filter/firdes.h>       /* contains enum win_type */
 #include <gnuradio/gr_complex.h>
+#include <boost/shared_ptr.hpp>
 #include <boost/thread/mutex.hpp>
-#include <boost/circular_buffer.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <atomic>
+#include <map>
+#include <vector>
+#include "dsp/fft_window.h"
+#include "dsp/sample_ring.h"
+#include "dsp/welch_estimator.h"
 
 
 #define MAX_FFT_SIZE 1048576
+#define WELCH_RING_SIZE 524288  /* Ring buffer size with Welch averaging. */
+#define FFT_MT_MIN_SIZE 65536   /* Smallest FFT using more than one thread. */
+
+
+/*! \brief Power spectrum output of the FFT blocks.
+ *  \ingroup DSP
+ *
+ * This class turns the raw FFT output of rx_fft_c and rx_fft_f into a
+ * ready-to-plot power spectrum: the bins are shifted so that DC is in the
+ * middle, converted to dBFS and optionally averaged (see set_spectrum_avg()).
+ * The spectrum of a real signal is symmetric, so for a half spectrum only the
+ * fftsize/2 + 1 bins from DC to half the sample rate are kept.
+ *
+ * When a frame rate has been set using set_spectrum_rate() the spectrum is
+ * computed by a worker thread at that rate and get_spectrum() only copies
+ * the latest frame; otherwise get_spectrum() computes a new frame in the
+ * calling thread.
+ *
+ * The derived block provides the power of the FFT bins using compute_power()
+ * and must call stop_spectrum() in its destructor.
+ */
+class rx_spectrum
+{
+public:
+    rx_spectrum(bool half_spectrum=false);
+    virtual ~rx_spectrum();
+
+    void set_spectrum_rate(float fps);
+    void set_spectrum_avg(float avg);
+    void get_spectrum(float *pwr, float *avg, unsigned int &fftSize);
+
+protected:
+    /*! \brief Compute the power of a new FFT frame.
+     *  \param pwr The power |X|^2 of each bin in FFT order, resized to the
+     *              FFT size (fftsize/2 + 1 for a half spectrum). The window
+     *              must include the normalization, see fft_window_get().
+     *  \param new_only Only compute a frame if new samples have arrived.
+     *  \return The FFT size or 0 if no frame was computed.
+     */
+    virtual unsigned int compute_power(std::vector<float> &pwr,
+                                       bool new_only) = 0;
+
+    void stop_spectrum(void);
+
+private:
+    void spectrum_thread(void);
+    bool update_spectrum(bool new_only);
+
+    bool                d_half;         /*! Half spectrum (real input). */
+    boost::mutex        d_update_mutex; /*! Serializes update_spectrum(). */
+    boost::mutex        d_spec_mutex;   /*! Protects the published frame. */
+    boost::thread       d_thread;       /*! Worker thread. */
+    std::atomic<int>    d_period_us;    /*! Frame period of the worker. */
+    float               d_avg;          /*! Averaging factor (1.0 = off). */
+
+    std::vector<float>  d_fftpwr;       /*! Power of the FFT bins. */
+    std::vector<float>  d_pwr;          /*! Published power spectrum. */
+    std::vector<float>  d_iir;          /*! Published averaged spectrum. */
+    std::vector<float>  d_pwr_back;     /*! Frame being computed. */
+    std::vector<float>  d_iir_back;     /*! Frame being computed. */
+};
+
+/*! \brief Settings of one spectrum consumer (see rx_fft_c::add_consumer()). */
+struct rx_spectrum_request
+{
+    unsigned int    fftsize;    /*!< FFT size. */
+    int             wintype;    /*!< Window type (gr::filter::firdes::win_type). */
+    float           avg;        /*!< Averaging factor (1.0 = off). */
+    float           fps;        /*!< Frame rate, 0 computes frames on demand. */
+
+    bool operator==(const rx_spectrum_request &other) const
+    {
+        return fftsize == other.fftsize && wintype == other.wintype &&
+               avg == other.avg && fps == other.fps;
+    }
+};
+
+/*! \brief Additional power spectrum of the samples collected by rx_fft_c.
+ *  \ingroup DSP
+ *
+ * A view has its own FFT size, window, averaging and frame rate but reads
+ * the samples from the ring buffer of the rx_fft_c block that owns it, so
+ * it does not need a block of its own in the flow graph. Views are created
+ * by rx_fft_c::add_consumer() and their FFT plan by the plan thread of the
+ * owner using make_plan().
+ */
+class rx_spectrum_view : public rx_spectrum
+{
+public:
+    rx_spectrum_view(const rx_spectrum_request &req,
+                     const sample_ring<gr_complex> &ring,
+                     boost::shared_mutex &ring_mutex);
+    ~rx_spectrum_view();
+
+    const rx_spectrum_request &request(void) const { return d_req; }
+    void make_plan(void);
+
+protected:
+    unsigned int compute_power(std::vector<float> &pwr, bool new_only);
+
+private:
+    rx_spectrum_request             d_req;
+    const sample_ring<gr_complex>  &d_ring;         /*! Samples of the owner. */
+    boost::shared_mutex            &d_ring_mutex;   /*! Held while reading d_ring. */
+    boost::mutex                    d_fft_mutex;    /*! Protects d_fft. */
+    gr::fft::fft_complex           *d_fft;          /*! FFT object (NULL until planned). */
+    fft_window_sptr                 d_window;       /*! FFT window taps. */
+    uint64_t                        d_last_written; /*! Ring position of the last FFT. */
+};
+
+typedef boost::shared_ptr<rx_spectrum_view> rx_spectrum_view_sptr;
 
 class rx_fft_c;
 class rx_fft_f;
@@ -56,14 +175,24 @@ rx_fft_c_sptr make_rx_fft_c(unsigned int fftsize=4096, int wintype=gr::filter::f
  *
  * This block is used to compute the FFT of the received spectrum.
  *
- * The samples are collected in a cicular buffer with size FFT_SIZE.
- * When the GUI asks for a new set of FFT data via get_fft_data() an FFT
- * will be performed on the data stored in the circular buffer - assuming
- * of course that the buffer contains at least fftsize samples.
+ * The samples are collected in a lock-free ring buffer (see sample_ring).
+ * The FFT is performed on the last fftsize samples when a new power spectrum
+ * frame is computed, i.e. by the spectrum worker or by get_spectrum(), see
+ * rx_spectrum. Computing the FFT never blocks work(), so a slow consumer can
+ * not stall the flow graph. Optionally the power spectrum is computed by a Welch
+ * estimator that averages overlapping segments of all incoming samples
+ * instead of only the last fftsize samples, see set_welch().
+ *
+ * Other users of the spectrum (remote clients, loggers, detectors) register
+ * as consumers with their own FFT size, window, averaging and frame rate
+ * using add_consumer(). Each consumer is served by an rx_spectrum_view
+ * reading the same ring buffer, and consumers with identical settings share
+ * one view, so they neither change the spectrum seen by the operator nor
+ * add a second FFT of the same samples.
  *
  * \note Uses code from qtgui_sink_c
  */
-class rx_fft_c : public gr::sync_block
+class rx_fft_c : public gr::sync_block, public rx_spectrum
 {
     friend rx_fft_c_sptr make_rx_fft_c(unsigned int fftsize, int wintype);
 
@@ -77,26 +206,66 @@ public:
              gr_vector_const_void_star &input_items,
              gr_vector_void_star &output_items);
 
-    void get_fft_data(std::complex<float>* fftPoints, unsigned int &fftSize);
-
     void set_window_type(int wintype);
     int  get_window_type();
 
     void set_fft_size(unsigned int fftsize);
     unsigned int get_fft_size();
 
+    void set_fft_threads(unsigned int nthreads);
+
+    void set_welch(float overlap, float budget);
+    float get_welch_budget(void) const { return d_welch_budget; }
+    float get_welch_coverage(void);
+
+    int  add_consumer(const rx_spectrum_request &req);
+    void remove_consumer(int id);
+    bool get_consumer_spectrum(int id, float *pwr, float *avg,
+                               unsigned int &fftSize);
+    unsigned int get_num_views(void);
+
 private:
     unsigned int d_fftsize;   /*! Current FFT size. */
     int          d_wintype;   /*! Current window type. */
 
-    boost::mutex d_mutex;  /*! Used to lock FFT output buffer. */
+    welch_estimator *d_welch;       /*! Welch estimator (NULL if disabled). */
+    float        d_welch_overlap;   /*! Welch segment overlap. */
+    float        d_welch_budget;    /*! Welch CPU budget (0 = disabled). */
+    bool         d_welch_pending;   /*! The plan thread must create the estimator. */
+    unsigned int d_ring_gen;        /*! Incremented by reset_ring(). */
 
-    gr::fft::fft_complex    *d_fft;    /*! FFT object. */
-    std::vector<float>  d_window; /*! FFT window taps. */
+    boost::mutex d_mutex;       /*! Used to lock FFT output buffer. */
+    boost::shared_mutex d_ring_mutex; /*! Held exclusively while the ring buffer is resized. */
 
-    boost::circular_buffer<gr_complex> d_cbuf; /*! buffer to accumulate samples. */
+    gr::fft::fft_complex    *d_fft;    /*! FFT object. */
+    fft_window_sptr     d_window; /*! FFT window taps (normalized). */
+
+    sample_ring<gr_complex> d_ring; /*! buffer to accumulate samples. */
+    uint64_t     d_last_written;    /*! Ring position of the last FFT. */
+
+    boost::mutex d_consumer_mutex;  /*! Protects the consumer list. */
+    std::map<int, rx_spectrum_view_sptr> d_consumers; /*! Views by consumer ID. */
+    int          d_next_consumer;   /*! ID of the next consumer. */
+    unsigned int d_consumer_size;   /*! Largest FFT size of the consumers. */
+
+    boost::mutex  d_plan_mutex;     /*! Protects the plan settings and d_plan_views. */
+    boost::thread d_plan_thread;    /*! Creates plans for new FFT sizes. */
+    unsigned int  d_plan_size;      /*! Requested FFT size. */
+    unsigned int  d_plan_threads;   /*! Requested number of FFT threads. */
+    unsigned int  d_fft_threads;    /*! Threads used by the current plan. */
+    bool          d_planning;       /*! Whether the plan thread is running. */
+    std::vector<rx_spectrum_view_sptr> d_plan_views; /*! Views waiting for a plan. */
+
+    void do_fft(unsigned int size);
+    void make_window(void);
+    void reset_ring(void);
+    void start_planning(void);
+    unsigned int plan_threads(unsigned int size) const;
+    void plan_thread(void);
+    bool make_welch(boost::mutex::scoped_lock &plan_lock);
 
-    void do_fft(const gr_complex *data_in, unsigned int size);
+protected:
+    unsigned int compute_power(std::vector<float> &pwr, bool new_only);
 
 };
 
@@ -116,16 +285,17 @@ rx_fft_f_sptr make_rx_fft_f(unsigned int fftsize=1024, int wintype=gr::filter::f
  *  \ingroup DSP
  *
  * This block is used to compute the FFT of the audio spectrum or anything
- * else where real FFT is useful.
+ * else where real FFT is useful. Since the input is real, only the
+ * fftsize/2 + 1 bins from DC to half the sample rate are computed.
  *
- * The samples are collected in a cicular buffer with size FFT_SIZE.
- * When the GUI asks for a new set of FFT data using get_fft_data() an FFT
- * will be performed on the data stored in the circular buffer - assuming
- * that the buffer contains at least fftsize samples.
+ * The samples are collected in a lock-free ring buffer (see sample_ring).
+ * The FFT is performed on the last fftsize samples when a new power spectrum
+ * frame is computed; the power spectrum is available using get_spectrum(),
+ * see rx_spectrum.
  *
  * \note Uses code from qtgui_sink_f
  */
-class rx_fft_f : public gr::sync_block
+class rx_fft_f : public gr::sync_block, public rx_spectrum
 {
     friend rx_fft_f_sptr make_rx_fft_f(unsigned int fftsize, int wintype);
 
@@ -139,8 +309,6 @@ public:
              gr_vector_const_void_star &input_items,
              gr_vector_void_star &output_items);
 
-    void get_fft_data(std::complex<float>* fftPoints, unsigned int &fftSize);
-
     void set_window_type(int wintype);
     int  get_window_type();
 
@@ -151,14 +319,19 @@ private:
     unsigned int d_fftsize;   /*! Current FFT size. */
     int          d_wintype;   /*! Current window type. */
 
-    boost::mutex d_mutex;  /*! Used to lock FFT output buffer. */
+    boost::mutex d_mutex;       /*! Used to lock FFT output buffer. */
+    boost::mutex d_ring_mutex;  /*! Held while the ring buffer is resized. */
 
-    gr::fft::fft_complex    *d_fft;    /*! FFT object. */
-    std::vector<float>  d_window; /*! FFT window taps. */
+    gr::fft::fft_real_fwd   *d_fft;    /*! FFT object. */
+    fft_window_sptr     d_window; /*! FFT window taps (normalized). */
 
-    boost::circular_buffer<float> d_cbuf; /*! buffer to accumulate samples. */
+    sample_ring<float>  d_ring;   /*! buffer to accumulate samples. */
+    uint64_t     d_last_written;  /*! Ring position of the last FFT. */
 
-    void do_fft(const float *data_in, unsigned int size);
+    void do_fft(unsigned int size);
+
+protected:
+    unsigned int compute_power(std::vector<float> &pwr, bool new_only);
 
 };
 
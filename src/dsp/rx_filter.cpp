@@ -72,6 +72,12 @@ rx_filter::~rx_filter ()
 
 }
 
+/*! \brief Append the performance counters of the internal blocks. */
+void rx_filter::get_perf_stats(block_perf_list &stats, const std::string &prefix) const
+{
+    block_perf_add(stats, prefix + "/bpf", d_bpf);
+}
+
 void rx_filter::set_param(double low, double high, double trans_width)
 {
     d_trans_width = trans_width;
@@ -115,15 +121,16 @@ void rx_filter::set_cw_offset(double offset)
  * Create a new instance of rx_xlating_filter and return
  * a boost shared_ptr. This is effectively the public constructor.
  */
-rx_xlating_filter_sptr make_rx_xlating_filter(double sample_rate, double center, double low, double high, double trans_width)
+rx_xlating_filter_sptr make_rx_xlating_filter(double sample_rate, double center, double low, double high, double trans_width, unsigned int decim)
 {
-    return gnuradio::get_initial_sptr(new rx_xlating_filter(sample_rate, center, low, high, trans_width));
+    return gnuradio::get_initial_sptr(new rx_xlating_filter(sample_rate, center, low, high, trans_width, decim));
 }
 
-rx_xlating_filter::rx_xlating_filter(double sample_rate, double center, double low, double high, double trans_width)
+rx_xlating_filter::rx_xlating_filter(double sample_rate, double center, double low, double high, double trans_width, unsigned int decim)
     : gr::hier_block2 ("rx_xlating_filter",
                       gr::io_signature::make (MIN_IN, MAX_IN, sizeof (gr_complex)),
                       gr::io_signature::make (MIN_OUT, MAX_OUT, sizeof (gr_complex))),
+      d_decim(decim),
       d_sample_rate(sample_rate),
       d_center(center),
       d_low(low),
@@ -134,7 +141,7 @@ rx_xlating_filter::rx_xlating_filter(double sample_rate, double center, double l
     d_taps = gr::filter::firdes::complex_band_pass(1.0, d_sample_rate, -d_high, -d_low, d_trans_width);
 
     /* create band pass filter */
-    d_bpf = gr::filter::freq_xlating_fir_filter_ccc::make(1, d_taps, d_center, d_sample_rate);
+    d_bpf = gr::filter::freq_xlating_fir_filter_ccc::make(d_decim, d_taps, d_center, d_sample_rate);
 
     /* connect filter */
     connect(self(), 0, d_bpf, 0);
@@ -147,6 +154,12 @@ rx_xlating_filter::~rx_xlating_filter()
 
 }
 
+/*! \brief Append the performance counters of the internal blocks. */
+void rx_xlating_filter::get_perf_stats(block_perf_list &stats, const std::string &prefix) const
+{
+    block_perf_add(stats, prefix + "/bpf", d_bpf);
+}
+
 
 void rx_xlating_filter::set_offset(double center)
 {
@@ -178,3 +191,81 @@ void rx_xlating_filter::set_param(double center, double low, double high, double
     set_param(low, high, trans_width);
 }
 
+
+/*! \brief Configure the filter as the input stage of a channel.
+ *  \param sample_rate The input sample rate.
+ *  \param min_out_rate The minimum output sample rate.
+ *
+ * Selects the largest decimation that keeps the output rate at or above
+ * min_out_rate and generates anti-alias taps for it: the pass band is
+ * +/- 0.4 * output rate and the transition band is allowed to alias onto
+ * itself, since the channel filter in the demodulator removes it anyway.
+ *
+ * The frequency translation is done by rotating the taps and the output, so
+ * the mixing runs at the decimated rate and changing the offset only
+ * updates the phase increment of the rotator.
+ *
+ * If the decimation changes the internal filter is replaced; when the filter
+ * is part of a running flow graph the caller must hold the top block lock.
+ */
+void rx_xlating_filter::set_channel_rate(double sample_rate, double min_out_rate)
+{
+    unsigned int decim = channel_decim(sample_rate, min_out_rate);
+    double out_rate;
+
+    out_rate = sample_rate / decim;
+    d_low = -0.4 * out_rate;
+    d_high = 0.4 * out_rate;
+    d_trans_width = 0.2 * out_rate;
+
+    if (decim != d_decim || sample_rate != d_sample_rate)
+    {
+        d_decim = decim;
+        d_sample_rate = sample_rate;
+        rebuild();
+    }
+    else
+    {
+        set_param(d_low, d_high, d_trans_width);
+    }
+}
+
+
+/*! \brief Check whether set_channel_rate() would replace the internal filter.
+ *  \param sample_rate The input sample rate.
+ *  \param min_out_rate The minimum output sample rate.
+ *  \return true if the decimation or the input rate changes, i.e. the caller
+ *          must hold the top block lock while calling set_channel_rate().
+ */
+bool rx_xlating_filter::channel_rate_needs_rebuild(double sample_rate, double min_out_rate) const
+{
+    return channel_decim(sample_rate, min_out_rate) != d_decim ||
+           sample_rate != d_sample_rate;
+}
+
+/*! \brief The largest decimation that keeps the output rate at or above min_out_rate. */
+unsigned int rx_xlating_filter::channel_decim(double sample_rate, double min_out_rate)
+{
+    if (sample_rate > min_out_rate)
+        return (unsigned int) std::floor(sample_rate / min_out_rate);
+
+    return 1;
+}
+
+/*! \brief Replace the internal filter, e.g. after the decimation changed. */
+void rx_xlating_filter::rebuild(void)
+{
+    disconnect(self(), 0, d_bpf, 0);
+    disconnect(d_bpf, 0, self(), 0);
+
+    d_taps = gr::filter::firdes::complex_band_pass(1.0, d_sample_rate, -d_high, -d_low, d_trans_width);
+    d_bpf = gr::filter::freq_xlating_fir_filter_ccc::make(d_decim, d_taps, d_center, d_sample_rate);
+
+#ifndef QT_NO_DEBUG_OUTPUT
+    std::cout << "Channel input: " << d_sample_rate << " / " << d_decim
+              << "  Taps: " << d_taps.size() << std::endl;
+#endif
+
+    connect(self(), 0, d_bpf, 0);
+    connect(d_bpf, 0, self(), 0);
+}
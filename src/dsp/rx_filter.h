@@ -26,6 +26,7 @@
 #include <gnuradio/hier_block2.h>
 #include <gnuradio/filter/fir_filter_ccc.h>
 #include <gnuradio/filter/freq_xlating_fir_filter_ccc.h>
+#include "dsp/block_perf.h"
 
 
 #define RX_FILTER_MIN_WIDTH 100  /*! Minimum width of filter */
@@ -71,6 +72,7 @@ class rx_filter : public gr::hier_block2
 public:
     rx_filter(double sample_rate=96000.0, double low=-5000.0, double high=5000.0, double trans_width=1000.0); // FIXME: should be private
     ~rx_filter();
+    void get_perf_stats(block_perf_list &stats, const std::string &prefix) const;
 
     void set_param(double low, double high, double trans_width);
     void set_cw_offset(double offset);
@@ -94,6 +96,7 @@ private:
  *  \param low The lower limit of the bandpass filter.
  *  \param high The upper limit of the filter.
  *  \param trans_width The width of the transition band from
+ *  \param decim The decimation factor.
  *
  * This is effectively the public constructor. To avoid accidental use
  * of raw pointers, rx_filter's constructor is private.
@@ -103,7 +106,8 @@ rx_xlating_filter_sptr make_rx_xlating_filter(double sample_rate,
                                               double center=0.0,
                                               double low=-5000.0,
                                               double high=5000.0,
-                                              double trans_width=1000.0);
+                                              double trans_width=1000.0,
+                                              unsigned int decim=1);
 
 
 /*! \brief Frequency translating band-pass filter with complex taps.
@@ -121,23 +125,39 @@ rx_xlating_filter_sptr make_rx_xlating_filter(double sample_rate,
  * performed by the accessors (though the taps generator from gr::filter::firdes does perform
  * some sanity checks and throws std::out_of_range in case of bad parameter).
  *
+ * The filter can also decimate, in which case it is used as the input stage
+ * of a receiver channel: the band pass only needs to protect the channel
+ * from aliasing and the mixing is done at the decimated rate, see
+ * set_channel_rate().
+ *
  * \note In order to have proper LSB/USB, we must exchange low and high and reverse their sign?
  */
 class rx_xlating_filter : public gr::hier_block2
 {
 
 public:
-    rx_xlating_filter(double sample_rate=96000.0, double center=0.0, double low=-5000.0, double high=5000.0, double trans_width=1000.0); // FIXME: should be private
+    rx_xlating_filter(double sample_rate=96000.0, double center=0.0, double low=-5000.0, double high=5000.0, double trans_width=1000.0, unsigned int decim=1); // FIXME: should be private
     ~rx_xlating_filter();
+    void get_perf_stats(block_perf_list &stats, const std::string &prefix) const;
 
     void set_offset(double center);
     void set_param(double low, double high, double trans_width);
     void set_param(double center, double low, double high, double trans_width);
 
+    void set_channel_rate(double sample_rate, double min_out_rate);
+    bool channel_rate_needs_rebuild(double sample_rate, double min_out_rate) const;
+    unsigned int get_decim(void) const { return d_decim; }
+    double get_output_rate(void) const { return d_sample_rate / d_decim; }
+
+private:
+    static unsigned int channel_decim(double sample_rate, double min_out_rate);
+    void rebuild(void);
+
 private:
     std::vector<gr_complex> d_taps;
     gr::filter::freq_xlating_fir_filter_ccc::sptr d_bpf;
 
+    unsigned int d_decim;
     double d_sample_rate;
     double d_center;
     double d_low;
@@ -0,0 +1,189 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+
+/*! \brief Single producer, single consumer sample ring.
+ *  \ingroup DSP
+ *
+ * The producer appends blocks of samples using write() and never waits for
+ * the consumer; old samples are simply overwritten. The consumer takes a
+ * copy of the most recent samples using read_last(), or of the samples at a
+ * given position using read().
+ *
+ * Neither side takes a lock. The producer announces the range it is about
+ * to overwrite before copying and publishes the new end afterwards. The
+ * consumer copies the samples and then checks whether the producer has
+ * started overwriting them in the meantime, in which case the copy is
+ * repeated. The capacity is at least twice the largest read, so this only
+ * happens when the consumer is preempted for a long time; after a few
+ * attempts read_last() gives up rather than wait.
+ *
+ * resize() and clear() are not thread safe; the owner must make sure that
+ * neither side is using the ring while they are called.
+ *
+ * T must be trivially copyable.
+ */
+template <class T>
+class sample_ring
+{
+public:
+    sample_ring() : d_mask(0), d_reserved(0), d_written(0) {}
+
+    /*! \brief Allocate the ring and discard all samples.
+     *  \param max_read The largest number of samples passed to read_last().
+     */
+    void resize(size_t max_read)
+    {
+        size_t capacity = 1;
+
+        while (capacity < 2 * max_read)
+            capacity <<= 1;
+
+        d_buf.assign(capacity, T());
+        d_mask = capacity - 1;
+        clear();
+    }
+
+    /*! \brief Discard all samples. */
+    void clear(void)
+    {
+        d_reserved.store(0, std::memory_order_relaxed);
+        d_written.store(0, std::memory_order_release);
+    }
+
+    size_t capacity(void) const { return d_buf.size(); }
+
+    /*! \brief Total number of samples written since the last clear(). */
+    uint64_t written(void) const
+    {
+        return d_written.load(std::memory_order_acquire);
+    }
+
+    /*! \brief Append samples (producer side).
+     *  \param data The samples.
+     *  \param num The number of samples.
+     */
+    void write(const T *data, size_t num)
+    {
+        uint64_t    end = d_written.load(std::memory_order_relaxed) + num;
+        uint64_t    start;
+
+        if (d_buf.empty())
+            return;
+
+        // only the last capacity() samples can be kept
+        if (num > d_buf.size())
+        {
+            data += num - d_buf.size();
+            num = d_buf.size();
+        }
+        start = end - num;
+
+        d_reserved.store(end, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        copy_in(start, data, num);
+        d_written.store(end, std::memory_order_release);
+    }
+
+    /*! \brief Copy the most recent samples (consumer side).
+     *  \param out The output buffer.
+     *  \param num The number of samples to copy, at most half the capacity.
+     *  \return true if out contains the last num samples, false if there are
+     *          not enough samples or a consistent copy could not be made.
+     */
+    bool read_last(T *out, size_t num) const
+    {
+        uint64_t    end;
+        int         tries;
+
+        if (2 * num > d_buf.size())
+            return false;
+
+        for (tries = 0; tries < 3; tries++)
+        {
+            end = d_written.load(std::memory_order_acquire);
+            if (end < num)
+                return false;
+
+            if (read(end - num, out, num))
+                return true;
+        }
+
+        return false;
+    }
+
+    /*! \brief Copy samples from a given position (consumer side).
+     *  \param pos The position of the first sample (see written()).
+     *  \param out The output buffer.
+     *  \param num The number of samples to copy.
+     *  \return true if out contains the samples, false if they have not
+     *          been written yet or have been overwritten.
+     */
+    bool read(uint64_t pos, T *out, size_t num) const
+    {
+        if (pos + num > d_written.load(std::memory_order_acquire) ||
+            num > d_buf.size())
+            return false;
+
+        copy_out(out, pos, num);
+
+        // valid unless the producer has reached the copied samples
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return d_reserved.load(std::memory_order_relaxed) <= pos + d_buf.size();
+    }
+
+private:
+    void copy_in(uint64_t pos, const T *data, size_t num)
+    {
+        size_t  idx = pos & d_mask;
+        size_t  first = std::min(num, d_buf.size() - idx);
+
+        memcpy(&d_buf[idx], data, first * sizeof(T));
+        if (num > first)
+            memcpy(&d_buf[0], data + first, (num - first) * sizeof(T));
+    }
+
+    void copy_out(T *out, uint64_t pos, size_t num) const
+    {
+        size_t  idx = pos & d_mask;
+        size_t  first = std::min(num, d_buf.size() - idx);
+
+        memcpy(out, &d_buf[idx], first * sizeof(T));
+        if (num > first)
+            memcpy(out + first, &d_buf[0], (num - first) * sizeof(T));
+    }
+
+    std::vector<T>          d_buf;      /*!< Sample storage, power of two. */
+    size_t                  d_mask;     /*!< Index mask (capacity - 1). */
+    std::atomic<uint64_t>   d_reserved; /*!< End of the samples being written. */
+    std::atomic<uint64_t>   d_written;  /*!< End of the samples written. */
+};
+
+#endif // SAMPLE_RING_H
@@ -0,0 +1,356 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <stdint.h>
+#include <string.h>
+#include "dsp/spectrum_kernel.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SPECTRUM_NEON
+#endif
+
+/* 10*log10(2): converts log2 to dB */
+#define DB_PER_LOG2     3.01029995664f
+
+/* Smallest power converted; results in -200 dB. */
+#define POWER_FLOOR     1.0e-20f
+
+/* Minimax polynomial for log2(m) / (m - 1) on [1, 2) */
+#define LOG2_C0     3.1157899f
+#define LOG2_C1    -3.3241990f
+#define LOG2_C2     2.5988452f
+#define LOG2_C3    -1.2315303f
+#define LOG2_C4     3.1821337e-1f
+#define LOG2_C5    -3.4436006e-2f
+
+/* log2(x) for normal, positive x: exponent plus polynomial of the mantissa */
+static inline float fast_log2(float x)
+{
+    uint32_t    bits;
+    float       m, p;
+    int         e;
+
+    memcpy(&bits, &x, sizeof(bits));
+    e = (int)(bits >> 23) - 127;
+    bits = (bits & 0x007fffff) | 0x3f800000;
+    memcpy(&m, &bits, sizeof(m));
+
+    p = LOG2_C5;
+    p = p * m + LOG2_C4;
+    p = p * m + LOG2_C3;
+    p = p * m + LOG2_C2;
+    p = p * m + LOG2_C1;
+    p = p * m + LOG2_C0;
+
+    return p * (m - 1.0f) + (float)e;
+}
+
+void spectrum_db_avg_generic(const float *pwr, unsigned int num, float scale,
+                             float avg, float *db, const float *iir_in,
+                             float *iir_out)
+{
+    unsigned int i;
+
+    for (i = 0; i < num; i++)
+    {
+        float p = scale * pwr[i];
+
+        db[i] = DB_PER_LOG2 * fast_log2(p > POWER_FLOOR ? p : POWER_FLOOR);
+        if (iir_in)
+            iir_out[i] = iir_in[i] + avg * (db[i] - iir_in[i]);
+        else
+            iir_out[i] = db[i];
+    }
+}
+
+/* Largest of m and in[0] ... in[num - 1]. */
+static inline float max_generic(const float *in, unsigned int num, float m)
+{
+    unsigned int i;
+
+    for (i = 0; i < num; i++)
+        if (in[i] > m)
+            m = in[i];
+
+    return m;
+}
+
+#if defined(__SSE2__)
+
+void spectrum_apply_window(gr_complex *buf, const float *window,
+                           unsigned int num)
+{
+    float          *dst = (float *) buf;
+    unsigned int    i;
+
+    for (i = 0; i + 4 <= num; i += 4)
+    {
+        __m128 w = _mm_loadu_ps(window + i);
+
+        // each tap is applied to re and im
+        _mm_storeu_ps(dst + 2 * i,
+                      _mm_mul_ps(_mm_loadu_ps(dst + 2 * i), _mm_unpacklo_ps(w, w)));
+        _mm_storeu_ps(dst + 2 * i + 4,
+                      _mm_mul_ps(_mm_loadu_ps(dst + 2 * i + 4), _mm_unpackhi_ps(w, w)));
+    }
+
+    for (; i < num; i++)
+        buf[i] *= window[i];
+}
+
+void spectrum_power(const gr_complex *in, float *pwr, unsigned int num)
+{
+    const float    *src = (const float *) in;
+    unsigned int    i;
+
+    for (i = 0; i + 4 <= num; i += 4)
+    {
+        __m128 a = _mm_loadu_ps(src + 2 * i);       // re0 im0 re1 im1
+        __m128 b = _mm_loadu_ps(src + 2 * i + 4);   // re2 im2 re3 im3
+
+        a = _mm_mul_ps(a, a);
+        b = _mm_mul_ps(b, b);
+        _mm_storeu_ps(pwr + i,
+                      _mm_add_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)),
+                                 _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+    }
+
+    for (; i < num; i++)
+        pwr[i] = in[i].real() * in[i].real() + in[i].imag() * in[i].imag();
+}
+
+void spectrum_db_avg(const float *pwr, unsigned int num, float scale,
+                     float avg, float *db, const float *iir_in, float *iir_out)
+{
+    const __m128i   mant_mask = _mm_set1_epi32(0x007fffff);
+    const __m128i   one_bits = _mm_set1_epi32(0x3f800000);
+    const __m128i   bias = _mm_set1_epi32(127);
+    const __m128    one = _mm_set1_ps(1.0f);
+    const __m128    vscale = _mm_set1_ps(scale);
+    const __m128    vfloor = _mm_set1_ps(POWER_FLOOR);
+    const __m128    vdb = _mm_set1_ps(DB_PER_LOG2);
+    const __m128    vavg = _mm_set1_ps(avg);
+    unsigned int    i;
+
+    for (i = 0; i + 4 <= num; i += 4)
+    {
+        __m128  x = _mm_max_ps(_mm_mul_ps(_mm_loadu_ps(pwr + i), vscale), vfloor);
+        __m128i bits = _mm_castps_si128(x);
+        __m128  e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), bias));
+        __m128  m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, mant_mask), one_bits));
+        __m128  p, d;
+
+        p = _mm_set1_ps(LOG2_C5);
+        p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(LOG2_C4));
+        p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(LOG2_C3));
+        p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(LOG2_C2));
+        p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(LOG2_C1));
+        p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(LOG2_C0));
+        d = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(p, _mm_sub_ps(m, one)), e), vdb);
+        _mm_storeu_ps(db + i, d);
+
+        if (iir_in)
+        {
+            __m128 a = _mm_loadu_ps(iir_in + i);
+
+            d = _mm_add_ps(a, _mm_mul_ps(vavg, _mm_sub_ps(d, a)));
+        }
+        _mm_storeu_ps(iir_out + i, d);
+    }
+
+    spectrum_db_avg_generic(pwr + i, num - i, scale, avg, db + i,
+                            iir_in ? iir_in + i : 0, iir_out + i);
+}
+
+void spectrum_max_ranges(const float *in, const unsigned int *edges,
+                         unsigned int num, float *out)
+{
+    unsigned int    i, k, end;
+
+    for (k = 0; k < num; k++)
+    {
+        float   m = in[edges[k]];
+
+        end = edges[k + 1];
+        i = edges[k];
+        if (end - i >= 4)
+        {
+            __m128 v = _mm_loadu_ps(in + i);
+
+            for (i += 4; i + 4 <= end; i += 4)
+                v = _mm_max_ps(v, _mm_loadu_ps(in + i));
+
+            // horizontal maximum of the four lanes
+            v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+            v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+            m = _mm_cvtss_f32(v);
+        }
+        out[k] = max_generic(in + i, end - i, m);
+    }
+}
+
+#elif defined(SPECTRUM_NEON)
+
+void spectrum_apply_window(gr_complex *buf, const float *window,
+                           unsigned int num)
+{
+    float          *dst = (float *) buf;
+    unsigned int    i;
+
+    for (i = 0; i + 4 <= num; i += 4)
+    {
+        float32x4_t     w = vld1q_f32(window + i);
+        float32x4x2_t   x = vld2q_f32(dst + 2 * i);
+
+        x.val[0] = vmulq_f32(x.val[0], w);
+        x.val[1] = vmulq_f32(x.val[1], w);
+        vst2q_f32(dst + 2 * i, x);
+    }
+
+    for (; i < num; i++)
+        buf[i] *= window[i];
+}
+
+void spectrum_power(const gr_complex *in, float *pwr, unsigned int num)
+{
+    const float    *src = (const float *) in;
+    unsigned int    i;
+
+    for (i = 0; i + 4 <= num; i += 4)
+    {
+        float32x4x2_t x = vld2q_f32(src + 2 * i);   // de-interleaved re, im
+
+        vst1q_f32(pwr + i, vmlaq_f32(vmulq_f32(x.val[0], x.val[0]),
+                                     x.val[1], x.val[1]));
+    }
+
+    for (; i < num; i++)
+        pwr[i] = in[i].real() * in[i].real() + in[i].imag() * in[i].imag();
+}
+
+void spectrum_db_avg(const float *pwr, unsigned int num, float scale,
+                     float avg, float *db, const float *iir_in, float *iir_out)
+{
+    const uint32x4_t    mant_mask = vdupq_n_u32(0x007fffff);
+    const uint32x4_t    one_bits = vdupq_n_u32(0x3f800000);
+    const int32x4_t     bias = vdupq_n_s32(127);
+    const float32x4_t   one = vdupq_n_f32(1.0f);
+    const float32x4_t   vfloor = vdupq_n_f32(POWER_FLOOR);
+    unsigned int        i;
+
+    for (i = 0; i + 4 <= num; i += 4)
+    {
+        float32x4_t x = vmaxq_f32(vmulq_n_f32(vld1q_f32(pwr + i), scale), vfloor);
+        uint32x4_t  bits = vreinterpretq_u32_f32(x);
+        float32x4_t e = vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), bias));
+        float32x4_t m = vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, mant_mask), one_bits));
+        float32x4_t p, d;
+
+        p = vdupq_n_f32(LOG2_C5);
+        p = vmlaq_f32(vdupq_n_f32(LOG2_C4), p, m);
+        p = vmlaq_f32(vdupq_n_f32(LOG2_C3), p, m);
+        p = vmlaq_f32(vdupq_n_f32(LOG2_C2), p, m);
+        p = vmlaq_f32(vdupq_n_f32(LOG2_C1), p, m);
+        p = vmlaq_f32(vdupq_n_f32(LOG2_C0), p, m);
+        d = vmulq_n_f32(vmlaq_f32(e, p, vsubq_f32(m, one)), DB_PER_LOG2);
+        vst1q_f32(db + i, d);
+
+        if (iir_in)
+        {
+            float32x4_t a = vld1q_f32(iir_in + i);
+
+            d = vmlaq_n_f32(a, vsubq_f32(d, a), avg);
+        }
+        vst1q_f32(iir_out + i, d);
+    }
+
+    spectrum_db_avg_generic(pwr + i, num - i, scale, avg, db + i,
+                            iir_in ? iir_in + i : 0, iir_out + i);
+}
+
+void spectrum_max_ranges(const float *in, const unsigned int *edges,
+                         unsigned int num, float *out)
+{
+    unsigned int    i, k, end;
+
+    for (k = 0; k < num; k++)
+    {
+        float   m = in[edges[k]];
+
+        end = edges[k + 1];
+        i = edges[k];
+        if (end - i >= 4)
+        {
+            float32x4_t v = vld1q_f32(in + i);
+            float32x2_t r;
+
+            for (i += 4; i + 4 <= end; i += 4)
+                v = vmaxq_f32(v, vld1q_f32(in + i));
+
+            // horizontal maximum of the four lanes
+            r = vpmax_f32(vget_low_f32(v), vget_high_f32(v));
+            r = vpmax_f32(r, r);
+            m = vget_lane_f32(r, 0);
+        }
+        out[k] = max_generic(in + i, end - i, m);
+    }
+}
+
+#else
+
+void spectrum_apply_window(gr_complex *buf, const float *window,
+                           unsigned int num)
+{
+    unsigned int i;
+
+    for (i = 0; i < num; i++)
+        buf[i] *= window[i];
+}
+
+void spectrum_power(const gr_complex *in, float *pwr, unsigned int num)
+{
+    unsigned int i;
+
+    for (i = 0; i < num; i++)
+        pwr[i] = in[i].real() * in[i].real() + in[i].imag() * in[i].imag();
+}
+
+void spectrum_db_avg(const float *pwr, unsigned int num, float scale,
+                     float avg, float *db, const float *iir_in, float *iir_out)
+{
+    spectrum_db_avg_generic(pwr, num, scale, avg, db, iir_in, iir_out);
+}
+
+void spectrum_max_ranges(const float *in, const unsigned int *edges,
+                         unsigned int num, float *out)
+{
+    unsigned int k;
+
+    for (k = 0; k < num; k++)
+        out[k] = max_generic(in + edges[k], edges[k + 1] - edges[k],
+                             in[edges[k]]);
+}
+
+#endif
@@ -0,0 +1,82 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef SPECTRUM_KERNEL_H
+#define SPECTRUM_KERNEL_H
+
+#include <gnuradio/gr_complex.h>
+
+/*! \brief Apply a window to complex samples.
+ *  \param buf The samples, multiplied in place.
+ *  \param window The window taps (see fft_window_get()).
+ *  \param num The number of samples.
+ */
+void spectrum_apply_window(gr_complex *buf, const float *window,
+                           unsigned int num);
+
+/*! \brief Power of complex FFT bins.
+ *  \param in The FFT output.
+ *  \param pwr The power |X|^2 of each bin (output).
+ *  \param num The number of bins.
+ */
+void spectrum_power(const gr_complex *in, float *pwr, unsigned int num);
+
+/*! \brief Convert power to dB and update the exponential average.
+ *  \param pwr The power of each bin.
+ *  \param num The number of bins.
+ *  \param scale The normalisation applied to pwr before the conversion.
+ *  \param avg The averaging factor of the IIR (1 = no averaging).
+ *  \param db The power in dB (output), 10*log10(max(scale*pwr, 1e-20)).
+ *  \param iir_in The previous average, or NULL to restart the average.
+ *  \param iir_out The new average (output), may be the same as iir_in.
+ *
+ * Spectrum frames are converted in two calls, one per half, so the FFT
+ * shift does not need an index calculation per bin. The logarithm is a
+ * polynomial approximation within 0.001 dB of log10f(), evaluated four
+ * bins at a time with SSE2 or NEON where available.
+ */
+void spectrum_db_avg(const float *pwr, unsigned int num, float scale,
+                     float avg, float *db, const float *iir_in, float *iir_out);
+
+/*! \brief Portable version of spectrum_db_avg().
+ *
+ * Same arguments and results as spectrum_db_avg() without SIMD; used for
+ * the remaining bins and by the benchmark.
+ */
+void spectrum_db_avg_generic(const float *pwr, unsigned int num, float scale,
+                             float avg, float *db, const float *iir_in,
+                             float *iir_out);
+
+/*! \brief Largest value in each of a series of adjacent ranges.
+ *  \param in The input values.
+ *  \param edges The num + 1 range boundaries; range k covers
+ *               in[edges[k]] ... in[edges[k + 1] - 1] and must not be empty.
+ *  \param num The number of ranges.
+ *  \param out The maximum of each range (output).
+ *
+ * The plotter uses this to reduce spectra with more bins than pixels to one
+ * value per pixel.
+ */
+void spectrum_max_ranges(const float *in, const unsigned int *edges,
+                         unsigned int num, float *out);
+
+#endif // SPECTRUM_KERNEL_H
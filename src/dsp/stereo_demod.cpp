@@ -167,3 +167,25 @@ stereo_demod::~stereo_demod()
 
 }
 
+/*! \brief Append the performance counters of the internal blocks. */
+void stereo_demod::get_perf_stats(block_perf_list &stats, const std::string &prefix) const
+{
+    block_perf_add(stats, prefix + "/tone", tone);
+    block_perf_add(stats, prefix + "/pll", pll);
+    block_perf_add(stats, prefix + "/subtone", subtone);
+    block_perf_add(stats, prefix + "/lo", lo);
+    block_perf_add(stats, prefix + "/lo2", lo2);
+    block_perf_add(stats, prefix + "/mixer", mixer);
+    lpf0->get_perf_stats(stats, prefix + "/lpf0");
+    audio_rr0->get_perf_stats(stats, prefix + "/audio_rr0");
+    if (d_stereo)
+    {
+        lpf1->get_perf_stats(stats, prefix + "/lpf1");
+        audio_rr1->get_perf_stats(stats, prefix + "/audio_rr1");
+    }
+    block_perf_add(stats, prefix + "/cdp", cdp);
+    block_perf_add(stats, prefix + "/cdm", cdm);
+    block_perf_add(stats, prefix + "/add0", add0);
+    block_perf_add(stats, prefix + "/add1", add1);
+}
+
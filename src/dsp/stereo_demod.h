@@ -37,6 +37,7 @@
 #include <vector>
 #include "dsp/lpf.h"
 #include "dsp/resampler_xx.h"
+#include "dsp/block_perf.h"
 
  
 class stereo_demod;
@@ -76,6 +77,7 @@ protected:
 
 public:
     ~stereo_demod();
+    void get_perf_stats(block_perf_list &stats, const std::string &prefix) const;
 
 private:
     /* GR blocks */
@@ -0,0 +1,116 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <algorithm>
+#include <cstring>
+#include <gnuradio/io_signature.h>
+#include "dsp/stream_selector.h"
+
+
+stream_selector_sptr make_stream_selector(size_t itemsize,
+                                          unsigned int num_groups,
+                                          unsigned int group_size)
+{
+    return gnuradio::get_initial_sptr(new stream_selector(itemsize, num_groups,
+                                                          group_size));
+}
+
+stream_selector::stream_selector(size_t itemsize, unsigned int num_groups,
+                                 unsigned int group_size)
+    : gr::block ("stream_selector",
+          gr::io_signature::make(num_groups * group_size,
+                                 num_groups * group_size, itemsize),
+          gr::io_signature::make(1, group_size, itemsize)),
+      d_itemsize(itemsize),
+      d_num_groups(num_groups),
+      d_group_size(group_size),
+      d_group(0)
+{
+
+}
+
+stream_selector::~stream_selector()
+{
+
+}
+
+/*! \brief Only the selected group is required to have data. */
+void stream_selector::forecast(int noutput_items,
+                               gr_vector_int &ninput_items_required)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    unsigned int i;
+
+    for (i = 0; i < ninput_items_required.size(); i++)
+    {
+        if (i / d_group_size == d_group)
+            ninput_items_required[i] = noutput_items;
+        else
+            ninput_items_required[i] = 0;
+    }
+}
+
+int stream_selector::general_work(int noutput_items,
+                                  gr_vector_int &ninput_items,
+                                  gr_vector_const_void_star &input_items,
+                                  gr_vector_void_star &output_items)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    unsigned int first = d_group * d_group_size;
+    unsigned int i;
+
+    /* the group may have changed since forecast() */
+    for (i = first; i < first + d_group_size; i++)
+        noutput_items = std::min(noutput_items, ninput_items[i]);
+
+    for (i = 0; i < input_items.size(); i++)
+    {
+        if (i >= first && i < first + d_group_size)
+        {
+            /* trailing outputs may be left unconnected */
+            if (i - first < output_items.size())
+                memcpy(output_items[i - first], input_items[i],
+                       noutput_items * d_itemsize);
+            consume(i, noutput_items);
+        }
+        else
+        {
+            /* drop data from the unused inputs */
+            consume(i, ninput_items[i]);
+        }
+    }
+
+    return noutput_items;
+}
+
+/*! \brief Select input group.
+ *
+ * Takes effect with the next call to general_work(); no locking of the flow
+ * graph is needed.
+ */
+void stream_selector::set_group(unsigned int group)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    if (group < d_num_groups)
+        d_group = group;
+}
@@ -0,0 +1,93 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef STREAM_SELECTOR_H
+#define STREAM_SELECTOR_H
+
+#include <gnuradio/block.h>
+#include <boost/thread/mutex.hpp>
+
+
+class stream_selector;
+
+typedef boost::shared_ptr<stream_selector> stream_selector_sptr;
+
+
+/*! \brief Return a shared_ptr to a new instance of stream_selector.
+ *  \param itemsize The size of the stream items.
+ *  \param num_groups The number of input groups.
+ *  \param group_size The number of streams in each group (= outputs).
+ *
+ * This is effectively the public constructor. To avoid accidental use
+ * of raw pointers, the stream_selector constructor is private.
+ */
+stream_selector_sptr make_stream_selector(size_t itemsize,
+                                          unsigned int num_groups,
+                                          unsigned int group_size);
+
+
+/*! \brief Select one of several groups of input streams.
+ *  \ingroup DSP
+ *
+ * The block has num_groups * group_size inputs and up to group_size outputs.
+ * Inputs k * group_size ... (k + 1) * group_size - 1 form group k and the
+ * streams of the selected group are copied to the outputs; streams without
+ * a connected output are discarded.
+ *
+ * Unlike gr::blocks::selector the block does not wait for data on the
+ * inputs that are not selected; whatever arrives there is dropped. This
+ * makes it possible to stop the unused chains completely (e.g. using a
+ * disabled gr::blocks::copy in front of them) and to switch between chains
+ * with set_group() without locking or stopping the flow graph.
+ */
+class stream_selector : public gr::block
+{
+    friend stream_selector_sptr make_stream_selector(size_t itemsize,
+                                                     unsigned int num_groups,
+                                                     unsigned int group_size);
+
+protected:
+    stream_selector(size_t itemsize, unsigned int num_groups,
+                    unsigned int group_size);
+
+public:
+    ~stream_selector();
+
+    void forecast(int noutput_items, gr_vector_int &ninput_items_required);
+
+    int general_work(int noutput_items,
+                     gr_vector_int &ninput_items,
+                     gr_vector_const_void_star &input_items,
+                     gr_vector_void_star &output_items);
+
+    void set_group(unsigned int group);
+    unsigned int get_group(void) const { return d_group; }
+
+private:
+    size_t          d_itemsize;
+    unsigned int    d_num_groups;
+    unsigned int    d_group_size;
+    unsigned int    d_group;        /*!< The selected group. */
+    boost::mutex    d_mutex;        /*!< Protects d_group. */
+};
+
+#endif /* STREAM_SELECTOR_H */
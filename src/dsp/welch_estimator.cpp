@@ -0,0 +1,269 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <math.h>
+#include <algorithm>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include "dsp/spectrum_kernel.h"
+#include "dsp/welch_estimator.h"
+
+
+/*! \brief Create a new Welch estimator.
+ *  \param ring The sample ring to read from.
+ *  \param fftsize The segment length (FFT size).
+ *  \param window The window taps (fftsize taps or empty).
+ *  \param overlap The overlap between segments (0...0.9).
+ *  \param budget The CPU budget in cores (> 0).
+ *
+ * The capacity of the ring should be well above fftsize, otherwise the
+ * estimator will often have to skip samples.
+ *
+ * The constructor creates the FFT plans, which can take a long time, but
+ * does not access the ring. The worker threads are started by start().
+ */
+welch_estimator::welch_estimator(const sample_ring<gr_complex> &ring,
+                                 unsigned int fftsize,
+                                 const std::vector<float> &window,
+                                 float overlap, float budget)
+    : d_ring(ring),
+      d_fftsize(fftsize),
+      d_window(window),
+      d_used(0),
+      d_skipped(0)
+{
+    unsigned int    nthreads = 1;
+    unsigned int    i;
+
+    overlap = std::min(std::max(overlap, 0.0f), 0.9f);
+    d_step = std::max(1u, (unsigned int)(d_fftsize * (1.0f - overlap)));
+    budget = std::max(budget, 0.01f);
+
+    if (d_fftsize >= WELCH_MT_MIN_SIZE)
+    {
+        nthreads = (unsigned int) ceilf(budget);
+        nthreads = std::min(nthreads, std::max(1u, boost::thread::hardware_concurrency()));
+    }
+    d_share = std::min(budget / nthreads, 1.0f);
+    d_pos = 0;
+
+    for (i = 0; i < nthreads; i++)
+    {
+        worker *w = new worker;
+
+        w->fft = new gr::fft::fft_complex(d_fftsize, true);
+        w->acc.assign(d_fftsize, 0.0);
+        w->count = 0;
+        d_workers.push_back(w);
+    }
+}
+
+welch_estimator::~welch_estimator()
+{
+    unsigned int i;
+
+    for (i = 0; i < d_workers.size(); i++)
+        d_workers[i]->thread.interrupt();
+
+    for (i = 0; i < d_workers.size(); i++)
+    {
+        if (d_workers[i]->thread.joinable())
+            d_workers[i]->thread.join();
+        delete d_workers[i]->fft;
+        delete d_workers[i];
+    }
+}
+
+/*! \brief Start the worker threads.
+ *
+ * The estimator starts with the newest samples in the ring. Must only be
+ * called once.
+ */
+void welch_estimator::start(void)
+{
+    unsigned int i;
+
+    d_pos = d_ring.written();
+
+    for (i = 0; i < d_workers.size(); i++)
+        d_workers[i]->thread = boost::thread(&welch_estimator::worker_thread,
+                                             this, d_workers[i]);
+}
+
+/*! \brief Get the average power of the segments processed since the last call.
+ *  \param pwr The power spectrum |X|^2 in FFT order, resized to fftsize.
+ *  \return The number of averaged segments, 0 if no segment has been
+ *          processed (pwr is then undefined).
+ */
+unsigned int welch_estimator::collect(std::vector<float> &pwr)
+{
+    unsigned int    count = 0;
+    unsigned int    i, k;
+
+    pwr.assign(d_fftsize, 0.0);
+
+    for (k = 0; k < d_workers.size(); k++)
+    {
+        worker *w = d_workers[k];
+        boost::mutex::scoped_lock lock(w->mutex);
+
+        if (w->count == 0)
+            continue;
+
+        for (i = 0; i < d_fftsize; i++)
+            pwr[i] += w->acc[i];
+
+        std::fill(w->acc.begin(), w->acc.end(), 0.0);
+        count += w->count;
+        w->count = 0;
+    }
+
+    if (count > 1)
+    {
+        float scale = 1.0 / count;
+
+        for (i = 0; i < d_fftsize; i++)
+            pwr[i] *= scale;
+    }
+
+    return count;
+}
+
+/*! \brief Get the fraction of input samples used since the last call.
+ *  \return The coverage (0...1).
+ */
+float welch_estimator::coverage(void)
+{
+    boost::mutex::scoped_lock lock(d_pos_mutex);
+    float   cov = 1.0;
+
+    if (d_used + d_skipped > 0)
+        cov = (float)d_used / (float)(d_used + d_skipped);
+
+    d_used = 0;
+    d_skipped = 0;
+
+    return cov;
+}
+
+/*! \brief Claim the next segment.
+ *  \param pos The ring position of the segment (output).
+ *  \return true if a segment is available, false if we have to wait for
+ *          new samples.
+ *
+ * If the segment has already been overwritten or is about to be, the
+ * estimator skips ahead to the newest samples.
+ */
+bool welch_estimator::next_segment(uint64_t &pos)
+{
+    boost::mutex::scoped_lock lock(d_pos_mutex);
+    uint64_t written = d_ring.written();
+
+    /* the ring has been cleared */
+    if (written < d_pos)
+        d_pos = written;
+
+    if (d_pos + d_fftsize > written)
+        return false;
+
+    /* leave the producer a margin of one segment */
+    if (written - d_pos > d_ring.capacity() - 2 * d_fftsize)
+    {
+        uint64_t newpos = written - d_fftsize;
+
+        d_skipped += newpos - d_pos;
+        d_pos = newpos;
+    }
+
+    pos = d_pos;
+    d_pos += d_step;
+    d_used += d_step;
+
+    return true;
+}
+
+/*! \brief Worker thread.
+ *
+ * Each worker processes one segment at a time with its own FFT plan and
+ * sleeps whenever it has used up its share of the CPU budget.
+ */
+void welch_estimator::worker_thread(worker *w)
+{
+    boost::posix_time::ptime    start;
+    gr_complex     *buf = w->fft->get_inbuf();
+    const gr_complex *out = w->fft->get_outbuf();
+    double          debt_us = 0.0;   // time to sleep to stay within budget
+    uint64_t        pos;
+    unsigned int    i;
+
+    try
+    {
+        while (true)
+        {
+            boost::this_thread::interruption_point();
+
+            if (!next_segment(pos))
+            {
+                boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+                continue;
+            }
+
+            start = boost::posix_time::microsec_clock::universal_time();
+
+            if (!d_ring.read(pos, buf, d_fftsize))
+            {
+                /* overwritten while copying */
+                boost::mutex::scoped_lock lock(d_pos_mutex);
+                d_used -= std::min(d_used, (uint64_t)d_step);
+                d_skipped += d_step;
+                continue;
+            }
+
+            if (!d_window.empty())
+                spectrum_apply_window(buf, &d_window[0], d_fftsize);
+
+            w->fft->execute();
+
+            {
+                boost::mutex::scoped_lock lock(w->mutex);
+
+                for (i = 0; i < d_fftsize; i++)
+                    w->acc[i] += std::norm(out[i]);
+                w->count++;
+            }
+
+            /* busy for t means idle for t * (1 - share) / share */
+            if (d_share < 1.0)
+            {
+                debt_us += (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds()
+                           * (1.0 - d_share) / d_share;
+                if (debt_us >= 1000.0)
+                {
+                    boost::this_thread::sleep(boost::posix_time::microseconds((int64_t)debt_us));
+                    debt_us = 0.0;
+                }
+            }
+        }
+    }
+    catch (boost::thread_interrupted &)
+    {
+    }
+}
@@ -0,0 +1,97 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef WELCH_ESTIMATOR_H
+#define WELCH_ESTIMATOR_H
+
+#include <gnuradio/fft/fft.h>
+#include <gnuradio/gr_complex.h>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <stdint.h>
+#include <vector>
+#include "dsp/sample_ring.h"
+
+/* FFT size from which the estimator uses more than one thread. */
+#define WELCH_MT_MIN_SIZE 65536
+
+/*! \brief Welch power spectrum estimator.
+ *  \ingroup DSP
+ *
+ * The estimator continuously takes overlapping segments of fftsize samples
+ * from a sample ring, applies the window and accumulates the power of their
+ * FFT. collect() returns the average power of the segments processed since
+ * the previous call, so every sample contributes to the spectrum rather than
+ * only the last fftsize samples before each frame.
+ *
+ * The CPU time is limited by the budget, given in CPU cores: a budget of 0.5
+ * allows the estimator to use half of one core. For large FFT sizes the
+ * segments are processed by up to ceil(budget) threads, each with its own
+ * FFT plan. When the estimator can not keep up with the input, it skips
+ * ahead to the newest samples; coverage() returns the fraction of samples
+ * that has been used.
+ *
+ * The FFT plans are created by the constructor and the threads are started
+ * by start(), so the estimator can be prepared in the background. The ring
+ * must not change while the threads are running.
+ */
+class welch_estimator
+{
+public:
+    welch_estimator(const sample_ring<gr_complex> &ring, unsigned int fftsize,
+                    const std::vector<float> &window, float overlap,
+                    float budget);
+    ~welch_estimator();
+
+    void start(void);
+    unsigned int collect(std::vector<float> &pwr);
+    float coverage(void);
+    unsigned int num_threads(void) const { return d_workers.size(); }
+
+private:
+    /*! \brief State of one worker thread. */
+    struct worker {
+        boost::thread           thread;
+        gr::fft::fft_complex   *fft;      /*!< FFT plan of this thread. */
+        boost::mutex            mutex;    /*!< Protects acc and count. */
+        std::vector<float>      acc;      /*!< Accumulated power. */
+        unsigned int            count;    /*!< Number of accumulated segments. */
+    };
+
+    void worker_thread(worker *w);
+    bool next_segment(uint64_t &pos);
+
+    const sample_ring<gr_complex> &d_ring;
+    unsigned int        d_fftsize;  /*!< Segment length. */
+    unsigned int        d_step;     /*!< Distance between segments. */
+    std::vector<float>  d_window;   /*!< Window applied to each segment. */
+    float               d_share;    /*!< CPU budget of each thread (cores). */
+
+    boost::mutex        d_pos_mutex;
+    uint64_t            d_pos;      /*!< Start of the next segment. */
+    uint64_t            d_used;     /*!< Samples used since coverage(). */
+    uint64_t            d_skipped;  /*!< Samples skipped since coverage(). */
+
+    std::vector<worker *> d_workers;
+};
+
+#endif // WELCH_ESTIMATOR_H
@@ -69,6 +69,7 @@ DockAudio::DockAudio(QWidget *parent) :
     ui->audioSpectrum->setFilterBoxEnabled(false);
     ui->audioSpectrum->setCenterLineEnabled(false);
     ui->audioSpectrum->setBookmarksEnabled(false);
+    ui->audioSpectrum->setHalfSpectrum(true);
     ui->audioSpectrum->setFftRange(-80., 0.);
     ui->audioSpectrum->setVdivDelta(40);
     ui->audioSpectrum->setHdivDelta(40);
@@ -93,6 +94,10 @@ void DockAudio::setFftRange(quint64 minf, quint64 maxf)
     }
 }
 
+/*! \brief Set new audio FFT data.
+ *  \param fftData The power spectrum in dBFS from DC to half the audio rate.
+ *  \param size The number of bins (fftsize/2 + 1).
+ */
 void DockAudio::setNewFttData(float *fftData, int size)
 {
     ui->audioSpectrum->setNewFttData(fftData, size);
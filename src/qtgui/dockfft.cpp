@@ -33,6 +33,7 @@
 #define DEFAULT_FFT_SIZE        8192
 #define DEFAULT_FFT_SPLIT       35
 #define DEFAULT_FFT_AVG         75
+#define DEFAULT_FFT_WINDOW      0   /* Hamming, see gr::filter::firdes::win_type */
 
 DockFft::DockFft(QWidget *parent) :
     QDockWidget(parent),
@@ -210,6 +211,11 @@ void DockFft::saveSettings(QSettings *settings)
     else
         settings->remove("split");
 
+    if (ui->fftWindowComboBox->currentIndex() != DEFAULT_FFT_WINDOW)
+        settings->setValue("window", ui->fftWindowComboBox->currentIndex());
+    else
+        settings->remove("window");
+
     QColor fftColor = ui->colorPicker->currentColor();
     if (fftColor != QColor(0xFF,0xFF,0xFF,0xFF))
         settings->setValue("pandapter_color", fftColor);
@@ -281,6 +287,10 @@ void DockFft::readSettings(QSettings *settings)
     if (conv_ok)
         ui->fftAvgSlider->setValue(intval);
 
+    intval = settings->value("window", DEFAULT_FFT_WINDOW).toInt(&conv_ok);
+    if (conv_ok && intval >= 0 && intval < ui->fftWindowComboBox->count())
+        ui->fftWindowComboBox->setCurrentIndex(intval);
+
     intval = settings->value("split", DEFAULT_FFT_SPLIT).toInt(&conv_ok);
     if (conv_ok)
         ui->fftSplitSlider->setValue(intval);
@@ -412,6 +422,16 @@ void DockFft::on_fftAvgSlider_valueChanged(int value)
     emit fftAvgChanged(avg);
 }
 
+/**
+ * @brief FFT window type changed.
+ * @param index The selected entry; the entries are in the order of
+ *              gr::filter::firdes::win_type.
+ */
+void DockFft::on_fftWindowComboBox_currentIndexChanged(int index)
+{
+    emit fftWindowChanged(index);
+}
+
 /** FFT zoom level changed */
 void DockFft::on_fftZoomSlider_valueChanged(int level)
 {
@@ -57,6 +57,7 @@ signals:
     void fftSplitChanged(int pct);                 /*! Split between pandapter and waterfall changed. */
     void fftZoomChanged(float level);              /*! Zoom level slider changed. */
     void fftAvgChanged(float gain);                /*! FFT video filter gain has changed. */
+    void fftWindowChanged(int wintype);            /*! FFT window type changed. */
     void pandapterRangeChanged(float min, float max);
     void waterfallRangeChanged(float min, float max);
     void resetFftZoom(void);                       /*! FFT zoom reset. */
@@ -79,6 +80,7 @@ private slots:
     void on_wfSpanComboBox_currentIndexChanged(int index);
     void on_fftSplitSlider_valueChanged(int value);
     void on_fftAvgSlider_valueChanged(int value);
+    void on_fftWindowComboBox_currentIndexChanged(int index);
     void on_fftZoomSlider_valueChanged(int level);
     void on_pandRangeSlider_valuesChanged(int min, int max);
     void on_wfRangeSlider_valuesChanged(int min, int max);
@@ -28,22 +28,6 @@
 
 QStringList DockRxOpt::ModulationStrings;
 
-// Filter preset table per mode, preset and lo/hi
-static const int filter_preset_table[DockRxOpt::MODE_LAST][3][2] =
-{   //     WIDE             NORMAL            NARROW
-    {{      0,      0}, {     0,     0}, {     0,     0}},  // MODE_OFF
-    {{ -15000,  15000}, { -5000,  5000}, { -1000,  1000}},  // MODE_RAW
-    {{ -10000,  10000}, { -5000,  5000}, { -2500,  2500}},  // MODE_AM
-    {{ -10000,  10000}, { -5000,  5000}, { -2500,  2500}},  // MODE_NFM
-    {{-100000, 100000}, {-80000, 80000}, {-60000, 60000}},  // MODE_WFM_MONO
-    {{-100000, 100000}, {-80000, 80000}, {-60000, 60000}},  // MODE_WFM_STEREO
-    {{  -4000,   -100}, { -2800,  -100}, { -1600,  -200}},  // MODE_LSB
-    {{    100,   4000}, {   100,  2800}, {   200,  1600}},  // MODE_USB
-    {{  -1000,   1000}, {  -250,   250}, {  -100,   100}},  // MODE_CWL
-    {{  -1000,   1000}, {  -250,   250}, {  -100,   100}},  // MODE_CWU
-    {{-100000, 100000}, {-80000, 80000}, {-60000, 60000}}   // MODE_WFM_STEREO_OIRT
-};
-
 DockRxOpt::DockRxOpt(qint64 filterOffsetRange, QWidget *parent) :
     QDockWidget(parent),
     ui(new Ui::DockRxOpt),
@@ -54,7 +38,7 @@ DockRxOpt::DockRxOpt(qint64 filterOffsetRange, QWidget *parent) :
 
     if (ModulationStrings.size() == 0)
     {
-        // Keep in sync with rxopt_mode_idx
+        // Keep in sync with RxModes::mode_idx
         ModulationStrings.append("Demod Off");
         ModulationStrings.append("Raw I/Q");
         ModulationStrings.append("AM");
@@ -172,19 +156,7 @@ void DockRxOpt::updateHwFreq()
  */
 unsigned int DockRxOpt::filterIdxFromLoHi(int lo, int hi) const
 {
-    int mode_index = ui->modeSelector->currentIndex();
-
-    if (lo == filter_preset_table[mode_index][FILTER_PRESET_WIDE][0] &&
-        hi == filter_preset_table[mode_index][FILTER_PRESET_WIDE][1])
-        return FILTER_PRESET_WIDE;
-    else if (lo == filter_preset_table[mode_index][FILTER_PRESET_NORMAL][0] &&
-             hi == filter_preset_table[mode_index][FILTER_PRESET_NORMAL][1])
-        return FILTER_PRESET_NORMAL;
-    else if (lo == filter_preset_table[mode_index][FILTER_PRESET_NARROW][0] &&
-             hi == filter_preset_table[mode_index][FILTER_PRESET_NARROW][1])
-        return FILTER_PRESET_NARROW;
-
-    return FILTER_PRESET_USER;
+    return RxModes::filterPresetFromLoHi(ui->modeSelector->currentIndex(), lo, hi);
 }
 
 /**
@@ -245,7 +217,7 @@ int  DockRxOpt::currentFilterShape()
  */
 void DockRxOpt::setCurrentDemod(int demod)
 {
-    if ((demod >= MODE_OFF) && (demod < MODE_LAST))
+    if ((demod >= RxModes::MODE_OFF) && (demod < RxModes::MODE_LAST))
     {
         ui->modeSelector->setCurrentIndex(demod);
         updateDemodOptPage(demod);
@@ -296,18 +268,7 @@ double DockRxOpt::currentSquelchLevel()
 /** Get filter lo/hi for a given mode and preset */
 void DockRxOpt::getFilterPreset(int mode, int preset, int * lo, int * hi) const
 {
-    if (mode < 0 || mode >= MODE_LAST)
-    {
-        qDebug() << __func__ << ": Invalid mode:" << mode;
-        mode = MODE_AM;
-    }
-    else if (preset < 0 || preset > 2)
-    {
-        qDebug() << __func__ << ": Invalid preset:" << preset;
-        preset = FILTER_PRESET_NORMAL;
-    }
-    *lo = filter_preset_table[mode][preset][0];
-    *hi = filter_preset_table[mode][preset][1];
+    RxModes::getFilterPreset(mode, preset, lo, hi);
 }
 
 int DockRxOpt::getCwOffset() const
@@ -488,11 +449,11 @@ void DockRxOpt::on_modeSelector_activated(int index)
 void DockRxOpt::updateDemodOptPage(int demod)
 {
     // update demodulator option widget
-    if (demod == MODE_NFM)
+    if (demod == RxModes::MODE_NFM)
         demodOpt->setCurrentPage(CDemodOptions::PAGE_FM_OPT);
-    else if (demod == MODE_AM)
+    else if (demod == RxModes::MODE_AM)
         demodOpt->setCurrentPage(CDemodOptions::PAGE_AM_OPT);
-    else if (demod == MODE_CWL || demod == MODE_CWU)
+    else if (demod == RxModes::MODE_CWL || demod == RxModes::MODE_CWU)
         demodOpt->setCurrentPage(CDemodOptions::PAGE_CW_OPT);
     else
         demodOpt->setCurrentPage(CDemodOptions::PAGE_NO_OPT);
@@ -677,7 +638,7 @@ int DockRxOpt::GetEnumForModulationString(QString param)
     if(iModulation == -1)
     {
         printf("Modulation '%s' is unknown.\n", param.toStdString().c_str());
-        iModulation = MODE_OFF;
+        iModulation = RxModes::MODE_OFF;
     }
     return iModulation;
 }
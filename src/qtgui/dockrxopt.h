@@ -25,15 +25,11 @@
 
 #include <QDockWidget>
 #include <QSettings>
+#include "applications/gqrx/rx_modes.h"
 #include "qtgui/agc_options.h"
 #include "qtgui/demod_options.h"
 #include "qtgui/nb_options.h"
 
-#define FILTER_PRESET_WIDE      0
-#define FILTER_PRESET_NORMAL    1
-#define FILTER_PRESET_NARROW    2
-#define FILTER_PRESET_USER      3
-
 namespace Ui {
     class DockRxOpt;
 }
@@ -56,28 +52,6 @@ class DockRxOpt : public QDockWidget
 
 public:
 
-    /**
-     * Mode selector entries.
-     *
-     * @note If you change this enum, remember to update the TCP interface.
-     * @note Keep in same order as the Strings in ModulationStrings, see
-     *       DockRxOpt.cpp constructor.
-     */
-    enum rxopt_mode_idx {
-        MODE_OFF        = 0, /*!< Demodulator completely off. */
-        MODE_RAW        = 1, /*!< Raw I/Q passthrough. */
-        MODE_AM         = 2, /*!< Amplitude modulation. */
-        MODE_NFM        = 3, /*!< Narrow band FM. */
-        MODE_WFM_MONO   = 4, /*!< Broadcast FM (mono). */
-        MODE_WFM_STEREO = 5, /*!< Broadcast FM (stereo). */
-        MODE_LSB        = 6, /*!< Lower side band. */
-        MODE_USB        = 7, /*!< Upper side band. */
-        MODE_CWL        = 8, /*!< CW using LSB filter. */
-        MODE_CWU        = 9, /*!< CW using USB filter. */
-        MODE_WFM_STEREO_OIRT = 10, /*!< Broadcast FM (stereo oirt). */
-        MODE_LAST       = 11
-    };
-
     explicit DockRxOpt(qint64 filterOffsetRange = 90000, QWidget *parent = 0);
     ~DockRxOpt();
 
@@ -118,6 +118,11 @@ CIoConfig::CIoConfig(QSettings * settings,
     // LNB LO
     ui->loSpinBox->setValue(1.0e-6 * settings->value("input/lnb_lo", 0.0).toDouble());
 
+    // Latency profile: low, balanced, throughput
+    idx = settings->value("input/latency", 1).toInt();
+    if (idx >= 0 && idx < ui->latencyCombo->count())
+        ui->latencyCombo->setCurrentIndex(idx);
+
     // Output device
     QString outdev = settings->value("output/device", "").toString();
 
@@ -311,6 +316,12 @@ void CIoConfig::saveConfig()
         m_settings->remove("input/decimation");
     else
         m_settings->setValue("input/decimation", int_val);
+
+    idx = ui->latencyCombo->currentIndex();
+    if (idx == 1)
+        m_settings->remove("input/latency");
+    else
+        m_settings->setValue("input/latency", idx);
 }
 
 
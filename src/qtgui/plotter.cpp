@@ -109,7 +109,8 @@ static inline quint64 time_ms(void)
 #define STATUS_TIP \
     "Click, drag or scroll on spectrum to tune. " \
     "Drag and scroll X and Y axes for pan and zoom. " \
-    "Drag filter edges to adjust filter."
+    "Drag filter edges to adjust filter. " \
+    "Page Up/Down scrolls through the waterfall history."
 
 CPlotter::CPlotter(QWidget *parent) : QFrame(parent)
 {
@@ -124,29 +125,6 @@ CPlotter::CPlotter(QWidget *parent) : QFrame(parent)
     setTooltipsEnabled(false);
     setStatusTip(tr(STATUS_TIP));
 
-    // default waterfall color scheme
-    for (int i = 0; i < 256; i++)
-    {
-        // level 0: black background
-        if (i < 20)
-            m_ColorTbl[i].setRgb(0, 0, 0);
-        // level 1: black -> blue
-        else if ((i >= 20) && (i < 70))
-            m_ColorTbl[i].setRgb(0, 0, 140*(i-20)/50);
-        // level 2: blue -> light-blue / greenish
-        else if ((i >= 70) && (i < 100))
-            m_ColorTbl[i].setRgb(60*(i-70)/30, 125*(i-70)/30, 115*(i-70)/30 + 140);
-        // level 3: light blue -> yellow
-        else if ((i >= 100) && (i < 150))
-            m_ColorTbl[i].setRgb(195*(i-100)/50 + 60, 130*(i-100)/50 + 125, 255-(255*(i-100)/50));
-        // level 4: yellow -> red
-        else if ((i >= 150) && (i < 250))
-            m_ColorTbl[i].setRgb(255, 255-255*(i-150)/100, 0);
-        // level 5: red -> white
-        else if (i >= 250)
-            m_ColorTbl[i].setRgb(255, 255*(i-250)/5, 255*(i-250)/5);
-    }
-
     m_PeakHoldActive = false;
     m_PeakHoldValid = false;
 
@@ -169,6 +147,9 @@ CPlotter::CPlotter(QWidget *parent) : QFrame(parent)
     m_FilterBoxEnabled = true;
     m_CenterLineEnabled = true;
     m_BookmarksEnabled = true;
+    m_HalfSpectrum = false;
+    m_fftDataCenter = 0;
+    m_fftDataRate = 0.f;
 
     m_Span = 96000;
     m_SampleFreq = 96000;
@@ -182,9 +163,9 @@ CPlotter::CPlotter(QWidget *parent) : QFrame(parent)
     m_CursorCaptured = NOCAP;
     m_Running = false;
     m_DrawOverlay = true;
-    m_2DPixmap = QPixmap(0,0);
-    m_OverlayPixmap = QPixmap(0,0);
-    m_WaterfallPixmap = QPixmap(0,0);
+    m_2DImage = QImage();
+    m_OverlayImage = QImage();
+    m_WaterfallHeight = 0;
     m_Size = QSize(0,0);
     m_GrabPosition = 0;
     m_Percent2DScreen = 30;	//percent of screen used for 2D display
@@ -201,15 +182,18 @@ CPlotter::CPlotter(QWidget *parent) : QFrame(parent)
     setFftFill(false);
 
     // always update waterfall
-    tlast_wf_ms = 0;
     msec_per_wfline = 0;
     wf_span = 0;
     fft_rate = 15;
-    memset(m_wfbuf, 255, MAX_SCREENSIZE);
+
+    m_Renderer = new CPlotterRenderer();
+    connect(m_Renderer, SIGNAL(frameReady()), this, SLOT(presentFrame()));
+    m_Renderer->start();
 }
 
 CPlotter::~CPlotter()
 {
+    delete m_Renderer;
 }
 
 QSize CPlotter::minimumSizeHint() const
@@ -228,7 +212,7 @@ void CPlotter::mouseMoveEvent(QMouseEvent* event)
     QPoint pt = event->pos();
 
     /* mouse enter / mouse leave events */
-    if (m_OverlayPixmap.rect().contains(pt))
+    if (m_OverlayImage.rect().contains(pt))
     {
         //is in Overlay bitmap region
         if (event->buttons() == Qt::NoButton)
@@ -348,7 +332,7 @@ void CPlotter::mouseMoveEvent(QMouseEvent* event)
             // move Y scale up/down
             float delta_px = m_Yzero - pt.y();
             float delta_db = delta_px * fabs(m_PandMindB - m_PandMaxdB) /
-                    (float)m_OverlayPixmap.height();
+                    (float)m_OverlayImage.height();
             m_PandMindB -= delta_db;
             m_PandMaxdB -= delta_db;
             if (out_of_range(m_PandMindB, m_PandMaxdB))
@@ -378,7 +362,7 @@ void CPlotter::mouseMoveEvent(QMouseEvent* event)
             setCursor(QCursor(Qt::ClosedHandCursor));
             // pan viewable range or move center frequency
             int delta_px = m_Xzero - pt.x();
-            qint64 delta_hz = delta_px * m_Span / m_OverlayPixmap.width();
+            qint64 delta_hz = delta_px * m_Span / m_OverlayImage.width();
             if (event->buttons() & Qt::MidButton)
             {
                 m_CenterFreq += delta_hz;
@@ -533,14 +517,19 @@ int CPlotter::getNearestPeak(QPoint pt)
 void CPlotter::setWaterfallSpan(quint64 span_ms)
 {
     wf_span = span_ms;
-    msec_per_wfline = wf_span / m_WaterfallPixmap.height();
+    msec_per_wfline = wf_span / m_WaterfallHeight;
     clearWaterfall();
 }
 
 void CPlotter::clearWaterfall()
 {
-    m_WaterfallPixmap.fill(Qt::black);
-    memset(m_wfbuf, 255, MAX_SCREENSIZE);
+    m_Renderer->clearWaterfall();
+}
+
+/** Set the memory limit of the waterfall history in MB. */
+void CPlotter::setWaterfallHistorySize(int mbytes)
+{
+    m_Renderer->setWaterfallHistorySize((size_t) qMax(mbytes, 0) * 1024 * 1024);
 }
 
 /**
@@ -553,8 +542,8 @@ void CPlotter::clearWaterfall()
 bool CPlotter::saveWaterfall(const QString & filename) const
 {
     QBrush          axis_brush(QColor(0x00, 0x00, 0x00, 0x70), Qt::SolidPattern);
-    QPixmap         pixmap(m_WaterfallPixmap);
-    QPainter        painter(&pixmap);
+    QImage          image(m_Renderer->waterfallImage());
+    QPainter        painter(&image);
     QRect           rect;
     QDateTime       tt;
     QFont           font("sans-serif");
@@ -564,8 +553,8 @@ bool CPlotter::saveWaterfall(const QString & filename) const
     int             hxa, wya = 85;
     int             i;
 
-    w = pixmap.width();
-    h = pixmap.height();
+    w = image.width();
+    h = image.height();
     hxa = font_metrics.height() + 5;    // height of X axis
     y = h - hxa;
     pixperdiv = (float) w / (float) m_HorDivs;
@@ -593,6 +582,7 @@ bool CPlotter::saveWaterfall(const QString & filename) const
     painter.drawText(rect, Qt::AlignRight|Qt::AlignBottom, tr("MHz"));
 
     quint64 msec;
+    quint64 tlast_wf_ms = m_Renderer->lastWaterfallTime();
     int tdivs = h / 70 + 1;
     pixperdiv = (float) h / (float) tdivs;
     tt.setTimeSpec(Qt::OffsetFromUTC);
@@ -612,7 +602,7 @@ bool CPlotter::saveWaterfall(const QString & filename) const
         painter.drawText(rect, Qt::AlignRight|Qt::AlignVCenter, tt.toString("hh:mm:ss"));
     }
 
-    return pixmap.save(filename, 0, -1);
+    return image.save(filename, 0, -1);
 }
 
 /** Get waterfall time resolution in milleconds / line. */
@@ -621,7 +611,7 @@ quint64 CPlotter::getWfTimeRes(void)
     if (msec_per_wfline)
         return msec_per_wfline;
     else
-        return 1000 * fft_rate / m_WaterfallPixmap.height(); // Auto mode
+        return 1000 * fft_rate / m_WaterfallHeight; // Auto mode
 }
 
 void CPlotter::setFftRate(int rate_hz)
@@ -726,7 +716,7 @@ void CPlotter::mouseReleaseEvent(QMouseEvent * event)
 {
     QPoint pt = event->pos();
 
-    if (!m_OverlayPixmap.rect().contains(pt))
+    if (!m_OverlayImage.rect().contains(pt))
     {
         // not in Overlay region
         if (NOCAP != m_CursorCaptured)
@@ -760,7 +750,7 @@ void CPlotter::zoomStepX(float step, int x)
                              (float)(m_SampleFreq) * 10.0f);
 
     // Frequency where event occured is kept fixed under mouse
-    float ratio = (float)x / (float)m_OverlayPixmap.width();
+    float ratio = (float)x / (float)m_OverlayImage.width();
     float fixed_hz = freqFromX(x);
     float f_max = fixed_hz + (1.0 - ratio) * new_range;
     float f_min = f_max - new_range;
@@ -798,9 +788,9 @@ void CPlotter::wheelEvent(QWheelEvent * event)
         // Vertical zoom. Wheel down: zoom out, wheel up: zoom in
         // During zoom we try to keep the point (dB or kHz) under the cursor fixed
         float zoom_fac = event->delta() < 0 ? 1.1 : 0.9;
-        float ratio = (float)pt.y() / (float)m_OverlayPixmap.height();
+        float ratio = (float)pt.y() / (float)m_OverlayImage.height();
         float db_range = m_PandMaxdB - m_PandMindB;
-        float y_range = (float)m_OverlayPixmap.height();
+        float y_range = (float)m_OverlayImage.height();
         float db_per_pix = db_range / y_range;
         float fixed_db = m_PandMaxdB - pt.y() * db_per_pix;
 
@@ -846,6 +836,36 @@ void CPlotter::wheelEvent(QWheelEvent * event)
     updateOverlay();
 }
 
+// Called when a key is pressed
+void CPlotter::keyPressEvent(QKeyEvent *event)
+{
+    qint64  page = qMax(1, m_WaterfallHeight / 2);
+
+    switch (event->key())
+    {
+    case Qt::Key_PageUp:
+        // back in time
+        m_Renderer->scrollWaterfall(page);
+        break;
+    case Qt::Key_PageDown:
+        m_Renderer->scrollWaterfall(-page);
+        break;
+    case Qt::Key_Home:
+        // oldest line in the history
+        m_Renderer->scrollWaterfall(INT_MAX);
+        break;
+    case Qt::Key_End:
+        // back to the live waterfall
+        m_Renderer->scrollWaterfall(-(qint64)INT_MAX);
+        break;
+    default:
+        QFrame::keyPressEvent(event);
+        return;
+    }
+
+    redrawWaterfall();
+}
+
 // Called when screen size changes so must recalculate bitmaps
 void CPlotter::resizeEvent(QResizeEvent* )
 {
@@ -859,29 +879,18 @@ void CPlotter::resizeEvent(QResizeEvent* )
 
         m_Size = size();
         fft_plot_height = m_Percent2DScreen * m_Size.height() / 100;
-        m_OverlayPixmap = QPixmap(m_Size.width(), fft_plot_height);
-        m_OverlayPixmap.fill(Qt::black);
-        m_2DPixmap = QPixmap(m_Size.width(), fft_plot_height);
-        m_2DPixmap.fill(Qt::black);
+        m_OverlayImage = QImage(m_Size.width(), fft_plot_height, QImage::Format_RGB32);
+        m_OverlayImage.fill(Qt::black);
+        m_2DImage = QImage(m_Size.width(), fft_plot_height, QImage::Format_RGB32);
+        m_2DImage.fill(Qt::black);
 
-        int height = (100 - m_Percent2DScreen) * m_Size.height() / 100;
-        if (m_WaterfallPixmap.isNull())
-        {
-            m_WaterfallPixmap = QPixmap(m_Size.width(), height);
-            m_WaterfallPixmap.fill(Qt::black);
-        }
-        else
-        {
-            m_WaterfallPixmap = m_WaterfallPixmap.scaled(m_Size.width(), height,
-                                                         Qt::IgnoreAspectRatio,
-                                                         Qt::SmoothTransformation);
-        }
+        m_WaterfallHeight = (100 - m_Percent2DScreen) * m_Size.height() / 100;
+        m_Renderer->resizeWaterfall(m_Size.width(), m_WaterfallHeight);
 
         m_PeakHoldValid = false;
 
         if (wf_span > 0)
-            msec_per_wfline = wf_span / height;
-        memset(m_wfbuf, 255, MAX_SCREENSIZE);
+            msec_per_wfline = wf_span / m_WaterfallHeight;
     }
 
     drawOverlay();
@@ -892,18 +901,16 @@ void CPlotter::paintEvent(QPaintEvent *)
 {
     QPainter painter(this);
 
-    painter.drawPixmap(0, 0, m_2DPixmap);
-    painter.drawPixmap(0, m_Percent2DScreen * m_Size.height() / 100,
-                       m_WaterfallPixmap);
+    int     y = m_Percent2DScreen * m_Size.height() / 100;
+
+    painter.drawImage(0, 0, m_2DImage);
+    m_Renderer->drawWaterfall(painter, y);
 }
 
 // Called to update spectrum data for displaying on the screen
 void CPlotter::draw()
 {
-    int     i, n;
-    int     w;
-    int     h;
-    int     xmin, xmax;
+    CPlotterParams  params;
 
     if (m_DrawOverlay)
     {
@@ -911,194 +918,68 @@ void CPlotter::draw()
         m_DrawOverlay = false;
     }
 
-    QPoint LineBuf[MAX_SCREENSIZE];
-
     if (!m_Running)
         return;
 
-    // get/draw the waterfall
-    w = m_WaterfallPixmap.width();
-    h = m_WaterfallPixmap.height();
-
-    // no need to draw if pixmap is invisible
-    if (w != 0 && h != 0)
-    {
-        quint64     tnow_ms = time_ms();
-
-        // get scaled FFT data
-        n = qMin(w, MAX_SCREENSIZE);
-        getScreenIntegerFFTData(255, n, m_WfMaxdB, m_WfMindB,
-                                m_FftCenter - (qint64)m_Span / 2,
-                                m_FftCenter + (qint64)m_Span / 2,
-                                m_wfData, m_fftbuf,
-                                &xmin, &xmax);
-
-        if (msec_per_wfline > 0)
-        {
-            // not in "auto" mode, so accumulate waterfall data
-            for (i = 0; i < n; i++)
-            {
-                // average
-                //m_wfbuf[i] = (m_wfbuf[i] + m_fftbuf[i]) / 2;
-
-                // peak (0..255 where 255 is min)
-                if (m_fftbuf[i] < m_wfbuf[i])
-                    m_wfbuf[i] = m_fftbuf[i];
-            }
-        }
+    // the frame is composed in the render thread, see presentFrame()
+    makeParams(params);
+    m_Renderer->render(params, m_fftData, m_wfData, m_fftDataSize);
+}
 
-        // is it time to update waterfall?
-        if (tnow_ms - tlast_wf_ms >= msec_per_wfline)
-        {
-            tlast_wf_ms = tnow_ms;
+/** Collect the parameters of the next frame for the renderer. */
+void CPlotter::makeParams(CPlotterParams &params)
+{
+    params.centerFreq = m_CenterFreq;
+    params.startFreq = m_FftCenter - (qint64)m_Span / 2;
+    params.stopFreq = m_FftCenter + (qint64)m_Span / 2;
+    params.fftDataCenter = m_fftDataCenter;
+    params.fftDataRate = m_fftDataRate;
+    params.sampleRate = m_SampleFreq;
+    params.halfSpectrum = m_HalfSpectrum;
+    params.pandMaxdB = m_PandMaxdB;
+    params.pandMindB = m_PandMindB;
+    params.wfMaxdB = m_WfMaxdB;
+    params.wfMindB = m_WfMindB;
+    params.fftColor = m_FftColor;
+    params.fftFillColor = m_FftFillCol;
+    params.peakHoldColor = m_PeakHoldColor;
+    params.fftFill = m_FftFill;
+    params.peakHold = m_PeakHoldActive;
+    params.resetPeakHold = !m_PeakHoldValid;
+    params.peakDetection = m_PeakDetection;
+    params.msecPerWfLine = msec_per_wfline;
+    params.timestamp = time_ms();
+    params.overlay = m_OverlayImage;
+    m_PeakHoldValid = true;
+}
 
-            // move current data down one line(must do before attaching a QPainter object)
-            m_WaterfallPixmap.scroll(0, 1, 0, 0, w, h);
+/** Draw the waterfall from history when no new data is coming in. */
+void CPlotter::redrawWaterfall()
+{
+    CPlotterParams  params;
 
-            QPainter painter1(&m_WaterfallPixmap);
+    if (m_Running)
+        return;
 
-            // draw new line of fft data at top of waterfall bitmap
-            painter1.setPen(QColor(0, 0, 0));
-            for (i = 0; i < xmin; i++)
-                painter1.drawPoint(i, 0);
-            for (i = xmax; i < w; i++)
-                painter1.drawPoint(i, 0);
+    makeParams(params);
+    m_Renderer->redraw(params);
+}
 
-            if (msec_per_wfline > 0)
-            {
-                // user set time span
-                for (i = xmin; i < xmax; i++)
-                {
-                    painter1.setPen(m_ColorTbl[255 - m_wfbuf[i]]);
-                    painter1.drawPoint(i, 0);
-                    m_wfbuf[i] = 255;
-                }
-            }
-            else
-            {
-                for (i = xmin; i < xmax; i++)
-                {
-                    painter1.setPen(m_ColorTbl[255 - m_fftbuf[i]]);
-                    painter1.drawPoint(i, 0);
-                }
-            }
-        }
-    }
+/** Show the latest frame completed by the render thread. */
+void CPlotter::presentFrame()
+{
+    QImage          frame;
+    QMap<int,int>   peaks;
 
-    // get/draw the 2D spectrum
-    w = m_2DPixmap.width();
-    h = m_2DPixmap.height();
+    if (!m_Renderer->takeFrame(frame, peaks))
+        return;
 
-    if (w != 0 && h != 0)
+    // a null frame only updates the waterfall; frames still in flight when
+    // the receiver was stopped are dropped
+    if (!frame.isNull() && m_Running)
     {
-        // first copy into 2Dbitmap the overlay bitmap.
-        m_2DPixmap = m_OverlayPixmap.copy(0,0,w,h);
-
-        QPainter painter2(&m_2DPixmap);
-
-// workaround for "fixed" line drawing since Qt 5
-// see http://stackoverflow.com/questions/16990326
-#if QT_VERSION >= 0x050000
-        painter2.translate(0.5, 0.5);
-#endif
-
-        // get new scaled fft data
-        getScreenIntegerFFTData(h, qMin(w, MAX_SCREENSIZE),
-                                m_PandMaxdB, m_PandMindB,
-                                m_FftCenter - (qint64)m_Span/2,
-                                m_FftCenter + (qint64)m_Span/2,
-                                m_fftData, m_fftbuf,
-                                &xmin, &xmax);
-
-        // draw the pandapter
-        painter2.setPen(m_FftColor);
-        n = xmax - xmin;
-        for (i = 0; i < n; i++)
-        {
-            LineBuf[i].setX(i + xmin);
-            LineBuf[i].setY(m_fftbuf[i + xmin]);
-        }
-
-        if (m_FftFill)
-        {
-            painter2.setBrush(QBrush(m_FftFillCol, Qt::SolidPattern));
-            if (n < MAX_SCREENSIZE-2)
-            {
-                LineBuf[n].setX(xmax-1);
-                LineBuf[n].setY(h);
-                LineBuf[n+1].setX(xmin);
-                LineBuf[n+1].setY(h);
-                painter2.drawPolygon(LineBuf, n+2);
-            }
-            else
-            {
-                LineBuf[MAX_SCREENSIZE-2].setX(xmax-1);
-                LineBuf[MAX_SCREENSIZE-2].setY(h);
-                LineBuf[MAX_SCREENSIZE-1].setX(xmin);
-                LineBuf[MAX_SCREENSIZE-1].setY(h);
-                painter2.drawPolygon(LineBuf, n);
-            }
-        }
-        else
-        {
-            painter2.drawPolyline(LineBuf, n);
-        }
-
-        // Peak detection
-        if (m_PeakDetection > 0)
-        {
-            m_Peaks.clear();
-
-            float   mean = 0;
-            float   sum_of_sq = 0;
-            for (i = 0; i < n; i++)
-            {
-                mean += m_fftbuf[i + xmin];
-                sum_of_sq += m_fftbuf[i + xmin] * m_fftbuf[i + xmin];
-            }
-            mean /= n;
-            float stdev= sqrt(sum_of_sq / n - mean * mean );
-
-            int lastPeak = -1;
-            for (i = 0; i < n; i++)
-            {
-                //m_PeakDetection times the std over the mean or better than current peak
-                float d = (lastPeak == -1) ? (mean - m_PeakDetection * stdev) :
-                                           m_fftbuf[lastPeak + xmin];
-
-                if (m_fftbuf[i + xmin] < d)
-                    lastPeak=i;
-
-                if (lastPeak != -1 &&
-                        (i - lastPeak > PEAK_H_TOLERANCE || i == n-1))
-                {
-                    m_Peaks.insert(lastPeak + xmin, m_fftbuf[lastPeak + xmin]);
-                    painter2.drawEllipse(lastPeak + xmin - 5,
-                                         m_fftbuf[lastPeak + xmin] - 5, 10, 10);
-                    lastPeak = -1;
-                }
-            }
-        }
-
-        // Peak hold
-        if (m_PeakHoldActive)
-        {
-            for (i = 0; i < n; i++)
-            {
-                if(!m_PeakHoldValid || m_fftbuf[i] < m_fftPeakHoldBuf[i])
-                    m_fftPeakHoldBuf[i] = m_fftbuf[i];
-
-                LineBuf[i].setX(i + xmin);
-                LineBuf[i].setY(m_fftPeakHoldBuf[i + xmin]);
-            }
-            painter2.setPen(m_PeakHoldColor);
-            painter2.drawPolyline(LineBuf, n);
-
-            m_PeakHoldValid = true;
-        }
-
-      painter2.end();
-
+        m_2DImage = frame;
+        m_Peaks = peaks;
     }
 
     // trigger a new paintEvent
@@ -1149,109 +1030,6 @@ void CPlotter::setNewFttData(float *fftData, float *wfData, int size)
     draw();
 }
 
-void CPlotter::getScreenIntegerFFTData(qint32 plotHeight, qint32 plotWidth,
-                                       float maxdB, float mindB,
-                                       qint64 startFreq, qint64 stopFreq,
-                                       float *inBuf, qint32 *outBuf,
-                                       int *xmin, int *xmax)
-{
-    qint32 i;
-    qint32 y;
-    qint32 x;
-    qint32 ymax = 10000;
-    qint32 xprev = -1;
-    qint32 minbin, maxbin;
-    qint32 m_BinMin, m_BinMax;
-    qint32 m_FFTSize = m_fftDataSize;
-    float *m_pFFTAveBuf = inBuf;
-    float  dBGainFactor = ((float)plotHeight) / fabs(maxdB - mindB);
-    qint32* m_pTranslateTbl = new qint32[qMax(m_FFTSize, plotWidth)];
-
-    /** FIXME: qint64 -> qint32 **/
-    m_BinMin = (qint32)((float)startFreq * (float)m_FFTSize / m_SampleFreq);
-    m_BinMin += (m_FFTSize/2);
-    m_BinMax = (qint32)((float)stopFreq * (float)m_FFTSize / m_SampleFreq);
-    m_BinMax += (m_FFTSize/2);
-
-    minbin = m_BinMin < 0 ? 0 : m_BinMin;
-    if (m_BinMin > m_FFTSize)
-        m_BinMin = m_FFTSize - 1;
-    if (m_BinMax <= m_BinMin)
-        m_BinMax = m_BinMin + 1;
-    maxbin = m_BinMax < m_FFTSize ? m_BinMax : m_FFTSize;
-    bool largeFft = (m_BinMax-m_BinMin) > plotWidth; // true if more fft point than plot points
-
-    if (largeFft)
-    {
-        // more FFT points than plot points
-        for (i = minbin; i < maxbin; i++)
-            m_pTranslateTbl[i] = ((qint64)(i-m_BinMin)*plotWidth) / (m_BinMax - m_BinMin);
-        *xmin = m_pTranslateTbl[minbin];
-        *xmax = m_pTranslateTbl[maxbin - 1];
-    }
-    else
-    {
-        // more plot points than FFT points
-        for (i = 0; i < plotWidth; i++)
-            m_pTranslateTbl[i] = m_BinMin + (i*(m_BinMax - m_BinMin)) / plotWidth;
-        *xmin = 0;
-        *xmax = plotWidth;
-    }
-
-    if (largeFft)
-    {
-        // more FFT points than plot points
-        for (i = minbin; i < maxbin; i++ )
-        {
-            y = (qint32)(dBGainFactor*(maxdB-m_pFFTAveBuf[i]));
-
-            if (y > plotHeight)
-                y = plotHeight;
-            else if (y < 0)
-                y = 0;
-
-            x = m_pTranslateTbl[i];	//get fft bin to plot x coordinate transform
-
-            if (x == xprev)   // still mappped to same fft bin coordinate
-            {
-                if (y < ymax) // store only the max value
-                {
-                    outBuf[x] = y;
-                    ymax = y;
-                }
-
-            }
-            else
-            {
-                outBuf[x] = y;
-                xprev = x;
-                ymax = y;
-            }
-        }
-    }
-    else
-    {
-        // more plot points than FFT points
-        for (x = 0; x < plotWidth; x++ )
-        {
-            i = m_pTranslateTbl[x]; // get plot to fft bin coordinate transform
-            if(i < 0 || i >= m_FFTSize)
-                y = plotHeight;
-            else
-                y = (qint32)(dBGainFactor*(maxdB-m_pFFTAveBuf[i]));
-
-            if (y > plotHeight)
-                y = plotHeight;
-            else if (y < 0)
-                y = 0;
-
-            outBuf[x] = y;
-        }
-    }
-
-    delete [] m_pTranslateTbl;
-}
-
 void CPlotter::setFftRange(float min, float max)
 {
     setWaterfallRange(min, max);
@@ -1276,18 +1054,19 @@ void CPlotter::setWaterfallRange(float min, float max)
 
     m_WfMindB = min;
     m_WfMaxdB = max;
-    // no overlay change is necessary
+    // no overlay change is necessary, the waterfall is drawn again from history
+    redrawWaterfall();
 }
 
 // Called to draw an overlay bitmap containing grid and text that
 // does not need to be recreated every fft data update.
 void CPlotter::drawOverlay()
 {
-    if (m_OverlayPixmap.isNull())
+    if (m_OverlayImage.isNull())
         return;
 
-    int     w = m_OverlayPixmap.width();
-    int     h = m_OverlayPixmap.height();
+    int     w = m_OverlayImage.width();
+    int     h = m_OverlayImage.height();
     int     x,y;
     float   pixperdiv;
     float   adjoffset;
@@ -1295,7 +1074,7 @@ void CPlotter::drawOverlay()
     float   mindbadj;
     QRect   rect;
     QFontMetrics    metrics(m_Font);
-    QPainter        painter(&m_OverlayPixmap);
+    QPainter        painter(&m_OverlayImage);
 
     painter.initFrom(this);
     painter.setFont(m_Font);
@@ -1476,7 +1255,10 @@ void CPlotter::drawOverlay()
     {
         // if not running so is no data updates to draw to screen
         // copy into 2Dbitmap the overlay bitmap.
-        m_2DPixmap = m_OverlayPixmap.copy(0,0,w,h);
+        m_2DImage = m_OverlayImage.copy(0,0,w,h);
+
+        // the waterfall may need to follow a new frequency range
+        redrawWaterfall();
 
         // trigger a new paintEvent
         update();
@@ -1542,20 +1324,20 @@ void CPlotter::makeFrequencyStrs()
 // Convert from screen coordinate to frequency
 int CPlotter::xFromFreq(qint64 freq)
 {
-    int w = m_OverlayPixmap.width();
+    int w = m_OverlayImage.width();
     qint64 StartFreq = m_CenterFreq + m_FftCenter - m_Span/2;
     int x = (int) w * ((float)freq - StartFreq)/(float)m_Span;
     if (x < 0)
         return 0;
     if (x > (int)w)
-        return m_OverlayPixmap.width();
+        return m_OverlayImage.width();
     return x;
 }
 
 // Convert from frequency to screen coordinate
 qint64 CPlotter::freqFromX(int x)
 {
-    int w = m_OverlayPixmap.width();
+    int w = m_OverlayImage.width();
     qint64 StartFreq = m_CenterFreq + m_FftCenter - m_Span / 2;
     qint64 f = (qint64)(StartFreq + (float)m_Span * (float)x / (float)w);
     return f;
@@ -1565,15 +1347,15 @@ qint64 CPlotter::freqFromX(int x)
 quint64 CPlotter::msecFromY(int y)
 {
     // ensure we are in the waterfall region
-    if (y < m_OverlayPixmap.height())
+    if (y < m_OverlayImage.height())
         return 0;
 
-    int dy = y - m_OverlayPixmap.height();
+    int dy = y - m_OverlayImage.height();
 
     if (msec_per_wfline > 0)
-        return tlast_wf_ms - dy * msec_per_wfline;
+        return m_Renderer->lastWaterfallTime() - dy * msec_per_wfline;
     else
-        return tlast_wf_ms - dy * 1000 / fft_rate;
+        return m_Renderer->lastWaterfallTime() - dy * 1000 / fft_rate;
 }
 
 // Round frequency to click resolution value
@@ -8,14 +8,13 @@
 #include <QImage>
 #include <vector>
 #include <QMap>
+#include "plotter_renderer.h"
 
 #define HORZ_DIVS_MAX 12    //50
 #define VERT_DIVS_MIN 5
-#define MAX_SCREENSIZE 16384
 
 #define PEAK_CLICK_MAX_H_DISTANCE 10 //Maximum horizontal distance of clicked point from peak
 #define PEAK_CLICK_MAX_V_DISTANCE 20 //Maximum vertical distance of clicked point from peak
-#define PEAK_H_TOLERANCE 2
 
 
 class CPlotter : public QFrame
@@ -38,6 +37,7 @@ public:
     void setCenterLineEnabled(bool enabled) { m_CenterLineEnabled = enabled; }
     void setTooltipsEnabled(bool enabled) { m_TooltipsEnabled = enabled; }
     void setBookmarksEnabled(bool enabled) { m_BookmarksEnabled = enabled; }
+    void setHalfSpectrum(bool half) { m_HalfSpectrum = half; }
 
     void setNewFttData(float *fftData, int size);
     void setNewFttData(float *fftData, float *wfData, int size);
@@ -107,11 +107,22 @@ public:
         m_FftCenter = qBound(-limit, f, limit);
     }
 
+    qint64 getFftCenterFreq(void) const { return m_FftCenter; }
+    qint64 getSpanFreq(void) const { return m_Span; }
+
+    /* Frequency range of the FFT data, e.g. a zoom spectrum; rate 0 means the full sample rate. */
+    void setFftDataRange(qint64 center, float rate)
+    {
+        m_fftDataCenter = center;
+        m_fftDataRate = rate;
+    }
+
     int     getNearestPeak(QPoint pt);
     void    setWaterfallSpan(quint64 span_ms);
     quint64 getWfTimeRes(void);
     void    setFftRate(int rate_hz);
     void    clearWaterfall(void);
+    void    setWaterfallHistorySize(int mbytes);
     bool    saveWaterfall(const QString & filename) const;
 
 signals:
@@ -155,6 +166,10 @@ protected:
     void mousePressEvent(QMouseEvent * event);
     void mouseReleaseEvent(QMouseEvent * event);
     void wheelEvent( QWheelEvent * event );
+    void keyPressEvent(QKeyEvent *event);
+
+private slots:
+    void presentFrame();
 
 private:
     enum eCapturetype {
@@ -168,6 +183,8 @@ private:
     };
 
     void        drawOverlay();
+    void        makeParams(CPlotterParams &params);
+    void        redrawWaterfall();
     void        makeFrequencyStrs();
     int         xFromFreq(qint64 freq);
     qint64      freqFromX(int x);
@@ -179,30 +196,24 @@ private:
     {
         return ((x > (xr - delta)) && (x < (xr + delta)));
     }
-    void getScreenIntegerFFTData(qint32 plotHeight, qint32 plotWidth,
-                                 float maxdB, float mindB,
-                                 qint64 startFreq, qint64 stopFreq,
-                                 float *inBuf, qint32 *outBuf,
-                                 qint32 *maxbin, qint32 *minbin);
     void calcDivSize (qint64 low, qint64 high, int divswanted, qint64 &adjlow, qint64 &step, int& divs);
 
     bool        m_PeakHoldActive;
-    bool        m_PeakHoldValid;
-    qint32      m_fftbuf[MAX_SCREENSIZE];
-    quint8      m_wfbuf[MAX_SCREENSIZE]; // used for accumulating waterfall data at high time spans
-    qint32      m_fftPeakHoldBuf[MAX_SCREENSIZE];
+    bool        m_PeakHoldValid;    /*!< FALSE if peak hold must restart with the next frame. */
     float      *m_fftData;     /*! pointer to incoming FFT data */
     float      *m_wfData;
     int         m_fftDataSize;
+    qint64      m_fftDataCenter; /*! center of the FFT data relative to m_CenterFreq */
+    float       m_fftDataRate;   /*! frequency range of the FFT data, 0 for m_SampleFreq */
 
     int         m_XAxisYCenter;
     int         m_YAxisWidth;
 
     eCapturetype    m_CursorCaptured;
-    QPixmap     m_2DPixmap;
-    QPixmap     m_OverlayPixmap;
-    QPixmap     m_WaterfallPixmap;
-    QColor      m_ColorTbl[256];
+    CPlotterRenderer   *m_Renderer; /*!< Composes the frames and owns the waterfall. */
+    QImage      m_2DImage;          /*!< Latest pandapter frame from the renderer. */
+    QImage      m_OverlayImage;     /*!< Grid and markers, drawn in the GUI thread. */
+    int         m_WaterfallHeight;
     QSize       m_Size;
     QString     m_Str;
     QString     m_HDivText[HORZ_DIVS_MAX+1];
@@ -217,6 +228,7 @@ private:
     bool        m_FilterBoxEnabled;   /*!< Draw filter box. */
     bool        m_TooltipsEnabled;     /*!< Tooltips enabled */
     bool        m_BookmarksEnabled;   /*!< Show/hide bookmarks on spectrum */
+    bool        m_HalfSpectrum;       /*!< FFT data starts at DC (real FFT). */
     int         m_DemodHiCutFreq;
     int         m_DemodLowCutFreq;
     int         m_DemodFreqX;		//screen coordinate x position
@@ -265,7 +277,6 @@ private:
     QList< QPair<QRect, qint64> >     m_BookmarkTags;
 
     // Waterfall averaging
-    quint64     tlast_wf_ms;        // last time waterfall has been updated
     quint64     msec_per_wfline;    // milliseconds between waterfall updates
     quint64     wf_span;            // waterfall span in milliseconds (0 = auto)
     int         fft_rate;           // expected FFT rate (needed when WF span is auto)
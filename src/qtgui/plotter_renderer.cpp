@@ -0,0 +1,899 @@
+/* -*- c++ -*- */
+/* + + +   This Software is released under the "Simplified BSD License"  + + +
+ * Copyright 2010 Moe Wheatley. All rights reserved.
+ * Copyright 2011-2013 Alexandru Csete OZ9AEC
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice, this list of
+ *       conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *       of conditions and the following disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Moe Wheatley ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL Moe Wheatley OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those of the
+ * authors and should not be interpreted as representing official policies, either expressed
+ * or implied, of Moe Wheatley.
+ */
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <QMutexLocker>
+#include <QPainter>
+#include "dsp/spectrum_kernel.h"
+#include "plotter_renderer.h"
+
+
+CPlotterRenderer::CPlotterRenderer(QObject *parent) : QThread(parent)
+{
+    // default waterfall color scheme
+    for (int i = 0; i < 256; i++)
+    {
+        // level 0: black background
+        if (i < 20)
+            m_ColorTbl[i] = qRgb(0, 0, 0);
+        // level 1: black -> blue
+        else if ((i >= 20) && (i < 70))
+            m_ColorTbl[i] = qRgb(0, 0, 140*(i-20)/50);
+        // level 2: blue -> light-blue / greenish
+        else if ((i >= 70) && (i < 100))
+            m_ColorTbl[i] = qRgb(60*(i-70)/30, 125*(i-70)/30, 115*(i-70)/30 + 140);
+        // level 3: light blue -> yellow
+        else if ((i >= 100) && (i < 150))
+            m_ColorTbl[i] = qRgb(195*(i-100)/50 + 60, 130*(i-100)/50 + 125, 255-(255*(i-100)/50));
+        // level 4: yellow -> red
+        else if ((i >= 150) && (i < 250))
+            m_ColorTbl[i] = qRgb(255, 255-255*(i-150)/100, 0);
+        // level 5: red -> white
+        else if (i >= 250)
+            m_ColorTbl[i] = qRgb(255, 255*(i-250)/5, 255*(i-250)/5);
+    }
+
+    m_JobPending = false;
+    m_JobHasData = false;
+    m_Quit = false;
+    m_PeakHoldValid = false;
+    m_WaterfallHead = 0;
+    m_LastWfTime = 0;
+    m_FrameReady = false;
+    m_MapWidth = 0;
+    m_MapSize = 0;
+    m_MapLargeFft = false;
+    m_MapXmin = 0;
+    m_MapXmax = 0;
+    m_HistSize = 0;
+    m_HistStart = 0;
+    m_HistStep = 0.0;
+    m_WfScroll = 0;
+    m_ViewDirty = true;
+    m_ViewStart = 0;
+    m_ViewStop = 0;
+    m_ViewMaxdB = 0.f;
+    m_ViewMindB = 0.f;
+    memset(m_wfbuf, 255, MAX_SCREENSIZE);
+}
+
+CPlotterRenderer::~CPlotterRenderer()
+{
+    m_JobMutex.lock();
+    m_Quit = true;
+    m_JobCond.wakeOne();
+    m_JobMutex.unlock();
+
+    wait();
+}
+
+/**
+ * Queue new FFT data for rendering.
+ * @param params The plot parameters.
+ * @param fftData The FFT data used on the pandapter.
+ * @param wfData The FFT data used in the waterfall, may be the same as fftData.
+ * @param size The FFT size.
+ *
+ * The data is copied, so the caller may reuse the buffers as soon as this
+ * function returns. If the previous data has not been picked up by the render
+ * thread yet, it is dropped.
+ */
+void CPlotterRenderer::render(const CPlotterParams &params,
+                              const float *fftData, const float *wfData,
+                              int size)
+{
+    QMutexLocker locker(&m_JobMutex);
+    bool    reset = m_JobPending && m_JobParams.resetPeakHold;
+
+    m_JobParams = params;
+    m_JobParams.resetPeakHold |= reset;
+
+    m_JobFftData.assign(fftData, fftData + size);
+    if (wfData == fftData)
+        m_JobWfData.clear();
+    else
+        m_JobWfData.assign(wfData, wfData + size);
+
+    m_JobPending = true;
+    m_JobHasData = true;
+    m_JobCond.wakeOne();
+}
+
+/**
+ * Draw the waterfall again with new parameters but without new data.
+ * @param params The plot parameters.
+ *
+ * Used while no FFT data arrives, e.g. to scroll through the waterfall
+ * history while the receiver is stopped. Queued FFT data is kept.
+ */
+void CPlotterRenderer::redraw(const CPlotterParams &params)
+{
+    QMutexLocker locker(&m_JobMutex);
+    bool    reset = m_JobPending && m_JobParams.resetPeakHold;
+
+    m_JobParams = params;
+    m_JobParams.resetPeakHold |= reset;
+
+    m_JobPending = true;
+    m_JobCond.wakeOne();
+}
+
+/**
+ * Take the latest completed frame.
+ * @param frame The pandapter image (null if the pandapter is not visible).
+ * @param peaks The detected peaks (x -> y).
+ * @return TRUE if a new frame was available, FALSE otherwise.
+ */
+bool CPlotterRenderer::takeFrame(QImage &frame, QMap<int,int> &peaks)
+{
+    QMutexLocker locker(&m_FrameMutex);
+
+    if (!m_FrameReady)
+        return false;
+
+    frame = m_Frame;
+    peaks = m_FramePeaks;
+    m_FrameReady = false;
+
+    return true;
+}
+
+/** Draw the waterfall with its top at y. */
+void CPlotterRenderer::drawWaterfall(QPainter &painter, int y)
+{
+    QMutexLocker locker(&m_WfMutex);
+    int     h = m_WaterfallImage.height();
+    int     w = m_WaterfallImage.width();
+
+    // the waterfall is a ring buffer: draw from the newest line to the
+    // bottom of the image, then the older lines from the top
+    painter.drawImage(0, y, m_WaterfallImage,
+                      0, m_WaterfallHead, w, h - m_WaterfallHead);
+    if (m_WaterfallHead > 0)
+        painter.drawImage(0, y + h - m_WaterfallHead, m_WaterfallImage,
+                          0, 0, w, m_WaterfallHead);
+}
+
+/** Get a copy of the waterfall with the newest line at the top. */
+QImage CPlotterRenderer::waterfallImage(void)
+{
+    QMutexLocker locker(&m_WfMutex);
+
+    return linearWaterfall();
+}
+
+/** Resize the waterfall, scaling the existing lines to the new size. */
+void CPlotterRenderer::resizeWaterfall(int width, int height)
+{
+    QMutexLocker locker(&m_WfMutex);
+
+    if (m_WaterfallImage.isNull())
+    {
+        m_WaterfallImage = QImage(width, height, QImage::Format_RGB32);
+        m_WaterfallImage.fill(qRgb(0, 0, 0));
+    }
+    else
+    {
+        m_WaterfallImage = linearWaterfall().scaled(width, height,
+                                                    Qt::IgnoreAspectRatio,
+                                                    Qt::SmoothTransformation)
+                           .convertToFormat(QImage::Format_RGB32);
+    }
+    m_WaterfallHead = 0;
+    m_ViewDirty = true;
+    memset(m_wfbuf, 255, MAX_SCREENSIZE);
+}
+
+/** Clear the waterfall and its history. */
+void CPlotterRenderer::clearWaterfall(void)
+{
+    QMutexLocker locker(&m_WfMutex);
+
+    m_WaterfallImage.fill(qRgb(0, 0, 0));
+    m_WaterfallHead = 0;
+    m_History.clear();
+    m_WfScroll = 0;
+    memset(m_wfbuf, 255, MAX_SCREENSIZE);
+}
+
+/**
+ * Scroll through the waterfall history.
+ * @param lines The number of lines to scroll back (> 0) or forward (< 0).
+ *
+ * The view is limited to the lines in the history; scrolling forward to 0
+ * returns to the live waterfall. The waterfall is drawn again with the next
+ * frame or redraw().
+ */
+void CPlotterRenderer::scrollWaterfall(qint64 lines)
+{
+    QMutexLocker locker(&m_WfMutex);
+    qint64  limit = qMax(0, m_History.count() - m_WaterfallImage.height());
+    int     scroll = (int) qBound((qint64)0, m_WfScroll + lines, limit);
+
+    if (scroll != m_WfScroll)
+    {
+        m_WfScroll = scroll;
+        m_ViewDirty = true;
+    }
+}
+
+/** Set the memory limit of the waterfall history in bytes. */
+void CPlotterRenderer::setWaterfallHistorySize(size_t bytes)
+{
+    QMutexLocker locker(&m_WfMutex);
+
+    m_History.setMaxBytes(bytes);
+
+    // the view may now be beyond the oldest line
+    if (m_WfScroll > 0)
+    {
+        m_WfScroll = qMin(m_WfScroll,
+                          qMax(0, m_History.count() - m_WaterfallImage.height()));
+        m_ViewDirty = true;
+    }
+}
+
+/** Time of the top waterfall line in milliseconds since Epoch. */
+quint64 CPlotterRenderer::lastWaterfallTime(void)
+{
+    QMutexLocker locker(&m_WfMutex);
+
+    if (m_WfScroll > 0 && m_WfScroll < m_History.count())
+        return m_History.line(m_WfScroll).time;
+
+    return m_LastWfTime;
+}
+
+void CPlotterRenderer::run(void)
+{
+    QMutexLocker locker(&m_JobMutex);
+
+    while (true)
+    {
+        while (!m_JobPending && !m_Quit)
+            m_JobCond.wait(&m_JobMutex);
+
+        if (m_Quit)
+            break;
+
+        // take over the job; the buffers are swapped so that neither side
+        // has to reallocate
+        bool    hasData = m_JobHasData;
+
+        m_Params = m_JobParams;
+        if (hasData)
+        {
+            m_FftData.swap(m_JobFftData);
+            m_WfData.swap(m_JobWfData);
+        }
+        m_JobPending = false;
+        m_JobHasData = false;
+
+        locker.unlock();
+        if (hasData)
+            renderFrame();
+        else
+            redrawView();
+        locker.relock();
+    }
+}
+
+/** Compose a frame from the current job and publish it. */
+void CPlotterRenderer::renderFrame(void)
+{
+    QImage          frame;
+    QMap<int,int>   peaks;
+    int             size = m_FftData.size();
+
+    if (size == 0)
+        return;
+
+    drawWaterfallLine(m_WfData.empty() ? &m_FftData[0] : &m_WfData[0], size);
+    drawPandapter(&m_FftData[0], size, frame, peaks);
+    publishFrame(frame, peaks);
+}
+
+/** Draw the waterfall from history if the view has changed. */
+void CPlotterRenderer::redrawView(void)
+{
+    if (m_Params.resetPeakHold)
+        m_PeakHoldValid = false;
+
+    m_WfMutex.lock();
+    if (!m_WaterfallImage.isNull() && viewChanged())
+        drawHistory();
+    m_WfMutex.unlock();
+
+    // the pandapter is unchanged
+    publishFrame(QImage(), QMap<int,int>());
+}
+
+/** Hand a frame to the GUI; a null frame only updates the waterfall. */
+void CPlotterRenderer::publishFrame(const QImage &frame,
+                                    const QMap<int,int> &peaks)
+{
+    QMutexLocker locker(&m_FrameMutex);
+
+    // replaces the previous frame if the GUI has not taken it yet
+    if (!frame.isNull() || !m_FrameReady)
+    {
+        m_Frame = frame;
+        m_FramePeaks = peaks;
+    }
+    if (!m_FrameReady)
+    {
+        m_FrameReady = true;
+        emit frameReady();
+    }
+}
+
+/** Add the data to the waterfall. */
+void CPlotterRenderer::drawWaterfallLine(const float *wfData, int size)
+{
+    int     i, n;
+    int     w, h;
+    int     xmin, xmax;
+
+    m_WfMutex.lock();
+    w = m_WaterfallImage.width();
+    h = m_WaterfallImage.height();
+    m_WfMutex.unlock();
+
+    // no need to draw if pixmap is invisible
+    if (w == 0 || h == 0)
+        return;
+
+    // get scaled FFT data
+    n = qMin(w, MAX_SCREENSIZE);
+    getScreenIntegerFFTData(255, n, m_Params.wfMaxdB, m_Params.wfMindB,
+                            wfData, size, m_fftbuf, &xmin, &xmax);
+    accumulateHistory(wfData, size);
+
+    QMutexLocker locker(&m_WfMutex);
+
+    // resized in the meantime, drop the data
+    if (m_WaterfallImage.width() != w || m_WaterfallImage.height() != h)
+        return;
+
+    if (m_Params.msecPerWfLine > 0)
+    {
+        // not in "auto" mode, so accumulate waterfall data
+        for (i = 0; i < n; i++)
+        {
+            // average
+            //m_wfbuf[i] = (m_wfbuf[i] + m_fftbuf[i]) / 2;
+
+            // peak (0..255 where 255 is min)
+            if (m_fftbuf[i] < m_wfbuf[i])
+                m_wfbuf[i] = m_fftbuf[i];
+        }
+    }
+
+    // is it time to update waterfall?
+    if (m_Params.timestamp - m_LastWfTime >= m_Params.msecPerWfLine)
+    {
+        m_LastWfTime = m_Params.timestamp;
+
+        m_History.add(&m_HistAcc[0], m_HistAcc.size(), m_HistStart,
+                      m_HistStep, m_LastWfTime);
+        std::fill(m_HistAcc.begin(), m_HistAcc.end(), -1.0e30f);
+
+        if (m_WfScroll > 0)
+        {
+            // scrolled back: keep showing the same lines unless the
+            // oldest one has been dropped from the history
+            if (m_WfScroll + h < m_History.count())
+                m_WfScroll++;
+            else
+                m_ViewDirty = true;
+            memset(m_wfbuf, 255, MAX_SCREENSIZE);
+            if (viewChanged())
+                drawHistory();
+            return;
+        }
+
+        // the new line replaces the oldest one in the ring buffer
+        m_WaterfallHead = (m_WaterfallHead + h - 1) % h;
+
+        // write new line of fft data into the waterfall image
+        QRgb *line = (QRgb *) m_WaterfallImage.scanLine(m_WaterfallHead);
+
+        for (i = 0; i < xmin; i++)
+            line[i] = m_ColorTbl[0];
+        for (i = xmax; i < w; i++)
+            line[i] = m_ColorTbl[0];
+
+        if (m_Params.msecPerWfLine > 0)
+        {
+            // user set time span
+            for (i = xmin; i < xmax; i++)
+            {
+                line[i] = m_ColorTbl[255 - m_wfbuf[i]];
+                m_wfbuf[i] = 255;
+            }
+        }
+        else
+        {
+            for (i = xmin; i < xmax; i++)
+                line[i] = m_ColorTbl[255 - m_fftbuf[i]];
+        }
+    }
+
+    // zoomed, panned, new dB range, ...
+    if (viewChanged())
+        drawHistory();
+}
+
+/**
+ * Reduce the waterfall data to at most WF_HISTORY_POINTS points and keep
+ * the strongest level of each point until the next waterfall line.
+ */
+void CPlotterRenderer::accumulateHistory(const float *wfData, int size)
+{
+    unsigned int    i;
+
+    if (size != m_HistSize ||
+        m_Params.centerFreq != m_HistParams.centerFreq ||
+        m_Params.fftDataCenter != m_HistParams.fftDataCenter ||
+        m_Params.fftDataRate != m_HistParams.fftDataRate ||
+        m_Params.sampleRate != m_HistParams.sampleRate ||
+        m_Params.halfSpectrum != m_HistParams.halfSpectrum)
+    {
+        // same bin frequencies as in updateBinMap()
+        float   binsPerFs = m_Params.halfSpectrum ? 2.0f * (size - 1) : (float)size;
+        qint32  dcBin = m_Params.halfSpectrum ? 0 : size/2;
+        float   dataRate = m_Params.fftDataRate > 0.f ? m_Params.fftDataRate : m_Params.sampleRate;
+        double  binHz = dataRate / binsPerFs;
+        unsigned int    decim = (size + WF_HISTORY_POINTS - 1) / WF_HISTORY_POINTS;
+        unsigned int    points = (size + decim - 1) / decim;
+
+        m_HistParams = m_Params;
+        m_HistParams.overlay = QImage();
+        m_HistSize = size;
+        m_HistStart = m_Params.centerFreq + m_Params.fftDataCenter -
+                      (qint64)(dcBin * binHz);
+        m_HistStep = decim * binHz;
+        m_HistEdges.resize(points + 1);
+        for (i = 0; i < points; i++)
+            m_HistEdges[i] = i * decim;
+        m_HistEdges[points] = size;
+        m_HistAcc.assign(points, -1.0e30f);
+        m_HistTmp.resize(points);
+    }
+
+    spectrum_max_ranges(wfData, &m_HistEdges[0], m_HistTmp.size(), &m_HistTmp[0]);
+    for (i = 0; i < m_HistTmp.size(); i++)
+        if (m_HistTmp[i] > m_HistAcc[i])
+            m_HistAcc[i] = m_HistTmp[i];
+}
+
+/** Whether the waterfall must be drawn from history (m_WfMutex held). */
+bool CPlotterRenderer::viewChanged(void) const
+{
+    return m_ViewDirty ||
+           m_ViewStart != m_Params.centerFreq + m_Params.startFreq ||
+           m_ViewStop != m_Params.centerFreq + m_Params.stopFreq ||
+           m_ViewMaxdB != m_Params.wfMaxdB ||
+           m_ViewMindB != m_Params.wfMindB;
+}
+
+/**
+ * Draw the visible part of the waterfall from history (m_WfMutex held).
+ *
+ * Like getScreenIntegerFFTData(), each pixel shows the strongest point that
+ * falls on it, or the nearest point when there are fewer points than pixels.
+ */
+void CPlotterRenderer::drawHistory(void)
+{
+    int     w = m_WaterfallImage.width();
+    int     h = m_WaterfallImage.height();
+    int     x, y, r, k;
+    qint64  start = m_Params.centerFreq + m_Params.startFreq;
+    double  pixHz = (double)(m_Params.stopFreq - m_Params.startFreq) / w;
+    float   dBGainFactor = 255.f / fabs(m_Params.wfMaxdB - m_Params.wfMindB);
+    qint64  mapStart = 0;
+    double  mapStep = 0.0;
+    int     mapPoints = -1;
+
+    m_ViewStart = start;
+    m_ViewStop = m_Params.centerFreq + m_Params.stopFreq;
+    m_ViewMaxdB = m_Params.wfMaxdB;
+    m_ViewMindB = m_Params.wfMindB;
+    m_ViewDirty = false;
+
+    m_HistFirst.resize(w);
+    m_HistEnd.resize(w);
+    m_WaterfallHead = 0;
+
+    for (r = 0; r < h; r++)
+    {
+        QRgb   *line = (QRgb *) m_WaterfallImage.scanLine(r);
+
+        if (m_WfScroll + r >= m_History.count())
+        {
+            for (x = 0; x < w; x++)
+                line[x] = m_ColorTbl[0];
+            continue;
+        }
+
+        const CWaterfallLine &hl = m_History.line(m_WfScroll + r);
+        int     points = hl.level.size();
+
+        // consecutive lines usually share the same points
+        if (hl.startFreq != mapStart || hl.step != mapStep || points != mapPoints)
+        {
+            mapStart = hl.startFreq;
+            mapStep = hl.step;
+            mapPoints = points;
+
+            for (x = 0; x < w; x++)
+            {
+                double  p0 = (start + x * pixHz - mapStart) / mapStep;
+                double  p1 = (start + (x + 1) * pixHz - mapStart) / mapStep;
+                qint64  first = (qint64) ceil(p0);
+                qint64  end = (qint64) ceil(p1);
+
+                if (end <= first)
+                {
+                    first = (qint64) floor(p0);
+                    end = first + 1;
+                }
+                m_HistFirst[x] = (qint32) qBound((qint64)0, first, (qint64)points);
+                m_HistEnd[x] = (qint32) qBound((qint64)0, end, (qint64)points);
+            }
+        }
+
+        for (x = 0; x < w; x++)
+        {
+            if (m_HistFirst[x] >= m_HistEnd[x])
+            {
+                // no data at this frequency
+                line[x] = m_ColorTbl[0];
+                continue;
+            }
+
+            qint16  level = hl.level[m_HistFirst[x]];
+
+            for (k = m_HistFirst[x] + 1; k < m_HistEnd[x]; k++)
+                if (hl.level[k] > level)
+                    level = hl.level[k];
+
+            y = (qint32)(dBGainFactor*(m_Params.wfMaxdB - 0.01f * level));
+            if (y > 255)
+                y = 255;
+            else if (y < 0)
+                y = 0;
+
+            line[x] = m_ColorTbl[255 - y];
+        }
+    }
+}
+
+/** Draw the pandapter, peaks and peak hold on a copy of the overlay. */
+void CPlotterRenderer::drawPandapter(const float *fftData, int size,
+                                     QImage &frame, QMap<int,int> &peaks)
+{
+    int     i, n;
+    int     w = m_Params.overlay.width();
+    int     h = m_Params.overlay.height();
+    int     xmin, xmax;
+
+    if (w == 0 || h == 0)
+        return;
+
+    // first copy the overlay into the frame
+    frame = m_Params.overlay.copy(0, 0, w, h);
+
+    QPainter painter2(&frame);
+
+// workaround for "fixed" line drawing since Qt 5
+// see http://stackoverflow.com/questions/16990326
+#if QT_VERSION >= 0x050000
+    painter2.translate(0.5, 0.5);
+#endif
+
+    // get new scaled fft data
+    getScreenIntegerFFTData(h, qMin(w, MAX_SCREENSIZE),
+                            m_Params.pandMaxdB, m_Params.pandMindB,
+                            fftData, size, m_fftbuf, &xmin, &xmax);
+
+    // draw the pandapter
+    painter2.setPen(m_Params.fftColor);
+    n = xmax - xmin;
+    for (i = 0; i < n; i++)
+    {
+        m_LineBuf[i].setX(i + xmin);
+        m_LineBuf[i].setY(m_fftbuf[i + xmin]);
+    }
+
+    if (m_Params.fftFill)
+    {
+        painter2.setBrush(QBrush(m_Params.fftFillColor, Qt::SolidPattern));
+        if (n < MAX_SCREENSIZE-2)
+        {
+            m_LineBuf[n].setX(xmax-1);
+            m_LineBuf[n].setY(h);
+            m_LineBuf[n+1].setX(xmin);
+            m_LineBuf[n+1].setY(h);
+            painter2.drawPolygon(m_LineBuf, n+2);
+        }
+        else
+        {
+            m_LineBuf[MAX_SCREENSIZE-2].setX(xmax-1);
+            m_LineBuf[MAX_SCREENSIZE-2].setY(h);
+            m_LineBuf[MAX_SCREENSIZE-1].setX(xmin);
+            m_LineBuf[MAX_SCREENSIZE-1].setY(h);
+            painter2.drawPolygon(m_LineBuf, n);
+        }
+    }
+    else
+    {
+        painter2.drawPolyline(m_LineBuf, n);
+    }
+
+    // Peak detection
+    if (m_Params.peakDetection > 0)
+    {
+        float   mean = 0;
+        float   sum_of_sq = 0;
+        for (i = 0; i < n; i++)
+        {
+            mean += m_fftbuf[i + xmin];
+            sum_of_sq += m_fftbuf[i + xmin] * m_fftbuf[i + xmin];
+        }
+        mean /= n;
+        float stdev= sqrt(sum_of_sq / n - mean * mean );
+
+        int lastPeak = -1;
+        for (i = 0; i < n; i++)
+        {
+            //peakDetection times the std over the mean or better than current peak
+            float d = (lastPeak == -1) ? (mean - m_Params.peakDetection * stdev) :
+                                       m_fftbuf[lastPeak + xmin];
+
+            if (m_fftbuf[i + xmin] < d)
+                lastPeak=i;
+
+            if (lastPeak != -1 &&
+                    (i - lastPeak > PEAK_H_TOLERANCE || i == n-1))
+            {
+                peaks.insert(lastPeak + xmin, m_fftbuf[lastPeak + xmin]);
+                painter2.drawEllipse(lastPeak + xmin - 5,
+                                     m_fftbuf[lastPeak + xmin] - 5, 10, 10);
+                lastPeak = -1;
+            }
+        }
+    }
+
+    // Peak hold
+    if (m_Params.resetPeakHold)
+        m_PeakHoldValid = false;
+
+    if (m_Params.peakHold)
+    {
+        for (i = 0; i < n; i++)
+        {
+            if(!m_PeakHoldValid || m_fftbuf[i] < m_fftPeakHoldBuf[i])
+                m_fftPeakHoldBuf[i] = m_fftbuf[i];
+
+            m_LineBuf[i].setX(i + xmin);
+            m_LineBuf[i].setY(m_fftPeakHoldBuf[i + xmin]);
+        }
+        painter2.setPen(m_Params.peakHoldColor);
+        painter2.drawPolyline(m_LineBuf, n);
+
+        m_PeakHoldValid = true;
+    }
+
+    painter2.end();
+}
+
+/** Get the waterfall with the newest line at the top (m_WfMutex held). */
+QImage CPlotterRenderer::linearWaterfall(void) const
+{
+    int     h = m_WaterfallImage.height();
+    int     bpl = m_WaterfallImage.bytesPerLine();
+
+    if (m_WaterfallHead == 0)
+        return m_WaterfallImage.copy();
+
+    QImage  image(m_WaterfallImage.size(), m_WaterfallImage.format());
+
+    memcpy(image.scanLine(0), m_WaterfallImage.constScanLine(m_WaterfallHead),
+           (h - m_WaterfallHead) * bpl);
+    memcpy(image.scanLine(h - m_WaterfallHead), m_WaterfallImage.constScanLine(0),
+           m_WaterfallHead * bpl);
+
+    return image;
+}
+
+/**
+ * Update the bin to pixel mapping if the FFT size, frequency range or plot
+ * width have changed.
+ *
+ * With more FFT bins than pixels, each pixel x in m_MapXmin...m_MapXmax covers
+ * the bins m_MapEdges[x - m_MapXmin] ... m_MapEdges[x - m_MapXmin + 1] - 1.
+ * Otherwise m_MapBins holds the bin shown at each pixel, which may be outside
+ * the FFT data.
+ */
+void CPlotterRenderer::updateBinMap(qint32 plotWidth, qint32 size)
+{
+    if (size == m_MapSize && plotWidth == m_MapWidth &&
+        m_Params.startFreq == m_MapParams.startFreq &&
+        m_Params.stopFreq == m_MapParams.stopFreq &&
+        m_Params.fftDataCenter == m_MapParams.fftDataCenter &&
+        m_Params.fftDataRate == m_MapParams.fftDataRate &&
+        m_Params.sampleRate == m_MapParams.sampleRate &&
+        m_Params.halfSpectrum == m_MapParams.halfSpectrum)
+        return;
+
+    qint32 i;
+    qint32 x;
+    qint32 xprev = -1;
+    qint32 minbin, maxbin;
+    qint32 binMin, binMax;
+
+    // a half spectrum (real FFT) goes from DC to half the sample rate in
+    // size - 1 steps; a full spectrum has DC in the middle
+    float  binsPerFs = m_Params.halfSpectrum ? 2.0f * (size - 1) : (float)size;
+    qint32 dcBin = m_Params.halfSpectrum ? 0 : size/2;
+    float  dataRate = m_Params.fftDataRate > 0.f ? m_Params.fftDataRate : m_Params.sampleRate;
+
+    // the data may cover only part of the band (zoom spectrum)
+    qint64 startFreq = m_Params.startFreq - m_Params.fftDataCenter;
+    qint64 stopFreq = m_Params.stopFreq - m_Params.fftDataCenter;
+
+    /** FIXME: qint64 -> qint32 **/
+    binMin = (qint32)((float)startFreq * binsPerFs / dataRate);
+    binMin += dcBin;
+    binMax = (qint32)((float)stopFreq * binsPerFs / dataRate);
+    binMax += dcBin;
+
+    minbin = binMin < 0 ? 0 : binMin;
+    if (binMin > size)
+        binMin = size - 1;
+    if (binMax <= binMin)
+        binMax = binMin + 1;
+    maxbin = binMax < size ? binMax : size;
+
+    m_MapParams = m_Params;
+    m_MapParams.overlay = QImage();
+    m_MapWidth = plotWidth;
+    m_MapSize = size;
+    m_MapLargeFft = (binMax - binMin) > plotWidth; // true if more fft point than plot points
+
+    if (m_MapLargeFft)
+    {
+        // more FFT points than plot points; every pixel between the first
+        // and the last bin gets at least one bin
+        m_MapEdges.clear();
+        m_MapXmin = 0;
+        m_MapXmax = 0;
+        for (i = minbin; i < maxbin; i++)
+        {
+            x = ((qint64)(i - binMin) * plotWidth) / (binMax - binMin);
+            if (x != xprev)
+            {
+                if (xprev < 0)
+                    m_MapXmin = x;
+                m_MapEdges.push_back(i);
+                xprev = x;
+            }
+        }
+        if (xprev >= 0)
+        {
+            m_MapXmax = xprev;
+            m_MapEdges.push_back(maxbin);
+        }
+        m_MapMax.resize(m_MapEdges.size());
+    }
+    else
+    {
+        // more plot points than FFT points
+        m_MapBins.resize(plotWidth);
+        for (i = 0; i < plotWidth; i++)
+            m_MapBins[i] = binMin + (i*(binMax - binMin)) / plotWidth;
+        m_MapXmin = 0;
+        m_MapXmax = plotWidth;
+    }
+}
+
+/**
+ * Scale FFT data to screen coordinates.
+ * @param plotHeight The height of the plot; y = 0 is maxdB, plotHeight is mindB.
+ * @param plotWidth The number of pixels.
+ * @param maxdB The level at the top of the plot.
+ * @param mindB The level at the bottom of the plot.
+ * @param inBuf The FFT data in dB.
+ * @param size The FFT size.
+ * @param outBuf The y coordinate of each pixel (output).
+ * @param xmin The first pixel with data (output).
+ * @param xmax The end of the pixels with data (output).
+ *
+ * When several bins fall on one pixel, the strongest one is shown.
+ */
+void CPlotterRenderer::getScreenIntegerFFTData(qint32 plotHeight, qint32 plotWidth,
+                                               float maxdB, float mindB,
+                                               const float *inBuf, qint32 size,
+                                               qint32 *outBuf,
+                                               qint32 *xmin, qint32 *xmax)
+{
+    qint32 i;
+    qint32 y;
+    qint32 x;
+    float  dBGainFactor = ((float)plotHeight) / fabs(maxdB - mindB);
+
+    updateBinMap(plotWidth, size);
+
+    *xmin = m_MapXmin;
+    *xmax = m_MapXmax;
+
+    if (m_MapLargeFft)
+    {
+        qint32 n = m_MapEdges.size() - 1;
+
+        if (n <= 0)
+            return;
+
+        // more FFT points than plot points, keep the strongest bin
+        spectrum_max_ranges(inBuf, &m_MapEdges[0], n, &m_MapMax[0]);
+        for (x = 0; x < n; x++)
+        {
+            y = (qint32)(dBGainFactor*(maxdB-m_MapMax[x]));
+
+            if (y > plotHeight)
+                y = plotHeight;
+            else if (y < 0)
+                y = 0;
+
+            outBuf[x + m_MapXmin] = y;
+        }
+    }
+    else
+    {
+        // more plot points than FFT points
+        for (x = 0; x < plotWidth; x++)
+        {
+            i = m_MapBins[x]; // get plot to fft bin coordinate transform
+            if (i < 0 || i >= size)
+                y = plotHeight;
+            else
+                y = (qint32)(dBGainFactor*(maxdB-inBuf[i]));
+
+            if (y > plotHeight)
+                y = plotHeight;
+            else if (y < 0)
+                y = 0;
+
+            outBuf[x] = y;
+        }
+    }
+}
@@ -0,0 +1,205 @@
+/* -*- c++ -*- */
+/* + + +   This Software is released under the "Simplified BSD License"  + + +
+ * Copyright 2010 Moe Wheatley. All rights reserved.
+ * Copyright 2011-2013 Alexandru Csete OZ9AEC
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are
+ * permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice, this list of
+ *       conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright notice, this list
+ *       of conditions and the following disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Moe Wheatley ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL Moe Wheatley OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those of the
+ * authors and should not be interpreted as representing official policies, either expressed
+ * or implied, of Moe Wheatley.
+ */
+#ifndef PLOTTER_RENDERER_H
+#define PLOTTER_RENDERER_H
+
+#include <QColor>
+#include <QImage>
+#include <QMap>
+#include <QMutex>
+#include <QPoint>
+#include <QThread>
+#include <QWaitCondition>
+#include <vector>
+#include "waterfall_history.h"
+
+#define MAX_SCREENSIZE 16384
+
+#define PEAK_H_TOLERANCE 2
+
+class QPainter;
+
+/** Everything needed to compose one frame, taken from the plotter. */
+struct CPlotterParams
+{
+    qint64      centerFreq;     /*!< Hardware center frequency. */
+    qint64      startFreq;      /*!< Left edge of the plot relative to the center. */
+    qint64      stopFreq;       /*!< Right edge of the plot relative to the center. */
+    qint64      fftDataCenter;  /*!< Center of the FFT data relative to the center. */
+    float       fftDataRate;    /*!< Frequency range of the FFT data, 0 for sampleRate. */
+    float       sampleRate;
+    bool        halfSpectrum;   /*!< FFT data starts at DC (real FFT). */
+    float       pandMaxdB;
+    float       pandMindB;
+    float       wfMaxdB;
+    float       wfMindB;
+    QColor      fftColor;
+    QColor      fftFillColor;
+    QColor      peakHoldColor;
+    bool        fftFill;
+    bool        peakHold;
+    bool        resetPeakHold;  /*!< Restart peak hold with this frame. */
+    float       peakDetection;  /*!< Peak detection threshold, <= 0 when disabled. */
+    quint64     msecPerWfLine;  /*!< Time per waterfall line, 0 for one line per frame. */
+    quint64     timestamp;      /*!< Time of the FFT data in ms since Epoch. */
+    QImage      overlay;        /*!< Grid, scales and markers of the pandapter. */
+};
+
+/**
+ * Render thread of the plotter.
+ *
+ * The plotter hands the latest FFT data and its parameters to render(), which
+ * only copies them and returns. The thread maps the data to screen
+ * coordinates, adds a line to the waterfall and draws the pandapter on a copy
+ * of the overlay image. Completed frames are announced with frameReady() and
+ * picked up in the GUI thread using takeFrame().
+ *
+ * Only the latest data is kept: when new data arrives before the thread has
+ * started on the previous data, or before the GUI has taken the previous
+ * frame, the older one is dropped. A slow display thus lowers the frame rate
+ * instead of building up a queue.
+ *
+ * The waterfall image is owned by the renderer and protected by its own
+ * mutex, so the GUI can draw it while the next frame is being composed.
+ * Every waterfall line is also stored in a CWaterfallHistory. When the
+ * frequency or dB range of the waterfall changes, or the user scrolls back
+ * using scrollWaterfall(), the visible lines are drawn again from the
+ * history. While scrolled back, new lines go to the history only and the
+ * view stays on the same lines.
+ */
+class CPlotterRenderer : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit CPlotterRenderer(QObject *parent = 0);
+    ~CPlotterRenderer();
+
+    void    render(const CPlotterParams &params, const float *fftData,
+                   const float *wfData, int size);
+    void    redraw(const CPlotterParams &params);
+    bool    takeFrame(QImage &frame, QMap<int,int> &peaks);
+
+    void    drawWaterfall(QPainter &painter, int y);
+    QImage  waterfallImage(void);
+    void    resizeWaterfall(int width, int height);
+    void    clearWaterfall(void);
+    void    scrollWaterfall(qint64 lines);
+    void    setWaterfallHistorySize(size_t bytes);
+    quint64 lastWaterfallTime(void);
+
+signals:
+    void    frameReady(void);
+
+protected:
+    void    run(void);
+
+private:
+    void    renderFrame(void);
+    void    redrawView(void);
+    void    publishFrame(const QImage &frame, const QMap<int,int> &peaks);
+    void    accumulateHistory(const float *wfData, int size);
+    bool    viewChanged(void) const;
+    void    drawHistory(void);
+    void    drawWaterfallLine(const float *wfData, int size);
+    void    drawPandapter(const float *fftData, int size, QImage &frame,
+                          QMap<int,int> &peaks);
+    QImage  linearWaterfall(void) const;
+    void    updateBinMap(qint32 plotWidth, qint32 size);
+    void    getScreenIntegerFFTData(qint32 plotHeight, qint32 plotWidth,
+                                    float maxdB, float mindB,
+                                    const float *inBuf, qint32 size,
+                                    qint32 *outBuf,
+                                    qint32 *xmin, qint32 *xmax);
+
+    /* pending job, protected by m_JobMutex */
+    QMutex          m_JobMutex;
+    QWaitCondition  m_JobCond;
+    bool            m_JobPending;
+    bool            m_JobHasData;       /*!< FALSE if only the view has changed. */
+    bool            m_Quit;
+    CPlotterParams  m_JobParams;
+    std::vector<float>  m_JobFftData;
+    std::vector<float>  m_JobWfData;    /*!< Empty if same as m_JobFftData. */
+
+    /* current job, only used by the render thread */
+    CPlotterParams  m_Params;
+    std::vector<float>  m_FftData;
+    std::vector<float>  m_WfData;
+    qint32          m_fftbuf[MAX_SCREENSIZE];
+    qint32          m_fftPeakHoldBuf[MAX_SCREENSIZE];
+    bool            m_PeakHoldValid;
+    QPoint          m_LineBuf[MAX_SCREENSIZE];
+    QRgb            m_ColorTbl[256];    /*!< Waterfall palette, indexed by level. */
+
+    /* bin to pixel mapping of the current job, see updateBinMap() */
+    CPlotterParams  m_MapParams;        /*!< Parameters the map was made for. */
+    qint32          m_MapWidth;
+    qint32          m_MapSize;          /*!< FFT size, 0 if there is no map. */
+    bool            m_MapLargeFft;      /*!< More FFT bins than pixels. */
+    qint32          m_MapXmin;
+    qint32          m_MapXmax;
+    std::vector<unsigned int>   m_MapEdges; /*!< First bin of each pixel (large FFT). */
+    std::vector<qint32>         m_MapBins;  /*!< Bin of each pixel (small FFT). */
+    std::vector<float>          m_MapMax;   /*!< Largest value of each pixel. */
+
+    /* reduction of the FFT data to history lines, see accumulateHistory() */
+    CPlotterParams  m_HistParams;       /*!< Parameters the reduction was made for. */
+    int             m_HistSize;         /*!< FFT size, 0 if not set up. */
+    qint64          m_HistStart;        /*!< Frequency of the first point. */
+    double          m_HistStep;         /*!< Frequency step between points. */
+    std::vector<unsigned int>   m_HistEdges;    /*!< First bin of each point. */
+    std::vector<float>          m_HistAcc;      /*!< Strongest level since the last line. */
+    std::vector<float>          m_HistTmp;
+    std::vector<qint32>         m_HistFirst;    /*!< First point of each pixel. */
+    std::vector<qint32>         m_HistEnd;      /*!< End of the points of each pixel. */
+
+    /* waterfall, protected by m_WfMutex */
+    QMutex          m_WfMutex;
+    QImage          m_WaterfallImage;   /*!< Waterfall lines as a ring buffer (RGB32). */
+    int             m_WaterfallHead;    /*!< Row of the newest waterfall line. */
+    quint8          m_wfbuf[MAX_SCREENSIZE]; // used for accumulating waterfall data at high time spans
+    quint64         m_LastWfTime;       /*!< Time of the newest waterfall line. */
+    CWaterfallHistory   m_History;
+    int             m_WfScroll;         /*!< Lines scrolled back, 0 for live view. */
+    bool            m_ViewDirty;        /*!< Waterfall must be drawn from history. */
+    qint64          m_ViewStart;        /*!< Frequency range of the waterfall. */
+    qint64          m_ViewStop;
+    float           m_ViewMaxdB;        /*!< dB range of the waterfall. */
+    float           m_ViewMindB;
+
+    /* completed frame, protected by m_FrameMutex */
+    QMutex          m_FrameMutex;
+    bool            m_FrameReady;
+    QImage          m_Frame;
+    QMap<int,int>   m_FramePeaks;
+};
+
+#endif // PLOTTER_RENDERER_H
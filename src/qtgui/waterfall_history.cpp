@@ -0,0 +1,92 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <cmath>
+#include "waterfall_history.h"
+
+
+CWaterfallHistory::CWaterfallHistory()
+{
+    m_Bytes = 0;
+    m_MaxBytes = WF_HISTORY_MAX_BYTES;
+}
+
+/** Set the memory limit, dropping the oldest lines if necessary. */
+void CWaterfallHistory::setMaxBytes(size_t bytes)
+{
+    m_MaxBytes = bytes;
+
+    while (!m_Lines.empty() && m_Bytes > m_MaxBytes)
+    {
+        m_Bytes -= m_Lines.front().level.size() * sizeof(qint16);
+        m_Lines.pop_front();
+    }
+}
+
+void CWaterfallHistory::clear(void)
+{
+    m_Lines.clear();
+    m_Bytes = 0;
+}
+
+/**
+ * Add a line.
+ * @param data The level of each point in dB.
+ * @param num The number of points.
+ * @param startFreq The frequency of the first point in Hz.
+ * @param step The frequency step between points in Hz.
+ * @param time The time of the line in ms since Epoch.
+ *
+ * The storage of the oldest line is reused once the memory limit has been
+ * reached.
+ */
+void CWaterfallHistory::add(const float *data, int num, qint64 startFreq,
+                            double step, quint64 time)
+{
+    std::vector<qint16> storage;
+    size_t      bytes = num * sizeof(qint16);
+    int         i;
+
+    while (!m_Lines.empty() && m_Bytes + bytes > m_MaxBytes)
+    {
+        m_Bytes -= m_Lines.front().level.size() * sizeof(qint16);
+        storage.swap(m_Lines.front().level);
+        m_Lines.pop_front();
+    }
+
+    if (bytes > m_MaxBytes)
+        return;
+
+    m_Lines.push_back(CWaterfallLine());
+
+    CWaterfallLine &line = m_Lines.back();
+
+    line.time = time;
+    line.startFreq = startFreq;
+    line.step = step;
+    line.level.swap(storage);
+    line.level.resize(num);
+    for (i = 0; i < num; i++)
+        line.level[i] = (qint16) qBound(-32768.f, roundf(100.f * data[i]), 32767.f);
+
+    m_Bytes += bytes;
+}
@@ -0,0 +1,87 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef WATERFALL_HISTORY_H
+#define WATERFALL_HISTORY_H
+
+#include <QtGlobal>
+#include <deque>
+#include <vector>
+
+/* Largest number of points stored per line. */
+#define WF_HISTORY_POINTS    4096
+
+/* Default memory limit of the history, see [gui] waterfall_history_mb. */
+#define WF_HISTORY_MAX_BYTES (64 * 1024 * 1024)
+
+/** One line of the waterfall history. */
+struct CWaterfallLine
+{
+    quint64     time;       /*!< Time of the line in ms since Epoch. */
+    qint64      startFreq;  /*!< Frequency of the first point in Hz. */
+    double      step;       /*!< Frequency step between points in Hz. */
+    std::vector<qint16> level;  /*!< Level of each point in 1/100 dB. */
+};
+
+/**
+ * Waterfall history.
+ *
+ * The history keeps the waterfall lines as spectrum levels rather than
+ * colors, so they can be drawn again after the frequency range or the dB
+ * range of the waterfall has changed, and the user can scroll back beyond
+ * the visible part of the waterfall.
+ *
+ * Each line covers the whole FFT data. Spectra with more than
+ * WF_HISTORY_POINTS bins are reduced by keeping the strongest bin of each
+ * group, and levels are stored as 16 bit integers in 1/100 dB. When the
+ * memory limit is reached the oldest lines are dropped; at the default of
+ * 64 MB the history holds more than 8000 lines. A limit of 0 disables the
+ * history.
+ *
+ * The history is not thread safe.
+ */
+class CWaterfallHistory
+{
+public:
+    CWaterfallHistory();
+
+    void    setMaxBytes(size_t bytes);
+    void    clear(void);
+    void    add(const float *data, int num, qint64 startFreq, double step,
+                quint64 time);
+
+    /** Number of lines in the history. */
+    int     count(void) const { return m_Lines.size(); }
+
+    /** Get a line, age 0 is the newest one. */
+    const CWaterfallLine &line(int age) const
+    {
+        return m_Lines[m_Lines.size() - 1 - age];
+    }
+
+private:
+    std::deque<CWaterfallLine>  m_Lines;
+    size_t      m_Bytes;        /*!< Memory used by the levels. */
+    size_t      m_MaxBytes;
+};
+
+#endif // WATERFALL_HISTORY_H
@@ -51,33 +51,63 @@ nbrx::nbrx(float quad_rate, float audio_rate)
     demod_fm = make_rx_demod_fm(PREF_QUAD_RATE, PREF_AUDIO_RATE, 5000.0, 75.0e-6);
     demod_am = make_rx_demod_am(PREF_QUAD_RATE, PREF_AUDIO_RATE, true);
 
-    audio_rr.reset();
+    audio_rr0.reset();
+    audio_rr1.reset();
     if (d_audio_rate != PREF_AUDIO_RATE)
     {
         std::cout << "Resampling audio " << PREF_AUDIO_RATE << " -> "
                   << d_audio_rate << std::endl;
-        audio_rr = make_resampler_ff(d_audio_rate/PREF_AUDIO_RATE);
+        audio_rr0 = make_resampler_ff(d_audio_rate/PREF_AUDIO_RATE);
+        audio_rr1 = make_resampler_ff(d_audio_rate/PREF_AUDIO_RATE);
+    }
+
+    /* All demodulators are connected and the output is selected using
+     * demod_sel, so switching demodulator does not require the flow graph
+     * to be stopped. The input of the unused demodulators is cut off using
+     * disabled copy blocks so that only the selected one does any work.
+     */
+    demod_sel = make_stream_selector(sizeof(float), NBRX_DEMOD_NUM, 2);
+    demod_sel->set_group(d_demod);
+    for (int i = 0; i < NBRX_DEMOD_NUM; i++)
+    {
+        demod_valve[i] = gr::blocks::copy::make(sizeof(gr_complex));
+        demod_valve[i]->set_enabled(i == d_demod);
     }
 
-    demod = demod_fm;
     connect(self(), 0, iq_resamp, 0);
     connect(iq_resamp, 0, nb, 0);
     connect(nb, 0, filter, 0);
     connect(filter, 0, meter, 0);
     connect(filter, 0, sql, 0);
     connect(sql, 0, agc, 0);
-    connect(agc, 0, demod, 0);
-
-    if (audio_rr)
+    for (int i = 0; i < NBRX_DEMOD_NUM; i++)
+        connect(agc, 0, demod_valve[i], 0);
+    connect(demod_valve[NBRX_DEMOD_NONE], 0, demod_raw, 0);
+    connect(demod_valve[NBRX_DEMOD_SSB], 0, demod_ssb, 0);
+    connect(demod_valve[NBRX_DEMOD_AM], 0, demod_am, 0);
+    connect(demod_valve[NBRX_DEMOD_FM], 0, demod_fm, 0);
+
+    connect(demod_raw, 0, demod_sel, 2 * NBRX_DEMOD_NONE);
+    connect(demod_raw, 1, demod_sel, 2 * NBRX_DEMOD_NONE + 1);
+    connect(demod_am, 0, demod_sel, 2 * NBRX_DEMOD_AM);
+    connect(demod_am, 0, demod_sel, 2 * NBRX_DEMOD_AM + 1);
+    connect(demod_fm, 0, demod_sel, 2 * NBRX_DEMOD_FM);
+    connect(demod_fm, 0, demod_sel, 2 * NBRX_DEMOD_FM + 1);
+    connect(demod_ssb, 0, demod_sel, 2 * NBRX_DEMOD_SSB);
+    connect(demod_ssb, 0, demod_sel, 2 * NBRX_DEMOD_SSB + 1);
+
+    if (audio_rr0)
     {
-        connect(demod, 0, audio_rr, 0);
-        connect(audio_rr, 0, self(), 0); // left  channel
-        connect(audio_rr, 0, self(), 1); // right channel
+        /* both channels are resampled since DEMOD_NONE has I and Q */
+        connect(demod_sel, 0, audio_rr0, 0);
+        connect(demod_sel, 1, audio_rr1, 0);
+        connect(audio_rr0, 0, self(), 0); // left  channel
+        connect(audio_rr1, 0, self(), 1); // right channel
     }
     else
     {
-        connect(demod, 0, self(), 0);
-        connect(demod, 0, self(), 1);
+        connect(demod_sel, 0, self(), 0);
+        connect(demod_sel, 1, self(), 1);
     }
 
 }
@@ -115,6 +145,32 @@ void nbrx::set_audio_rate(float audio_rate)
     (void) audio_rate;
 }
 
+float nbrx::get_pref_quad_rate(void) const
+{
+    return PREF_QUAD_RATE;
+}
+
+/*! \brief Append the performance counters of the demodulator chain. */
+void nbrx::get_perf_stats(block_perf_list &stats, const std::string &prefix) const
+{
+    iq_resamp->get_perf_stats(stats, prefix + "/iq_resamp");
+    block_perf_add(stats, prefix + "/nb", nb);
+    filter->get_perf_stats(stats, prefix + "/filter");
+    block_perf_add(stats, prefix + "/meter", meter);
+    block_perf_add(stats, prefix + "/sql", sql);
+    block_perf_add(stats, prefix + "/agc", agc);
+    block_perf_add(stats, prefix + "/demod_raw", demod_raw);
+    block_perf_add(stats, prefix + "/demod_ssb", demod_ssb);
+    demod_fm->get_perf_stats(stats, prefix + "/demod_fm");
+    demod_am->get_perf_stats(stats, prefix + "/demod_am");
+    block_perf_add(stats, prefix + "/demod_sel", demod_sel);
+    if (audio_rr0)
+    {
+        audio_rr0->get_perf_stats(stats, prefix + "/audio_rr0");
+        audio_rr1->get_perf_stats(stats, prefix + "/audio_rr1");
+    }
+}
+
 void nbrx::set_filter(double low, double high, double tw)
 {
     filter->set_param(low, high, tw);
@@ -190,69 +246,24 @@ void nbrx::set_agc_manual_gain(int gain)
     agc->set_manual_gain(gain);
 }
 
+/*! \brief Select demodulator.
+ *
+ * This only switches the valves and the output selector and can be called
+ * while the flow graph is running.
+ */
 void nbrx::set_demod(int rx_demod)
 {
-    nbrx_demod current_demod = d_demod;
-
     /* check if new demodulator selection is valid */
     if ((rx_demod < NBRX_DEMOD_NONE) || (rx_demod >= NBRX_DEMOD_NUM))
         return;
 
-    if (rx_demod == current_demod) {
-        /* nothing to do */
+    if (rx_demod == d_demod)
         return;
-    }
-
-    disconnect(agc, 0, demod, 0);
-    if (audio_rr)
-        disconnect(demod, 0, audio_rr, 0);
-    else
-    {
-        disconnect(demod, 0, self(), 0);
-        disconnect(demod, 0, self(), 1);
-    }
-
-    switch (rx_demod) {
-
-    case NBRX_DEMOD_NONE:
-        d_demod = NBRX_DEMOD_NONE;
-        demod = demod_raw;
-        break;
-
-    case NBRX_DEMOD_SSB:
-        d_demod = NBRX_DEMOD_SSB;
-        demod = demod_ssb;
-        break;
-
-    case NBRX_DEMOD_AM:
-        d_demod = NBRX_DEMOD_AM;
-        demod = demod_am;
-        break;
-
-    case NBRX_DEMOD_FM:
-    default:
-        d_demod = NBRX_DEMOD_FM;
-        demod = demod_fm;
-        break;
-    }
-
-    connect(agc, 0, demod, 0);
-    if (audio_rr)
-    {
-        // FIXME: DEMOD_NONE has two outputs.
-        connect(demod, 0, audio_rr, 0);
-    }
-    else if (d_demod == NBRX_DEMOD_NONE)
-    {
-        connect(demod, 0, self(), 0);
-        connect(demod, 1, self(), 1);
-    }
-    else
-    {
-        connect(demod, 0, self(), 0);
-        connect(demod, 0, self(), 1);
-    }
 
+    demod_valve[rx_demod]->set_enabled(true);
+    demod_sel->set_group(rx_demod);
+    demod_valve[d_demod]->set_enabled(false);
+    d_demod = (nbrx_demod) rx_demod;
 }
 
 void nbrx::set_fm_maxdev(float maxdev_hz)
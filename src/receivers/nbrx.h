@@ -27,6 +27,7 @@
 #include <gnuradio/basic_block.h>
 #include <gnuradio/blocks/complex_to_float.h>
 #include <gnuradio/blocks/complex_to_real.h>
+#include <gnuradio/blocks/copy.h>
 #include "receivers/receiver_base.h"
 #include "dsp/rx_noise_blanker_cc.h"
 #include "dsp/rx_filter.h"
@@ -36,6 +37,7 @@
 #include "dsp/rx_demod_am.h"
 //#include "dsp/resampler_ff.h"
 #include "dsp/resampler_xx.h"
+#include "dsp/stream_selector.h"
 
 class nbrx;
 
@@ -70,6 +72,9 @@ public:
 
     void set_quad_rate(float quad_rate);
     void set_audio_rate(float audio_rate);
+    float get_pref_quad_rate(void) const;
+
+    void get_perf_stats(block_perf_list &stats, const std::string &prefix) const;
 
     void set_filter(double low, double high, double tw);
     void set_cw_offset(double offset);
@@ -124,9 +129,11 @@ private:
     gr::blocks::complex_to_real::sptr   demod_ssb;  /*!< SSB demodulator. */
     rx_demod_fm_sptr          demod_fm;   /*!< FM demodulator. */
     rx_demod_am_sptr          demod_am;   /*!< AM demodulator. */
-    resampler_ff_sptr         audio_rr;   /*!< Audio resampler. */
+    resampler_ff_sptr         audio_rr0;  /*!< Audio resampler, left channel. */
+    resampler_ff_sptr         audio_rr1;  /*!< Audio resampler, right channel. */
 
-    gr::basic_block_sptr      demod;    // dummy pointer used for simplifying reconf
+    gr::blocks::copy::sptr    demod_valve[NBRX_DEMOD_NUM]; /*!< Stops unused demodulators. */
+    stream_selector_sptr      demod_sel;  /*!< Demodulator output selector. */
 };
 
 #endif // NBRX_H
@@ -156,3 +156,10 @@ bool receiver_base_cf::is_rds_decoder_active()
 {
     return false;
 }
+
+void receiver_base_cf::get_perf_stats(block_perf_list &stats,
+                                      const std::string &prefix) const
+{
+    (void) stats;
+    (void) prefix;
+}
@@ -24,6 +24,7 @@
 #define RECEIVER_BASE_H
 
 #include <gnuradio/hier_block2.h>
+#include "dsp/block_perf.h"
 
 
 class receiver_base_cf;
@@ -54,6 +55,13 @@ public:
     virtual void set_quad_rate(float quad_rate) = 0;
     virtual void set_audio_rate(float audio_rate) = 0;
 
+    /*! \brief Get the rate used internally by the demodulator chain.
+     *
+     * Used to decimate the channel input close to this rate before it
+     * reaches the receiver.
+     */
+    virtual float get_pref_quad_rate(void) const = 0;
+
     virtual void set_filter(double low, double high, double tw) = 0;
     virtual void set_cw_offset(double offset) = 0;
 
@@ -97,6 +105,10 @@ public:
     virtual void reset_rds_parser();
     virtual bool is_rds_decoder_active();
 
+    /* Performance monitoring */
+    virtual void get_perf_stats(block_perf_list &stats,
+                                const std::string &prefix) const;
+
 };
 
 #endif // RECEIVER_BASE_H
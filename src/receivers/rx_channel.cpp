@@ -0,0 +1,219 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <gnuradio/io_signature.h>
+#include "receivers/rx_channel.h"
+
+
+static const int MIN_IN = 1;  /* Mininum number of input streams. */
+static const int MAX_IN = 1;  /* Maximum number of input streams. */
+static const int MIN_OUT = 0; /* Minimum number of output streams. */
+static const int MAX_OUT = 0; /* Maximum number of output streams. */
+
+rx_channel_sptr make_rx_channel(double quad_rate, double audio_rate,
+                                receiver_base_cf_sptr demod)
+{
+    return gnuradio::get_initial_sptr(new rx_channel(quad_rate, audio_rate,
+                                                     demod));
+}
+
+rx_channel::rx_channel(double quad_rate, double audio_rate,
+                       receiver_base_cf_sptr demod)
+    : gr::hier_block2 ("rx_channel",
+                      gr::io_signature::make (MIN_IN, MAX_IN, sizeof(gr_complex)),
+                      gr::io_signature::make (MIN_OUT, MAX_OUT, sizeof(float))),
+      d_quad_rate(quad_rate),
+      d_audio_rate(audio_rate),
+      d_offset(0.0),
+      d_cw_offset(0.0),
+      d_recording_wav(false),
+      d_rx(demod)
+{
+    ddc = make_rx_xlating_filter(d_quad_rate);
+    update_rates();
+
+    audio_gain0 = gr::blocks::multiply_const_ff::make(0.1);
+    audio_gain1 = gr::blocks::multiply_const_ff::make(0.1);
+    audio_null_sink0 = gr::blocks::null_sink::make(sizeof(float));
+    audio_null_sink1 = gr::blocks::null_sink::make(sizeof(float));
+    audio_udp_sink = make_udp_sink_f();
+
+    connect(self(), 0, ddc, 0);
+    connect(ddc, 0, d_rx, 0);
+    connect(d_rx, 0, audio_udp_sink, 0);
+    connect(d_rx, 0, audio_gain0, 0);
+    connect(d_rx, 1, audio_gain1, 0);
+    connect(audio_gain0, 0, audio_null_sink0, 0);
+    connect(audio_gain1, 0, audio_null_sink1, 0);
+}
+
+rx_channel::~rx_channel()
+{
+    if (d_recording_wav)
+        wav_sink->close();
+}
+
+/*! \brief Set new quadrature rate (the rate at the channel input). */
+void rx_channel::set_quad_rate(double quad_rate)
+{
+    d_quad_rate = quad_rate;
+    update_rates();
+}
+
+/*! \brief Set channel offset relative to the RF center frequency. */
+void rx_channel::set_offset(double offset_hz)
+{
+    d_offset = offset_hz;
+    update_offset();
+}
+
+/*! \brief Set CW offset (used as BFO). */
+void rx_channel::set_cw_offset(double offset_hz)
+{
+    d_cw_offset = offset_hz;
+    update_offset();
+    d_rx->set_cw_offset(d_cw_offset);
+}
+
+void rx_channel::update_offset(void)
+{
+    ddc->set_offset(-d_offset + d_cw_offset);
+}
+
+/* Set input decimation according to the demodulator and update its rate. */
+void rx_channel::update_rates(void)
+{
+    ddc->set_channel_rate(d_quad_rate, 2.0 * d_rx->get_pref_quad_rate());
+    d_rx->set_quad_rate(ddc->get_output_rate());
+}
+
+/*! \brief Replace the demodulator chain.
+ *  \param demod The new demodulator (NBRX, WFMRX, ...).
+ *
+ * The new demodulator is expected to be configured for the current audio
+ * rate; the input decimation is adjusted to the new demodulator.
+ */
+void rx_channel::set_demodulator(receiver_base_cf_sptr demod)
+{
+    if (!demod || demod == d_rx)
+        return;
+
+    disconnect(ddc, 0, d_rx, 0);
+    disconnect(d_rx, 0, audio_udp_sink, 0);
+    disconnect(d_rx, 0, audio_gain0, 0);
+    disconnect(d_rx, 1, audio_gain1, 0);
+    if (d_recording_wav)
+    {
+        disconnect(d_rx, 0, wav_sink, 0);
+        disconnect(d_rx, 1, wav_sink, 1);
+    }
+
+    d_rx = demod;
+    d_rx->set_cw_offset(d_cw_offset);
+    update_rates();
+
+    connect(ddc, 0, d_rx, 0);
+    connect(d_rx, 0, audio_udp_sink, 0);
+    connect(d_rx, 0, audio_gain0, 0);
+    connect(d_rx, 1, audio_gain1, 0);
+    if (d_recording_wav)
+    {
+        connect(d_rx, 0, wav_sink, 0);
+        connect(d_rx, 1, wav_sink, 1);
+    }
+}
+
+/*! \brief Set audio gain (linear factor). */
+void rx_channel::set_af_gain(float gain)
+{
+    audio_gain0->set_k(gain);
+    audio_gain1->set_k(gain);
+}
+
+/*! \brief Start streaming channel audio over UDP. */
+void rx_channel::start_udp_streaming(const std::string host, int port)
+{
+    audio_udp_sink->start_streaming(host, port);
+}
+
+/*! \brief Stop streaming channel audio over UDP. */
+void rx_channel::stop_udp_streaming(void)
+{
+    audio_udp_sink->stop_streaming();
+}
+
+/*! \brief Start recording channel audio to a WAV file.
+ *  \param filename The file to record to.
+ *  \return true if the recording has been started.
+ *
+ * As for the main channel, a new WAV sink is created every time a recording
+ * is started; see receiver::start_audio_recording() for the details.
+ */
+bool rx_channel::start_audio_recording(const std::string filename)
+{
+    if (d_recording_wav)
+        return false;
+
+    try {
+        wav_sink = gr::blocks::wavfile_sink::make(filename.c_str(), 2,
+                                                  (unsigned int) d_audio_rate,
+                                                  16);
+    }
+    catch (std::runtime_error &e) {
+        std::cout << "Error opening " << filename << ": " << e.what() << std::endl;
+        return false;
+    }
+
+    connect(d_rx, 0, wav_sink, 0);
+    connect(d_rx, 1, wav_sink, 1);
+    d_recording_wav = true;
+
+    return true;
+}
+
+/*! \brief Stop WAV recording. */
+bool rx_channel::stop_audio_recording(void)
+{
+    if (!d_recording_wav)
+        return false;
+
+    wav_sink->close();
+    disconnect(d_rx, 0, wav_sink, 0);
+    disconnect(d_rx, 1, wav_sink, 1);
+    wav_sink.reset();
+    d_recording_wav = false;
+
+    return true;
+}
+
+/*! \brief Append the performance counters of the channel blocks. */
+void rx_channel::get_perf_stats(block_perf_list &stats,
+                                const std::string &prefix) const
+{
+    ddc->get_perf_stats(stats, prefix + "/ddc");
+    d_rx->get_perf_stats(stats, prefix + "/rx");
+    block_perf_add(stats, prefix + "/audio_gain0", audio_gain0);
+    block_perf_add(stats, prefix + "/audio_gain1", audio_gain1);
+}
@@ -0,0 +1,122 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2016 Alexandru Csete OZ9AEC.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef RX_CHANNEL_H
+#define RX_CHANNEL_H
+
+#include <gnuradio/blocks/multiply_const_ff.h>
+#include <gnuradio/blocks/null_sink.h>
+#include <gnuradio/blocks/wavfile_sink.h>
+#include <gnuradio/hier_block2.h>
+#include <string>
+
+#include "dsp/block_perf.h"
+#include "dsp/rx_filter.h"
+#include "interfaces/udp_sink_f.h"
+#include "receivers/receiver_base.h"
+
+class rx_channel;
+
+typedef boost::shared_ptr<rx_channel> rx_channel_sptr;
+
+/*! \brief Public constructor of rx_channel_sptr. */
+rx_channel_sptr make_rx_channel(double quad_rate, double audio_rate,
+                                receiver_base_cf_sptr demod);
+
+/*! \brief Additional receiver channel (VFO).
+ *  \ingroup RX
+ *
+ * This block contains everything needed to demodulate one channel from the
+ * shared quadrature stream: a frequency translating decimator, a
+ * receiver_base_cf demodulator chain and the audio outputs (gain, UDP
+ * streaming and WAV recording).
+ *
+ * The input stage decimates to about twice the preferred rate of the
+ * demodulator chain, so tuning and anti-alias filtering are done in one
+ * block and nothing but the input filter runs at the full quadrature rate.
+ *
+ * The block has no outputs. The receiver connects the output of the I/Q
+ * front-end (after I/Q swap and DC removal) to the input of every channel,
+ * so the device, input decimator and front-end correction run only once no
+ * matter how many channels are active.
+ *
+ * The demodulator chain is created by the owner and handed over in the
+ * constructor or using set_demodulator(); the channel only takes care of
+ * wiring it up. The channel does not lock the flow graph itself, the caller
+ * is expected to hold the top block lock while reconfiguring a running
+ * channel.
+ */
+class rx_channel : public gr::hier_block2
+{
+
+public:
+    rx_channel(double quad_rate, double audio_rate, receiver_base_cf_sptr demod);
+    ~rx_channel();
+
+    void set_quad_rate(double quad_rate);
+    double get_quad_rate(void) const { return d_quad_rate; }
+
+    void set_offset(double offset_hz);
+    double get_offset(void) const { return d_offset; }
+
+    void set_cw_offset(double offset_hz);
+    double get_cw_offset(void) const { return d_cw_offset; }
+
+    void set_demodulator(receiver_base_cf_sptr demod);
+    receiver_base_cf_sptr demodulator(void) const { return d_rx; }
+
+    void set_af_gain(float gain);
+
+    void start_udp_streaming(const std::string host, int port);
+    void stop_udp_streaming(void);
+
+    bool start_audio_recording(const std::string filename);
+    bool stop_audio_recording(void);
+    bool is_recording_audio(void) const { return d_recording_wav; }
+
+    void get_perf_stats(block_perf_list &stats, const std::string &prefix) const;
+
+private:
+    void update_offset(void);
+    void update_rates(void);
+
+private:
+    double      d_quad_rate;        /*!< Input sample rate. */
+    double      d_audio_rate;       /*!< Audio output rate. */
+    double      d_offset;           /*!< Channel offset from the RF center. */
+    double      d_cw_offset;        /*!< CW offset. */
+    bool        d_recording_wav;    /*!< Whether we are recording WAV file. */
+
+    rx_xlating_filter_sptr              ddc;    /*!< Tuning and decimation. */
+
+    receiver_base_cf_sptr               d_rx;   /*!< Demodulator chain. */
+
+    gr::blocks::multiply_const_ff::sptr audio_gain0; /*!< Audio gain block. */
+    gr::blocks::multiply_const_ff::sptr audio_gain1; /*!< Audio gain block. */
+    gr::blocks::null_sink::sptr         audio_null_sink0;
+    gr::blocks::null_sink::sptr         audio_null_sink1;
+
+    udp_sink_f_sptr                     audio_udp_sink; /*!< UDP audio stream. */
+    gr::blocks::wavfile_sink::sptr      wav_sink;       /*!< WAV recorder. */
+};
+
+#endif // RX_CHANNEL_H
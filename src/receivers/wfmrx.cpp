@@ -33,6 +33,21 @@ wfmrx_sptr make_wfmrx(float quad_rate, float audio_rate)
     return gnuradio::get_initial_sptr(new wfmrx(quad_rate, audio_rate));
 }
 
+/* Give a block created after the chain has been set up the same buffer and
+ * CPU settings as the reference block (see receiver::apply_latency_profile()
+ * and receiver::apply_affinity()).
+ */
+template <class T>
+static void copy_block_settings(T blk, gr::block_sptr ref)
+{
+    std::vector<int> cores = ref->processor_affinity();
+
+    blk->set_min_output_buffer(ref->min_output_buffer(0));
+    blk->set_max_output_buffer(ref->max_output_buffer(0));
+    if (!cores.empty())
+        blk->set_processor_affinity(cores);
+}
+
 wfmrx::wfmrx(float quad_rate, float audio_rate)
     : receiver_base_cf("WFMRX"),
       d_running(false),
@@ -47,15 +62,8 @@ wfmrx::wfmrx(float quad_rate, float audio_rate)
     meter = make_rx_meter_c(DETECTOR_TYPE_RMS);
     demod_fm = make_rx_demod_fm(PREF_QUAD_RATE, PREF_MIDLE_RATE, 75000.0, 50.0e-6);
     midle_rr = make_resampler_ff(PREF_MIDLE_RATE/PREF_QUAD_RATE);
-    stereo = make_stereo_demod(PREF_MIDLE_RATE, d_audio_rate, true);
-    stereo_oirt = make_stereo_demod(PREF_MIDLE_RATE, d_audio_rate, true, true);
-    mono   = make_stereo_demod(PREF_MIDLE_RATE, d_audio_rate, false);
-
-    /* create rds blocks but dont connect them */
-    rds = make_rx_rds(PREF_QUAD_RATE);
-    rds_decoder = gr::rds::decoder::make(0, 0);
-    rds_parser = gr::rds::parser::make(0, 0);
-    rds_store = make_rx_rds_store();
+
+    /* the stereo decoders and the rds blocks are created on first use */
     rds_enabled = false;
 
     connect(self(), 0, iq_resamp, 0);
@@ -64,9 +72,39 @@ wfmrx::wfmrx(float quad_rate, float audio_rate)
     connect(filter, 0, sql, 0);
     connect(sql, 0, demod_fm, 0);
     connect(demod_fm, 0, midle_rr, 0);
-    connect(midle_rr, 0, mono, 0);
-    connect(mono, 0, self(), 0); // left  channel
-    connect(mono, 1, self(), 1); // right channel
+
+    /* All demodulators are connected and the output is selected using
+     * demod_sel, so switching demodulator does not require the flow graph
+     * to be stopped. The stereo decoders are expensive, so the input of the
+     * unused ones is cut off using disabled copy blocks.
+     *
+     * A decoder is only created when its demodulator is selected for the
+     * first time. Until then the disabled valve is connected directly to
+     * the selector, so the inputs are connected but never receive data.
+     */
+    demod_sel = make_stream_selector(sizeof(float), WFMRX_DEMOD_NUM, 2);
+    for (int i = 0; i < WFMRX_DEMOD_NUM; i++)
+    {
+        demod_valve[i] = gr::blocks::copy::make(sizeof(float));
+        demod_valve[i]->set_enabled(i == d_demod);
+        connect(midle_rr, 0, demod_valve[i], 0);
+        if (i == d_demod)
+        {
+            decoder[i] = make_stereo_demod(PREF_MIDLE_RATE, d_audio_rate, false);
+            connect(demod_valve[i], 0, decoder[i], 0);
+            connect(decoder[i], 0, demod_sel, 2 * i);
+            connect(decoder[i], 1, demod_sel, 2 * i + 1);
+        }
+        else
+        {
+            connect(demod_valve[i], 0, demod_sel, 2 * i);
+            connect(demod_valve[i], 0, demod_sel, 2 * i + 1);
+        }
+    }
+    demod_sel->set_group(d_demod);
+
+    connect(demod_sel, 0, self(), 0); // left  channel
+    connect(demod_sel, 1, self(), 1); // right channel
 }
 
 wfmrx::~wfmrx()
@@ -107,6 +145,29 @@ void wfmrx::set_audio_rate(float audio_rate)
     (void) audio_rate;
 }
 
+float wfmrx::get_pref_quad_rate(void) const
+{
+    return PREF_QUAD_RATE;
+}
+
+/*! \brief Append the performance counters of the demodulator chain. */
+void wfmrx::get_perf_stats(block_perf_list &stats, const std::string &prefix) const
+{
+    iq_resamp->get_perf_stats(stats, prefix + "/iq_resamp");
+    filter->get_perf_stats(stats, prefix + "/filter");
+    block_perf_add(stats, prefix + "/meter", meter);
+    block_perf_add(stats, prefix + "/sql", sql);
+    demod_fm->get_perf_stats(stats, prefix + "/demod_fm");
+    midle_rr->get_perf_stats(stats, prefix + "/midle_rr");
+    if (decoder[WFMRX_DEMOD_MONO])
+        decoder[WFMRX_DEMOD_MONO]->get_perf_stats(stats, prefix + "/mono");
+    if (decoder[WFMRX_DEMOD_STEREO])
+        decoder[WFMRX_DEMOD_STEREO]->get_perf_stats(stats, prefix + "/stereo");
+    if (decoder[WFMRX_DEMOD_STEREO_UKW])
+        decoder[WFMRX_DEMOD_STEREO_UKW]->get_perf_stats(stats, prefix + "/stereo_oirt");
+    block_perf_add(stats, prefix + "/demod_sel", demod_sel);
+}
+
 void wfmrx::set_filter(double low, double high, double tw)
 {
     filter->set_param(low, high, tw);
@@ -181,6 +242,36 @@ void nbrx::set_agc_manual_gain(int gain)
 }
 */
 
+/*! \brief Create the decoder of a demodulator unless it already exists.
+ *
+ * The placeholder connection between the valve and the selector is replaced
+ * by the new decoder. The flow graph is locked while doing so.
+ */
+void wfmrx::create_decoder(int demod)
+{
+    if (decoder[demod])
+        return;
+
+    decoder[demod] = make_stereo_demod(PREF_MIDLE_RATE, d_audio_rate,
+                                       demod != WFMRX_DEMOD_MONO,
+                                       demod == WFMRX_DEMOD_STEREO_UKW);
+    copy_block_settings(decoder[demod], demod_sel);
+
+    lock();
+    disconnect(demod_valve[demod], 0, demod_sel, 2 * demod);
+    disconnect(demod_valve[demod], 0, demod_sel, 2 * demod + 1);
+    connect(demod_valve[demod], 0, decoder[demod], 0);
+    connect(decoder[demod], 0, demod_sel, 2 * demod);
+    connect(decoder[demod], 1, demod_sel, 2 * demod + 1);
+    unlock();
+}
+
+/*! \brief Select demodulator.
+ *
+ * This only switches the valves and the output selector and can be called
+ * while the flow graph is running. The first time a demodulator is selected
+ * its decoder is created, which briefly locks the flow graph.
+ */
 void wfmrx::set_demod(int demod)
 {
     /* check if new demodulator selection is valid */
@@ -192,57 +283,11 @@ void wfmrx::set_demod(int demod)
         return;
     }
 
-    /* lock graph while we reconfigure */
-    lock();
-
-    /* disconnect current demodulator */
-    switch (d_demod) {
-
-    case WFMRX_DEMOD_MONO:
-    default:
-        disconnect(midle_rr, 0, mono, 0);
-        disconnect(mono, 0, self(), 0); // left  channel
-        disconnect(mono, 1, self(), 1); // right channel
-        break;
-
-    case WFMRX_DEMOD_STEREO:
-        disconnect(midle_rr, 0, stereo, 0);
-        disconnect(stereo, 0, self(), 0); // left  channel
-        disconnect(stereo, 1, self(), 1); // right channel
-        break;
-
-    case WFMRX_DEMOD_STEREO_UKW:
-        disconnect(midle_rr, 0, stereo_oirt, 0);
-        disconnect(stereo_oirt, 0, self(), 0); // left  channel
-        disconnect(stereo_oirt, 1, self(), 1); // right channel
-        break;
-    }
-
-    switch (demod) {
-
-    case WFMRX_DEMOD_MONO:
-    default:
-        connect(midle_rr, 0, mono, 0);
-        connect(mono, 0, self(), 0); // left  channel
-        connect(mono, 1, self(), 1); // right channel
-        break;
-
-    case WFMRX_DEMOD_STEREO:
-        connect(midle_rr, 0, stereo, 0);
-        connect(stereo, 0, self(), 0); // left  channel
-        connect(stereo, 1, self(), 1); // right channel
-        break;
-
-    case WFMRX_DEMOD_STEREO_UKW:
-        connect(midle_rr, 0, stereo_oirt, 0);
-        connect(stereo_oirt, 0, self(), 0); // left  channel
-        connect(stereo_oirt, 1, self(), 1); // right channel
-        break;
-    }
+    create_decoder(demod);
+    demod_valve[demod]->set_enabled(true);
+    demod_sel->set_group(demod);
+    demod_valve[d_demod]->set_enabled(false);
     d_demod = (wfmrx_demod) demod;
-
-    /* continue processing */
-    unlock();
 }
 
 void wfmrx::set_fm_maxdev(float maxdev_hz)
@@ -257,11 +302,25 @@ void wfmrx::set_fm_deemph(double tau)
 
 void wfmrx::get_rds_data(std::string &outbuff, int &num)
 {
-    rds_store->get_message(outbuff, num);
+    if (rds_store)
+        rds_store->get_message(outbuff, num);
+    else
+        num = -1;
 }
 
 void wfmrx::start_rds_decoder()
 {
+    /* the rds blocks are created the first time the decoder is started */
+    if (!rds)
+    {
+        rds = make_rx_rds(PREF_QUAD_RATE);
+        rds_decoder = gr::rds::decoder::make(0, 0);
+        rds_parser = gr::rds::parser::make(0, 0);
+        rds_store = make_rx_rds_store();
+        copy_block_settings(rds, demod_sel);
+        copy_block_settings(rds_decoder, demod_sel);
+    }
+
     connect(demod_fm, 0, rds, 0);
     connect(rds, 0, rds_decoder, 0);
     msg_connect(rds_decoder, "out", rds_parser, "in");
@@ -282,7 +341,8 @@ void wfmrx::stop_rds_decoder()
 
 void wfmrx::reset_rds_parser()
 {
-    rds_parser->reset();
+    if (rds_parser)
+        rds_parser->reset();
 }
 
 bool wfmrx::is_rds_decoder_active()
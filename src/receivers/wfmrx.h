@@ -25,6 +25,7 @@
 #define WFMRX_H
 
 #include <gnuradio/analog/simple_squelch_cc.h>
+#include <gnuradio/blocks/copy.h>
 #include "receivers/receiver_base.h"
 #include "dsp/rx_noise_blanker_cc.h"
 #include "dsp/rx_filter.h"
@@ -33,6 +34,7 @@
 #include "dsp/stereo_demod.h"
 #include "dsp/resampler_xx.h"
 #include "dsp/rx_rds.h"
+#include "dsp/stream_selector.h"
 #include "dsp/rds/decoder.h"
 #include "dsp/rds/parser.h"
 
@@ -67,6 +69,9 @@ public:
 
     void set_quad_rate(float quad_rate);
     void set_audio_rate(float audio_rate);
+    float get_pref_quad_rate(void) const;
+
+    void get_perf_stats(block_perf_list &stats, const std::string &prefix) const;
 
     void set_filter(double low, double high, double tw);
     void set_cw_offset(double offset) { (void)offset; }
@@ -106,6 +111,7 @@ public:
     bool is_rds_decoder_active();
 
 private:
+    void create_decoder(int demod);
     bool   d_running;          /*!< Whether receiver is running or not. */
     float  d_quad_rate;        /*!< Input sample rate. */
     int    d_audio_rate;       /*!< Audio output rate. */
@@ -119,10 +125,12 @@ private:
     gr::analog::simple_squelch_cc::sptr sql;       /*!< Squelch. */
     rx_demod_fm_sptr          demod_fm;  /*!< FM demodulator. */
     resampler_ff_sptr         midle_rr;  /*!< Resampler. */
-    stereo_demod_sptr         stereo;    /*!< FM stereo demodulator. */
-    stereo_demod_sptr         stereo_oirt;    /*!< FM stereo oirt demodulator. */
-    stereo_demod_sptr         mono;      /*!< FM stereo demodulator OFF. */
+    stereo_demod_sptr         decoder[WFMRX_DEMOD_NUM]; /*!< Mono, stereo and OIRT stereo decoders (created on first use). */
+
+    gr::blocks::copy::sptr    demod_valve[WFMRX_DEMOD_NUM]; /*!< Stops unused demodulators. */
+    stream_selector_sptr      demod_sel; /*!< Demodulator output selector. */
 
+    /* The RDS blocks are created when the decoder is started. */
     rx_rds_sptr               rds;       /*!< RDS decoder */
     rx_rds_store_sptr         rds_store; /*!< RDS decoded messages */
     gr::rds::decoder::sptr    rds_decoder;